@@ -0,0 +1,3 @@
+"""!
+@brief Benchmarks that measure how fast data generation runs, so regressions are caught early.
+"""
@@ -0,0 +1,101 @@
+"""!
+@brief Time placing the camera and rendering in Blender, at the settings saved in the scene.
+
+Run this inside Blender from the root of the project, with PYTHONPATH pointing at the project:
+```
+blender example_setup/environment.blend -b --python benchmarks/blender_benchmark.py \
+    --python-use-system-env -- --frames 20
+```
+The image format is fixed to 8 bit PNG at a set compression level, so only the scene and the code
+change between runs. Results are saved under *benchmarks/results* with a `_blender` suffix.
+"""
+import argparse
+import os
+import sys
+import tempfile
+from typing import Dict
+from ground_texture_sim.blender_interface import BlenderInterface
+from ground_texture_sim.timing import StageTimer
+from ground_texture_sim.transforms import create_transform_matrix
+from benchmarks.common import RESULTS_DIRECTORY, compare_results, create_results, load_results, \
+    save_results, time_function
+
+
+def _render_frames(interface: BlenderInterface, frame_count: int, output_folder: str,
+                   timer: StageTimer) -> None:
+    """!
+    @brief Render frames along a short straight line above the texture.
+    @param interface The interface controlling the camera.
+    @param frame_count How many frames to render.
+    @param output_folder Where to save the images.
+    @param timer Records how long placing the camera and rendering each took.
+    @return None
+    """
+    for i in range(frame_count):
+        camera_pose = create_transform_matrix(0.01 * i, 0.0, 0.25, 0.0, 1.5708, 0.0)
+        with timer.measure('place_camera'):
+            interface.place_camera(camera_pose)
+        with timer.measure('render_image'):
+            interface.render_image(os.path.join(output_folder, F'{i:07d}.png'))
+
+
+def run_benchmark(camera_name: str, frame_count: int, repeat: int,
+                  compression_level: int) -> Dict[str, Dict[str, float]]:
+    """!
+    @brief Render the frames several times, after one frame to warm up.
+    @param camera_name The name of the camera in the scene.
+    @param frame_count How many frames to render each time.
+    @param repeat How many times to render the frames. The best and median are kept.
+    @param compression_level The PNG compression level to save at.
+    @return The timing of the whole run and of each stage, keyed by `<name>/<frame count>`.
+    """
+    interface = BlenderInterface(camera_name)
+    interface.configure_output('PNG', '8', compression_level)
+    timer = StageTimer()
+    with tempfile.TemporaryDirectory() as output_folder:
+        # The first render loads textures and compiles shaders, which is not of interest here.
+        _render_frames(interface, 1, output_folder, StageTimer(enabled=False))
+        timing = time_function(_render_frames, repeat, interface, frame_count, output_folder,
+                               timer)
+    timing['poses'] = frame_count
+    benchmarks = {F'blender_frames/{frame_count}': timing}
+    for stage, summary in timer.summary().items():
+        benchmarks[F'blender_{stage}/{frame_count}'] = {
+            'best': summary['min'] * frame_count,
+            'median': summary['p50'] * frame_count,
+            'poses': frame_count
+        }
+    return benchmarks
+
+
+def main() -> None:  # pragma: no cover
+    """!
+    @brief Run the benchmark, save the results, and compare against a baseline if given.
+    @return None
+    """
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('--camera', default='Camera', help='The name of the camera to render.')
+    parser.add_argument('--frames', type=int, default=20, help='How many frames to render.')
+    parser.add_argument('--repeat', type=int, default=1,
+                        help='How many times to render the frames.')
+    parser.add_argument('--compression', type=int, default=1,
+                        help='The PNG compression level to save at, from 0 to 9.')
+    parser.add_argument('--output', default=RESULTS_DIRECTORY,
+                        help='The folder to save results in.')
+    parser.add_argument('--compare', help='Saved results to compare against.')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='How much slower, as a fraction, counts as a regression.')
+    args_list = sys.argv[sys.argv.index('--') + 1:] if '--' in sys.argv else []
+    args = parser.parse_args(args_list)
+    results = create_results(run_benchmark(args.camera, args.frames, args.repeat,
+                                           args.compression))
+    print(F'Results saved to {save_results(results, args.output, "_blender")}')
+    if args.compare is not None:
+        regressions = compare_results(results, load_results(args.compare), args.threshold)
+        if regressions:
+            print(F'{len(regressions)} benchmark(s) regressed by more than {args.threshold:.0%}.')
+            sys.exit(1)
+
+
+if __name__ == '__main__':  # pragma: no cover
+    main()
@@ -0,0 +1,118 @@
+"""!
+@brief This module provides the tools shared by every benchmark to time, save, and compare results.
+"""
+import datetime
+import json
+import os
+import platform
+import statistics
+import subprocess
+import time
+from typing import Callable, Dict, List
+
+## The default folder results are saved in, next to this file.
+RESULTS_DIRECTORY = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'results')
+
+
+def time_function(function: Callable, repeat: int, *args) -> Dict[str, float]:
+    """!
+    @brief Call a function several times and record how long the calls took.
+    @param function The function to time.
+    @param repeat How many times to call it. The best time is the most repeatable measure, since
+    anything else running on the machine can only make a call slower.
+    @param args The arguments to pass to the function each time.
+    @return A dictionary holding the best and median durations, in seconds.
+    """
+    durations = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        function(*args)
+        durations.append(time.perf_counter() - start)
+    return {'best': min(durations), 'median': statistics.median(durations)}
+
+
+def _git_output(arguments: List[str]) -> str:
+    """!
+    @brief Run a git command in this repository and return what it printed.
+    @param arguments The arguments to pass to git.
+    @return The output, without surrounding whitespace, or an empty string if git failed.
+    """
+    try:
+        result = subprocess.run(
+            ['git'] + arguments, cwd=os.path.dirname(os.path.abspath(__file__)),
+            capture_output=True, check=True, text=True)
+    except (OSError, subprocess.CalledProcessError):
+        return ''
+    return result.stdout.strip()
+
+
+def create_results(benchmarks: Dict[str, Dict[str, float]]) -> Dict:
+    """!
+    @brief Combine benchmark timings with a description of the code and machine they came from.
+    @param benchmarks The timing of each benchmark, keyed by `<benchmark name>/<pose count>`.
+    @return The full results, ready to save.
+    """
+    return {
+        'commit': _git_output(['rev-parse', 'HEAD']) or 'unknown',
+        'dirty': _git_output(['status', '--porcelain', '--untracked-files=no']) != '',
+        'date': datetime.datetime.now().isoformat(timespec='seconds'),
+        'machine': platform.node(),
+        'python': platform.python_version(),
+        'benchmarks': benchmarks
+    }
+
+
+def save_results(results: Dict, directory: str, suffix: str = '') -> str:
+    """!
+    @brief Save results to a JSON file named after the commit they came from.
+    @param results The results, as made by @ref create_results.
+    @param directory The folder to save in. It is created if needed.
+    @param suffix Added to the file name to keep different benchmark suites apart, e.g. '_blender'.
+    @return The path of the saved file.
+    """
+    os.makedirs(directory, exist_ok=True)
+    name = results['commit'][:12]
+    if results['dirty']:
+        name += '-dirty'
+    file_path = os.path.join(directory, F'{name}{suffix}.json')
+    with open(file=file_path, mode='w', encoding='utf-8') as file:
+        json.dump(results, fp=file, indent=2)
+    return file_path
+
+
+def load_results(file_path: str) -> Dict:
+    """!
+    @brief Load results saved by @ref save_results.
+    @param file_path The path of the saved file.
+    @return The results.
+    """
+    with open(file=file_path, mode='r', encoding='utf-8') as file:
+        return json.load(file)
+
+
+def compare_results(current: Dict, baseline: Dict, threshold: float) -> List[str]:
+    """!
+    @brief Print how every benchmark changed relative to a baseline and find the regressions.
+
+    Only benchmarks present in both results are compared, using their best times.
+
+    @param current The results just measured.
+    @param baseline The results to compare against, typically from an earlier commit.
+    @param threshold How much slower, as a fraction, a benchmark may get before it counts as a
+    regression. For example, 0.1 allows 10% slower.
+    @return The names of the benchmarks that regressed.
+    """
+    regressions = []
+    print(F'Comparing against {baseline["commit"][:12]} from {baseline["date"]}')
+    for name, timing in current['benchmarks'].items():
+        if name not in baseline['benchmarks']:
+            continue
+        baseline_time = baseline['benchmarks'][name]['best']
+        change = timing['best'] / baseline_time - 1.0 if baseline_time > 0 else 0.0
+        flag = ''
+        if change > threshold:
+            regressions.append(name)
+            flag = '  REGRESSION'
+        print(F'{name:<45} {baseline_time:10.4f}s -> {timing["best"]:10.4f}s '
+              F'({change:+7.1%}){flag}')
+    return regressions
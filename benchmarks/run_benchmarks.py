@@ -0,0 +1,163 @@
+"""!
+@brief Time the Python math and file writing paths of data generation, without Blender.
+
+Run this from the root of the project, for example:
+```
+python -m benchmarks.run_benchmarks --sizes 1000 100000 --compare benchmarks/results/<commit>.json
+```
+Results are saved under *benchmarks/results*, named after the current commit. When a baseline is
+given, the script exits with a nonzero status if any benchmark got slower than the threshold.
+"""
+import argparse
+import math
+import sys
+import tempfile
+from typing import Dict, List
+import numpy
+from ground_texture_sim.data_writer import DataWriter
+from ground_texture_sim.name_configuration import NameConfigurator
+from ground_texture_sim.transforms import Transformer, create_planar_transform_matrices, \
+    create_transform_matrices, create_transform_matrix
+from benchmarks.common import RESULTS_DIRECTORY, compare_results, create_results, load_results, \
+    save_results, time_function
+
+
+def _create_trajectory(pose_count: int) -> numpy.ndarray:
+    """!
+    @brief Create a repeatable trajectory of planar robot poses.
+    @param pose_count How many poses to create.
+    @return An Nx3 array of x, y, and yaw values.
+    """
+    generator = numpy.random.default_rng(seed=0)
+    trajectory = numpy.empty((pose_count, 3))
+    trajectory[:, 0:2] = generator.uniform(-10.0, 10.0, size=(pose_count, 2))
+    trajectory[:, 2] = generator.uniform(-math.pi, math.pi, size=pose_count)
+    return trajectory
+
+
+def _create_transformer() -> Transformer:
+    """!
+    @brief Create a transformer with the camera of the example configuration.
+    @return The transformer.
+    """
+    camera_pose = create_transform_matrix(0.0, 0.0, 0.25, 0.0, 1.5708, 0.0)
+    camera_intrinsic_matrix = numpy.array([
+        [888.88, 0.0, 320.0],
+        [0.0, 888.88, 240.0],
+        [0.0, 0.0, 1.0]
+    ])
+    return Transformer(camera_pose, camera_intrinsic_matrix)
+
+
+def _create_each_transform_matrix(trajectory: numpy.ndarray) -> None:
+    """!
+    @brief Create the transform matrix of each pose, one at a time.
+    @param trajectory The Nx3 planar poses.
+    @return None
+    """
+    for x, y, yaw in trajectory:
+        create_transform_matrix(x, y, 0.0, 0.0, 0.0, yaw)
+
+
+def _create_all_transform_matrices(trajectory: numpy.ndarray) -> None:
+    """!
+    @brief Create the transform matrix of every pose in one vectorized call.
+    @param trajectory The Nx3 planar poses.
+    @return None
+    """
+    create_transform_matrices(trajectory[:, 0], trajectory[:, 1], 0.0, 0.0, 0.0, trajectory[:, 2])
+
+
+def _project_each_image_corner(transformer: Transformer, robot_poses: numpy.ndarray) -> None:
+    """!
+    @brief Project the image corner of each pose, one at a time.
+    @param transformer The transformer to project with.
+    @param robot_poses The Nx4x4 robot poses.
+    @return None
+    """
+    for robot_pose in robot_poses:
+        transformer.project_image_corner(robot_pose)
+
+
+def _create_each_image_path(namer: NameConfigurator, pose_count: int) -> None:
+    """!
+    @brief Create the absolute path of each image.
+    @param namer The namer to create paths with.
+    @param pose_count How many paths to create.
+    @return None
+    """
+    for i in range(pose_count):
+        namer.create_image_path(i, absolute=True)
+
+
+def _write_lists(output_folder: str, trajectory: numpy.ndarray,
+                 pixel_poses: numpy.ndarray) -> None:
+    """!
+    @brief Write the list files for every pose.
+    @param output_folder Where to write them.
+    @param trajectory The Nx3 planar robot poses.
+    @param pixel_poses The Nx3 planar pixel poses.
+    @return None
+    """
+    writer = DataWriter(output_folder, 'regular', 1, 1, 'Camera')
+    writer.write_lists(trajectory, pixel_poses)
+
+
+def run_benchmarks(sizes: List[int], repeat: int) -> Dict[str, Dict[str, float]]:
+    """!
+    @brief Run every benchmark at every size.
+    @param sizes The pose counts to run each benchmark at.
+    @param repeat How many times to run each benchmark. The best and median are kept.
+    @return The timing of each benchmark, keyed by `<benchmark name>/<pose count>`.
+    """
+    transformer = _create_transformer()
+    benchmarks = {}
+    with tempfile.TemporaryDirectory() as output_folder:
+        namer = NameConfigurator(output_folder, 'regular', 1, 1, 'Camera')
+        for size in sizes:
+            trajectory = _create_trajectory(size)
+            robot_poses = create_planar_transform_matrices(trajectory)
+            pixel_poses = transformer.project_image_corners(robot_poses)
+            cases = {
+                'create_transform_matrix': (_create_each_transform_matrix, trajectory),
+                'create_transform_matrices': (_create_all_transform_matrices, trajectory),
+                'project_image_corner': (_project_each_image_corner, transformer, robot_poses),
+                'project_image_corners': (transformer.project_image_corners, robot_poses),
+                'write_lists': (_write_lists, output_folder, trajectory, pixel_poses),
+                'create_image_path': (_create_each_image_path, namer, size)
+            }
+            for name, case in cases.items():
+                timing = time_function(case[0], repeat, *case[1:])
+                timing['poses'] = size
+                benchmarks[F'{name}/{size}'] = timing
+                print(F'{name + "/" + str(size):<45} {timing["best"]:10.4f}s', flush=True)
+    return benchmarks
+
+
+def main() -> None:  # pragma: no cover
+    """!
+    @brief Run the benchmarks, save the results, and compare against a baseline if given.
+    @return None
+    """
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('--sizes', type=int, nargs='+', default=[1000, 100000, 1000000],
+                        help='The pose counts to run each benchmark at.')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='How many times to run each benchmark.')
+    parser.add_argument('--output', default=RESULTS_DIRECTORY,
+                        help='The folder to save results in.')
+    parser.add_argument('--compare', help='Saved results to compare against.')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='How much slower, as a fraction, counts as a regression.')
+    args = parser.parse_args()
+    results = create_results(run_benchmarks(args.sizes, args.repeat))
+    print(F'Results saved to {save_results(results, args.output)}')
+    if args.compare is not None:
+        regressions = compare_results(results, load_results(args.compare), args.threshold)
+        if regressions:
+            print(F'{len(regressions)} benchmark(s) regressed by more than {args.threshold:.0%}.')
+            sys.exit(1)
+
+
+if __name__ == '__main__':  # pragma: no cover
+    main()
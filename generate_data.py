@@ -9,7 +9,9 @@ specified directory.
 SPDX-License-Identifier: GPL-3.0-or-later
 """
 import sys
-from ground_texture_sim.script_runner import GroundTextureSim
+from ground_texture_sim.configuration_loader import get_job_directory
+from ground_texture_sim.job_server import JobServer
+from ground_texture_sim.sweep_runner import SweepRunner
 
 
 def main() -> None:  # pragma: no cover
@@ -17,12 +19,18 @@ def main() -> None:  # pragma: no cover
     Run through the program script.
 
     First, find the JSON. Then, load it and the trajectory specified by it.
-    Last, interact with Blender to create the data.
+    Last, interact with Blender to create the data. If a job directory is given
+    instead, keep running and do this for each JSON placed there. If the JSON
+    has a sweep, do this for each of its variants in turn.
 
     @return None
     """
-    simulator = GroundTextureSim(sys.argv)
-    simulator.run()
+    job_directory = get_job_directory(sys.argv)
+    if job_directory is not None:
+        JobServer(job_directory).serve()
+        return
+    sweep_runner = SweepRunner(sys.argv)
+    sweep_runner.run()
     # config_dict, trajectory_list = ground_texture_sim.configuration_loader.load_configuration(
     #     sys.argv)
     # ground_texture_sim.blender_interface.generate_images(
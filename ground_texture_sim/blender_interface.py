@@ -2,11 +2,28 @@
 @brief This module provides the necessary functions to interact with Blender.
 """
 from os import path
-from math import pi
+from math import ceil, pi
+from typing import Dict, List, Tuple
 import bpy
 import mathutils
 import numpy
 
+## The scene settings that making data may change, as attribute paths from the scene. The file
+## format comes before the settings that depend on it, such as the color depth.
+_SCENE_SETTINGS = [
+    'camera', 'frame_start', 'frame_end', 'frame_current',
+    'render.filepath', 'render.resolution_x', 'render.resolution_y',
+    'render.resolution_percentage', 'render.use_motion_blur', 'render.motion_blur_shutter',
+    'render.use_persistent_data',
+    'render.image_settings.file_format', 'render.image_settings.color_mode',
+    'render.image_settings.color_depth', 'render.image_settings.compression',
+    'render.image_settings.quality', 'render.image_settings.tiff_codec',
+    'cycles.device', 'cycles.samples', 'cycles.use_adaptive_sampling',
+    'cycles.adaptive_threshold', 'cycles.adaptive_min_samples', 'cycles.time_limit',
+    'cycles.use_denoising', 'cycles.denoiser', 'cycles.rolling_shutter_type',
+    'cycles.rolling_shutter_duration'
+]
+
 
 class BlenderInterface():
     """!
@@ -21,6 +38,8 @@ class BlenderInterface():
         """
         ## The name of the selected camera in the Blender interface.
         self.camera_name = camera_name
+        ## The offset to get Blender to position the camera correctly. This is built on first use.
+        self._blender_adjustment = None
 
     @property
     def camera_intrinsic_matrix(self) -> numpy.ndarray:
@@ -85,16 +104,310 @@ class BlenderInterface():
         ## The name of the selected camera in the Blender interface.
         self._camera_name = camera_name
 
+    @property
+    def image_format(self) -> str:
+        """!
+        @brief Get the file format Blender writes rendered images in, such as "PNG".
+        @return The name of the format, as used by Blender.
+        """
+        return bpy.context.scene.render.image_settings.file_format
+
+    @property
+    def render_resolution(self) -> Tuple[int, int, int]:
+        """!
+        @brief Get the size of rendered images.
+        @return The width in pixels, height in pixels, and percentage they are scaled by.
+        """
+        render = bpy.context.scene.render
+        return render.resolution_x, render.resolution_y, render.resolution_percentage
+
+    @render_resolution.setter
+    def render_resolution(self, resolution: Tuple[int, int, int]) -> None:
+        """!
+        @brief Set the size of rendered images. This is shared by every camera in the scene.
+        @param resolution The width in pixels, height in pixels, and percentage they are scaled by.
+        @return None
+        """
+        render = bpy.context.scene.render
+        render.resolution_x, render.resolution_y, render.resolution_percentage = resolution
+
+    @property
+    def render_settings(self) -> Dict:
+        """!
+        @brief Get the render settings that affect image quality and render time.
+
+        Cycles specific settings are only included when the scene renders with Cycles.
+
+        @return A dictionary of the settings, suitable for saving as JSON.
+        """
+        scene = bpy.context.scene
+        settings = {
+            'blender_version': bpy.app.version_string,
+            'engine': scene.render.engine,
+            'resolution_x': scene.render.resolution_x,
+            'resolution_y': scene.render.resolution_y,
+            'resolution_percentage': scene.render.resolution_percentage,
+            'use_motion_blur': scene.render.use_motion_blur,
+            'motion_blur_shutter': scene.render.motion_blur_shutter
+        }
+        if scene.render.engine == 'CYCLES':
+            cycles = scene.cycles
+            settings.update({
+                'device': cycles.device,
+                'samples': cycles.samples,
+                'use_adaptive_sampling': cycles.use_adaptive_sampling,
+                'adaptive_threshold': cycles.adaptive_threshold,
+                'adaptive_min_samples': cycles.adaptive_min_samples,
+                'time_limit': getattr(cycles, 'time_limit', None),
+                'use_denoising': cycles.use_denoising,
+                'denoiser': cycles.denoiser,
+                'rolling_shutter_type': cycles.rolling_shutter_type,
+                'rolling_shutter_duration': cycles.rolling_shutter_duration
+            })
+            if cycles.device == 'GPU':
+                preferences = bpy.context.preferences.addons['cycles'].preferences
+                settings['compute_device_type'] = preferences.compute_device_type
+                settings['compute_devices'] = [
+                    device.name for device in preferences.devices if device.use]
+        return settings
+
+    @property
+    def png_compression_level(self) -> int:
+        """!
+        @brief Get the zlib compression level Blender uses when writing PNG images.
+
+        Blender stores this as a percentage, then maps it to zlib's 0 to 9 levels when writing.
+
+        @return The zlib compression level, from 0 to 9.
+        """
+        return int(bpy.context.scene.render.image_settings.compression / 11.1111)
+
+    @png_compression_level.setter
+    def png_compression_level(self, compression_level: int) -> None:
+        """!
+        @brief Set the zlib compression level Blender uses when writing PNG images.
+        @param compression_level The zlib compression level, from 0 to 9.
+        @return None
+        @exception ValueError raised if the level is outside of 0 to 9.
+        """
+        if compression_level < 0 or compression_level > 9:
+            raise ValueError(
+                F'PNG compression level must be from 0 to 9, not {compression_level}.')
+        # Round up so Blender's truncating conversion back to a zlib level lands on this one.
+        bpy.context.scene.render.image_settings.compression = ceil(
+            compression_level * 100 / 9)
+
+    def available_devices(self, device_type: str) -> List[str]:
+        """!
+        @brief List the devices Cycles can render on with a compute device type, such as "CUDA".
+
+        This switches Cycles to that device type, so the list matches the indices used by
+        @ref configure_device.
+
+        @param device_type The Blender name of the compute device type: "CUDA", "OPTIX", "HIP",
+        "METAL", or "ONEAPI".
+        @return The name of each device of that type, in the order Blender lists them.
+        @exception RuntimeError raised if this version of Blender does not support the type.
+        """
+        preferences = bpy.context.preferences.addons['cycles'].preferences
+        supported_types = preferences.bl_rna.properties['compute_device_type'].enum_items.keys()
+        if device_type not in supported_types:
+            raise RuntimeError(
+                F'This version of Blender can not render with {device_type}. Supported types are: '
+                F'{supported_types}')
+        preferences.compute_device_type = device_type
+        # Blender only finds the devices once asked. The method was renamed in Blender 3.0.
+        if hasattr(preferences, 'refresh_devices'):
+            preferences.refresh_devices()
+        else:
+            preferences.get_devices()
+        return [device.name for device in preferences.devices if device.type == device_type]
+
+    def configure_device(self, device_type: str, device_indices: List[int] = None) -> None:
+        """!
+        @brief Choose the device Cycles renders on, instead of relying on the user's preferences.
+
+        @param device_type "CPU", or the Blender name of a GPU compute device type: "CUDA",
+        "OPTIX", "HIP", "METAL", or "ONEAPI". If None, the saved preferences are kept.
+        @param device_indices For GPUs, which devices of that type to use, as indices into
+        @ref available_devices. If None, every device of that type is used.
+        @return None
+        @exception RuntimeError raised if the type is not supported or no matching devices are
+        found, so a run never quietly falls back to the CPU.
+        """
+        if device_type is None:
+            return
+        scene = bpy.context.scene
+        if device_type == 'CPU':
+            scene.cycles.device = 'CPU'
+            return
+        device_names = self.available_devices(device_type)
+        if device_indices is None:
+            device_indices = list(range(len(device_names)))
+        if len(device_names) == 0 or any(index >= len(device_names) for index in device_indices):
+            raise RuntimeError(
+                F'Devices {device_indices} of type {device_type} were requested, but the only ones '
+                F'found are: {device_names}')
+        selected_names = [device_names[index] for index in device_indices]
+        preferences = bpy.context.preferences.addons['cycles'].preferences
+        for device in preferences.devices:
+            device.use = device.type == device_type and device.name in selected_names
+        scene.cycles.device = 'GPU'
+        print(F'Rendering with {device_type} on {selected_names}')
+
+    def clear_motion(self) -> None:
+        """!
+        @brief Remove the keyframes left by @ref place_moving_camera, so the camera stays wherever
+        @ref place_camera puts it.
+        @return None
+        """
+        bpy.data.objects[self.camera_name].animation_data_clear()
+
+    def configure_motion_blur(self, shutter: float = None, rolling_shutter: float = None) -> None:
+        """!
+        @brief Blur each image by the camera's motion while the shutter is open.
+
+        The blur comes from the keyframes set by @ref place_moving_camera, where one frame is the
+        time between trajectory poses. Blender spreads each pixel's samples over the time the
+        shutter is open, so blurred images take about as long to render as sharp ones.
+
+        @param shutter The fraction of the time between poses that the shutter is open, centered on
+        the pose. If None, the setting saved in Blender is kept.
+        @param rolling_shutter For Cycles, the fraction of the shutter time spent reading out the
+        rows of the image from top to bottom, where 0 is a global shutter. If None, the setting
+        saved in Blender is kept.
+        @return None
+        @exception RuntimeError raised if a rolling shutter is requested but the scene does not
+        render with Cycles.
+        """
+        scene = bpy.context.scene
+        if shutter is not None:
+            scene.render.use_motion_blur = True
+            scene.render.motion_blur_shutter = shutter
+        if rolling_shutter is not None:
+            if scene.render.engine != 'CYCLES':
+                raise RuntimeError(
+                    F'A rolling shutter can only be set for Cycles, not {scene.render.engine}.')
+            scene.cycles.rolling_shutter_type = 'TOP'
+            scene.cycles.rolling_shutter_duration = rolling_shutter
+
+    def configure_output(self, file_format: str, color_depth: str = None,
+                         compression_level: int = None) -> None:
+        """!
+        @brief Set the format Blender writes rendered images in.
+
+        TIFF images are always written uncompressed and WebP images are always lossless, since this
+        data is meant as ground truth. BMP images are always RGB.
+
+        @param file_format The Blender name of the format: "PNG", "WEBP", "TIFF", "OPEN_EXR", or
+        "BMP".
+        @param color_depth The bits per channel, as a string such as "8" or "16". If None, the
+        setting saved in Blender is kept.
+        @param compression_level For PNG images, the zlib compression level from 0 to 9. If None,
+        the setting saved in Blender is kept.
+        @return None
+        @exception RuntimeError raised if this version of Blender can't write the format.
+        """
+        image_settings = bpy.context.scene.render.image_settings
+        supported_formats = bpy.types.ImageFormatSettings.bl_rna.properties[
+            'file_format'].enum_items.keys()
+        if file_format not in supported_formats:
+            raise RuntimeError(
+                F'This version of Blender can not write {file_format} images. Supported formats '
+                F'are: {supported_formats}')
+        image_settings.file_format = file_format
+        if color_depth is not None:
+            image_settings.color_depth = color_depth
+        if compression_level is not None:
+            self.png_compression_level = compression_level
+        if file_format == 'TIFF':
+            image_settings.tiff_codec = 'NONE'
+        elif file_format == 'WEBP':
+            # Blender writes lossless WebP at full quality.
+            image_settings.quality = 100
+        elif file_format == 'BMP':
+            image_settings.color_mode = 'RGB'
+
+    def configure_quality(self, noise_threshold: float = None, min_samples: int = None,
+                          max_samples: int = None, time_limit: float = None,
+                          denoise: bool = None) -> None:
+        """!
+        @brief Set how Cycles trades image quality for render time.
+
+        A noise threshold turns on adaptive sampling, so each pixel stops sampling once it is clean
+        enough, within the minimum and maximum sample counts. A time limit caps the seconds spent on
+        each frame, for predictable throughput. Denoising uses OpenImageDenoise, which runs on any
+        CPU.
+
+        @param noise_threshold The adaptive sampling noise threshold, such as 0.01. If None, the
+        setting saved in Blender is kept.
+        @param min_samples The fewest samples per pixel when adaptive sampling. If None, the
+        setting saved in Blender is kept.
+        @param max_samples The most samples per pixel. If None, the setting saved in Blender is
+        kept.
+        @param time_limit The most seconds to spend rendering each frame. If None, the setting saved
+        in Blender is kept.
+        @param denoise Whether to denoise each frame. If None, the setting saved in Blender is kept.
+        @return None
+        @exception RuntimeError raised if any setting is given but the scene does not render with
+        Cycles, or if this version of Blender has no per frame time limit.
+        """
+        settings = [noise_threshold, min_samples, max_samples, time_limit, denoise]
+        if all(setting is None for setting in settings):
+            return
+        scene = bpy.context.scene
+        if scene.render.engine != 'CYCLES':
+            raise RuntimeError(
+                F'Render quality can only be set for Cycles, not {scene.render.engine}.')
+        cycles = scene.cycles
+        if noise_threshold is not None:
+            cycles.use_adaptive_sampling = True
+            cycles.adaptive_threshold = noise_threshold
+        if min_samples is not None:
+            cycles.adaptive_min_samples = min_samples
+        if max_samples is not None:
+            cycles.samples = max_samples
+        if time_limit is not None:
+            if not hasattr(cycles, 'time_limit'):
+                raise RuntimeError(
+                    'This version of Blender has no per frame time limit. Blender 3.0 or newer is '
+                    'required.')
+            cycles.time_limit = time_limit
+        if denoise is not None:
+            cycles.use_denoising = denoise
+            if denoise:
+                cycles.denoiser = 'OPENIMAGEDENOISE'
+
+    def create_worker_command(self, script_args: List[str]) -> List[str]:
+        """!
+        @brief Build the command line to launch another headless Blender on the current scene.
+
+        The new process loads the same .blend file as this one, then runs the data generation
+        script with the provided arguments. Blender is told to return a nonzero exit code if the
+        script raises an exception, so failures can be detected by the caller.
+
+        @param script_args The arguments to pass to the script, i.e. everything after the '--'.
+        @return A list of command line arguments suitable for the subprocess module.
+        @exception RuntimeError raised if the current scene was never saved to a .blend file.
+        """
+        blend_file = bpy.data.filepath
+        if len(blend_file) == 0:
+            raise RuntimeError(
+                'Workers require the scene to be loaded from a .blend file.')
+        script = 'import sys; from ground_texture_sim.script_runner import GroundTextureSim; ' \
+            'GroundTextureSim(sys.argv).run()'
+        command = [bpy.app.binary_path, blend_file, '--background', '--python-use-system-env',
+                   '--python-exit-code', '1', '--python-expr', script, '--']
+        command.extend(script_args)
+        return command
+
     def generate_image(self, image_path: str, camera_pose: numpy.ndarray) -> None:
         """!
         @brief Position the camera at a designated pose and render an image.
 
         This method takes the 6 DOF pose of the camera, places the camera at that pose in the
-        environment, renders the image, then saves the image to the designated file.
-
-        Blender's coordinate system is different than the usual coordinate system assumed in
-        robotics. This method adds the correct adjustment, so there is no need to account for it. In
-        other words, specify the camera pose using conventional robotics coordinate systems.
+        environment, renders the image, then saves the image to the designated file. It is the same
+        as calling @ref place_camera, then @ref render_image.
 
         @param image_path An absolute path to where the image should go. Blender does not seem to
         handle relative paths great.
@@ -107,25 +420,257 @@ class BlenderInterface():
         if not path.isabs(image_path):
             raise ValueError(
                 F'Image path must be absolute. Received: {image_path}')
+        self.place_camera(camera_pose)
+        self.render_image(image_path)
+
+    def place_camera(self, camera_pose: numpy.ndarray) -> None:
+        """!
+        @brief Position the camera at a designated pose.
+
+        Blender's coordinate system is different than the usual coordinate system assumed in
+        robotics. This method adds the correct adjustment, so there is no need to account for it. In
+        other words, specify the camera pose using conventional robotics coordinate systems.
+
+        @param camera_pose The 4x4 homogenous matrix representing the pose of the camera in the
+        world frame.
+        @return None
+        """
         # Convert the provided pose into a Mathutils matrix. This has better support for extracting
         # the XYZ, RPY values needed to position in Blender.
-        pose = mathutils.Matrix()
-        for i in range(4):
-            for j in range(4):
-                pose[i][j] = camera_pose[i][j]
-        # Calculate the offset to get Blender to position the camera correctly.
-        # Pre-compute the offset used to get blender camera poses correct.
-        blender_adjustment = mathutils.Euler(
-            (pi/2.0, 0.0, -pi/2.0), 'XYZ').to_matrix().to_4x4()
-        blender_placement = pose @ blender_adjustment
-        # Now place the camera
+        pose = mathutils.Matrix(camera_pose.tolist())
+        # Calculate the offset to get Blender to position the camera correctly once, since it never
+        # changes.
+        if self._blender_adjustment is None:
+            self._blender_adjustment = mathutils.Euler(
+                (pi/2.0, 0.0, -pi/2.0), 'XYZ').to_matrix().to_4x4()
+        blender_placement = pose @ self._blender_adjustment
+        # Now place the camera. Assigning matrix_world instead would let Blender pick an equivalent
+        # but different Euler angle, so set the location and rotation directly.
         camera = bpy.data.objects[self.camera_name]
-        camera.location.x = blender_placement.to_translation()[0]
-        camera.location.y = blender_placement.to_translation()[1]
-        camera.location.z = blender_placement.to_translation()[2]
-        camera.rotation_euler.x = blender_placement.to_euler('XYZ')[0]
-        camera.rotation_euler.y = blender_placement.to_euler('XYZ')[1]
-        camera.rotation_euler.z = blender_placement.to_euler('XYZ')[2]
-        # Render the image
+        camera.location = blender_placement.to_translation()
+        camera.rotation_euler = blender_placement.to_euler('XYZ')
+
+    def place_moving_camera(self, previous_pose: numpy.ndarray, camera_pose: numpy.ndarray,
+                            next_pose: numpy.ndarray) -> None:
+        """!
+        @brief Position the camera at a designated pose, moving in a straight line from the previous
+        pose and on to the next one, for motion blur.
+
+        The three poses are keyframed on frames 0, 1, and 2 with linear interpolation, and the scene
+        is set to frame 1. Any animation the camera already had is removed. Call
+        @ref clear_motion once done, so later still poses are not overridden by the keyframes.
+
+        @param previous_pose The 4x4 homogenous pose of the camera in the world frame one frame
+        earlier.
+        @param camera_pose The 4x4 homogenous pose of the camera in the world frame to render from.
+        @param next_pose The 4x4 homogenous pose of the camera in the world frame one frame later.
+        @return None
+        """
+        camera = bpy.data.objects[self.camera_name]
+        camera.animation_data_clear()
+        self.place_camera(camera_pose)
+        camera.keyframe_insert(data_path='location', frame=1)
+        camera.keyframe_insert(data_path='rotation_euler', frame=1)
+        rotation = camera.rotation_euler.copy()
+        for frame, pose in [(0, previous_pose), (2, next_pose)]:
+            self.place_camera(pose)
+            # Keep the angles from wrapping around between frames, so the camera turns the short
+            # way.
+            camera.rotation_euler.make_compatible(rotation)
+            camera.keyframe_insert(data_path='location', frame=frame)
+            camera.keyframe_insert(data_path='rotation_euler', frame=frame)
+        for fcurve in camera.animation_data.action.fcurves:
+            for keyframe in fcurve.keyframe_points:
+                keyframe.interpolation = 'LINEAR'
+        bpy.context.scene.frame_set(1)
+
+    def render_animation(self, frame_path: str, camera_poses: numpy.ndarray) -> List[str]:
+        """!
+        @brief Render one image from each of several camera poses as a single animation job.
+
+        Each pose becomes a keyframe of the camera, one frame apart, and the frames are rendered in
+        one call with persistent data on. Blender then evaluates the scene and builds its render
+        data once for the whole batch, instead of once per image. The keyframes are removed
+        afterwards, along with any animation the camera already had, and the scene's frame range,
+        output path, and persistent data setting are put back.
+
+        @param frame_path An absolute path for the frames, where a run of '#' characters is replaced
+        by the frame number, starting from 1.
+        @param camera_poses An Nx4x4 Numpy array of the homogenous pose of the camera in the world
+        frame for each image.
+        @return The absolute path of each rendered image, in the order of the poses.
+        @exception ValueError raised if the provided path is not absolute.
+        """
+        if not path.isabs(frame_path):
+            raise ValueError(
+                F'Frame path must be absolute. Received: {frame_path}')
+        scene = bpy.context.scene
+        camera = bpy.data.objects[self.camera_name]
+        original_settings = (scene.frame_start, scene.frame_end, scene.frame_current,
+                             scene.render.filepath, scene.render.use_persistent_data)
+        camera.animation_data_clear()
+        try:
+            for frame, camera_pose in enumerate(camera_poses, 1):
+                self.place_camera(camera_pose)
+                camera.keyframe_insert(data_path='location', frame=frame)
+                camera.keyframe_insert(data_path='rotation_euler', frame=frame)
+            scene.camera = camera
+            scene.frame_start = 1
+            scene.frame_end = len(camera_poses)
+            scene.render.filepath = frame_path
+            scene.render.use_persistent_data = True
+            bpy.ops.render.render(animation=True)
+            return [scene.render.frame_path(frame=frame)
+                    for frame in range(1, len(camera_poses) + 1)]
+        finally:
+            camera.animation_data_clear()
+            scene.frame_start, scene.frame_end, scene.frame_current, scene.render.filepath, \
+                scene.render.use_persistent_data = original_settings
+
+    def render_image(self, image_path: str) -> None:
+        """!
+        @brief Render an image from wherever the camera currently is and save it to file.
+
+        This camera is made the scene's active camera first, so several interfaces can take turns
+        rendering the same scene.
+
+        @param image_path An absolute path to where the image should go.
+        @return None
+        @exception ValueError raised if the provided path is not absolute.
+        """
+        if not path.isabs(image_path):
+            raise ValueError(
+                F'Image path must be absolute. Received: {image_path}')
+        bpy.context.scene.camera = bpy.data.objects[self.camera_name]
         bpy.context.scene.render.filepath = image_path
         bpy.ops.render.render(write_still=True)
+
+
+def create_orthographic_camera(camera_name: str, orthographic_scale: float) -> None:
+    """!
+    @brief Add an orthographic camera to the scene, or update it if it already exists.
+
+    The camera can then be controlled with a @ref BlenderInterface of the same name.
+
+    @param camera_name The name of the camera, used for both its object and its data.
+    @param orthographic_scale How many meters the camera sees across the wider side of its image.
+    @return None
+    """
+    if camera_name in bpy.data.objects.keys():
+        camera = bpy.data.objects[camera_name]
+    else:
+        camera = bpy.data.objects.new(camera_name, bpy.data.cameras.new(camera_name))
+        bpy.context.scene.collection.objects.link(camera)
+    camera.data.type = 'ORTHO'
+    camera.data.ortho_scale = orthographic_scale
+    camera.data.sensor_fit = 'AUTO'
+
+
+def remove_orthographic_camera(camera_name: str) -> None:
+    """!
+    @brief Delete a camera made by @ref create_orthographic_camera, along with its camera data.
+
+    Nothing is left behind in the scene or the blend data. This does nothing if there is no such
+    camera.
+
+    @param camera_name The name of the camera, used for both its object and its data.
+    @return None
+    """
+    if camera_name in bpy.data.objects.keys():
+        bpy.data.objects.remove(bpy.data.objects[camera_name], do_unlink=True)
+    if camera_name in bpy.data.cameras.keys():
+        bpy.data.cameras.remove(bpy.data.cameras[camera_name])
+
+
+def warm_up_renderer() -> None:
+    """!
+    @brief Render one throwaway image from the scene's active camera, without saving it.
+
+    The first render after loading a scene loads every texture and compiles the shaders and render
+    kernels. Doing that up front means the first real image is not penalized. This does nothing if
+    the scene has no active camera.
+
+    @return None
+    """
+    if bpy.context.scene.camera is None:
+        return
+    bpy.ops.render.render(write_still=False)
+
+
+def save_scene_state() -> Dict:
+    """!
+    @brief Record the scene and Cycles settings that making data may change.
+
+    Several runs can share one Blender process, such as the jobs of a job server. Each run's
+    settings left as None are meant to keep what the .blend file has, so the settings an earlier run
+    changed must be put back with @ref restore_scene_state before the next one starts.
+
+    @return The settings, to pass to @ref restore_scene_state. These are the scene's render,
+    output, quality, and motion blur settings, the Cycles compute devices, and the file of every
+    image.
+    """
+    scene = bpy.context.scene
+    state = {'scene': {}, 'devices': None, 'images': {}}
+    for setting in _SCENE_SETTINGS:
+        owner, attribute = _find_setting(scene, setting)
+        if owner is not None:
+            state['scene'][setting] = getattr(owner, attribute)
+    if 'cycles' in bpy.context.preferences.addons.keys():
+        preferences = bpy.context.preferences.addons['cycles'].preferences
+        state['devices'] = {
+            'compute_device_type': preferences.compute_device_type,
+            'use': [(device.type, device.name, device.use) for device in preferences.devices]
+        }
+    for image in bpy.data.images:
+        state['images'][image.name] = image.filepath
+    return state
+
+
+def restore_scene_state(state: Dict) -> None:
+    """!
+    @brief Put back the settings recorded by @ref save_scene_state.
+
+    Only settings that changed are set, so images that were never repointed are not reloaded, and
+    the scene and compiled render kernels stay warm.
+
+    @param state The settings from @ref save_scene_state.
+    @return None
+    """
+    scene = bpy.context.scene
+    for setting, value in state['scene'].items():
+        owner, attribute = _find_setting(scene, setting)
+        if owner is not None and getattr(owner, attribute) != value:
+            setattr(owner, attribute, value)
+    if state['devices'] is not None:
+        preferences = bpy.context.preferences.addons['cycles'].preferences
+        if preferences.compute_device_type != state['devices']['compute_device_type']:
+            preferences.compute_device_type = state['devices']['compute_device_type']
+        device_use = {(device_type, name): use
+                      for device_type, name, use in state['devices']['use']}
+        for device in preferences.devices:
+            use = device_use.get((device.type, device.name))
+            if use is not None and device.use != use:
+                device.use = use
+    for image in bpy.data.images:
+        file_path = state['images'].get(image.name)
+        if file_path is not None and image.filepath != file_path:
+            image.filepath = file_path
+
+
+def _find_setting(scene: 'bpy.types.Scene', setting: str) -> Tuple:
+    """!
+    @brief Find the object holding one of the scene's settings.
+    @param scene The scene.
+    @param setting The attribute path of the setting from the scene, such as "cycles.samples".
+    @return The object holding the setting and the setting's attribute name, or None for both if
+    this scene or version of Blender doesn't have it.
+    """
+    owner = scene
+    names = setting.split('.')
+    for name in names[:-1]:
+        owner = getattr(owner, name, None)
+        if owner is None:
+            return None, None
+    if not hasattr(owner, names[-1]):
+        return None, None
+    return owner, names[-1]
@@ -3,11 +3,36 @@
 import the provided trajectory data.
 """
 import argparse
+import copy
+import datetime
+import itertools
 import json
-from typing import Dict, List, Tuple
+import os
+from typing import Dict, List, Tuple, Union
+import numpy
+from ground_texture_sim.name_configuration import IMAGE_EXTENSIONS
+from ground_texture_sim.trajectory_generators import GeneratedTrajectory, create_trajectory
 
+## The bit depths Blender supports for each image format.
+_IMAGE_COLOR_DEPTHS = {
+    'PNG': ['8', '16'],
+    'WEBP': ['8'],
+    'TIFF': ['8', '16'],
+    'OPEN_EXR': ['16', '32']
+}
 
-def load_configuration(args_list: List[str]) -> Tuple[Dict, List[List[float]]]:  # pragma: no cover
+## The Cycles devices that can be rendered on.
+_DEVICE_TYPES = ['CPU', 'CUDA', 'OPTIX', 'HIP', 'METAL', 'ONEAPI']
+
+## The ways images can be made: rendered by Blender, or previewed by looking up the floor texture.
+_BACKENDS = ['blender', 'preview']
+
+## A loaded trajectory. This is a list of [x, y, theta] poses, an Nx3 array for binary files, or a
+## generator that computes each pose on demand.
+Trajectory = Union[List[List[float]], numpy.ndarray, GeneratedTrajectory]
+
+
+def load_configuration(args_list: List[str]) -> Tuple[Dict, Trajectory]:  # pragma: no cover
     """!
     @brief Parse the command line and read configuration information provided by the arguments.
 
@@ -17,18 +42,156 @@ def load_configuration(args_list: List[str]) -> Tuple[Dict, List[List[float]]]:
 
     @param args_list The arguments straight from the command line.
     @return A tuple containing a well-formatted Dict of settings and a list of trajectories, where
-    each item in the list is a list of the form [x, y, theta].
+    each item in the list is of the form [x, y, theta]. Binary trajectories are a read only,
+    memory-mapped Nx3 Numpy array instead, and generated ones a @ref GeneratedTrajectory.
     @exception FileNotFoundError Raised if the config or trajectory files do not exist
     @exception JSONDecoderError Raised if the file is not in JSON format.
     @exception KeyError Raised if the required entries are not present in the JSON.
     @exception RuntimeError Raised if the pose format does not follow the correct structure.
     """
-    config_file = _parse_args(args_list=args_list)
-    config_dict = _load_config(config_file)
+    parsed_args = _parse_args(args_list=args_list)
+    config_dict = _load_config(parsed_args.parameter_file)
     trajectory_list = _load_trajectory(config_dict['trajectory'])
+    # Anything given on the command line takes priority over the JSON. A trajectory range means
+    # this process is one node or worker of a larger run.
+    if parsed_args.start is not None:
+        config_dict['execution']['start_index'] = parsed_args.start
+    if parsed_args.end is not None:
+        config_dict['execution']['end_index'] = parsed_args.end
+    if parsed_args.workers is not None:
+        config_dict['execution']['workers'] = parsed_args.workers
+    if parsed_args.device_index is not None:
+        config_dict['device']['indices'] = [parsed_args.device_index]
+    config_dict['execution']['merge'] = parsed_args.merge
+    config_dict['execution']['mosaic'] = parsed_args.mosaic
+    config_dict['execution']['dry_run'] = parsed_args.dry_run
+    config_dict['execution']['plan'] = parsed_args.plan
+    if parsed_args.date is not None:
+        config_dict['sequence']['date'] = _check_date(parsed_args.date)
+    if parsed_args.preview:
+        config_dict['render']['backend'] = 'preview'
+        _check_preview(config_dict)
+    if config_dict['render']['backend'] == 'preview':
+        if parsed_args.mosaic:
+            raise ValueError('The mosaic can only be rendered by Blender')
+        # Keep previews apart from real renders of the same configuration.
+        config_dict['output'] = F'{os.path.normpath(config_dict["output"])}_preview'
+    if parsed_args.mosaic:
+        # The range counts tiles instead of poses, which is only known once Blender is loaded.
+        if config_dict['mosaic']['x_min'] is None:
+            raise ValueError('The mosaic section must give the area of the floor to render')
+    else:
+        _check_range(config_dict['execution'], len(trajectory_list))
+    if config_dict['sequence']['date'] is None:
+        config_dict['sequence']['date'] = pin_collection_date(
+            config_dict['output'], config_dict['sequence']['sequence_type'],
+            config_dict['sequence']['sequence_number'])
     return config_dict, trajectory_list
 
 
+def pin_collection_date(output_folder: str, sequence_type: str, sequence_number: int) -> str:
+    """!
+    @brief Find the date a sequence was collected on, fixing it to today if it has none yet.
+
+    The date names the image folders and files and every file describing the run, so every node,
+    worker, resumed run, and merge of a sequence must use the same one, even on a later day. The
+    first run of a sequence records today's date in its output folder, and every later run reads it
+    back. To start a new collection in the same folder, delete that file or set sequence/date.
+
+    @param output_folder The root output folder of the sequence.
+    @param sequence_type The type of the sequence.
+    @param sequence_number The number of the sequence.
+    @return The date, as YYYY-MM-DD.
+    """
+    file_path = os.path.join(output_folder, collection_date_file(sequence_type, sequence_number))
+    os.makedirs(output_folder, exist_ok=True)
+    try:
+        # Only one of several nodes starting at once can create the file, and the rest read it.
+        with open(file=file_path, mode='x', encoding='utf-8') as date_file:
+            date = datetime.date.today().isoformat()
+            date_file.write(date + '\n')
+            return date
+    except FileExistsError:
+        pass
+    with open(file=file_path, mode='r', encoding='utf-8') as date_file:
+        return _check_date(date_file.read().strip())
+
+
+def collection_date_file(sequence_type: str, sequence_number: int) -> str:
+    """!
+    @brief Return the path of the file recording the date a sequence was collected on, relative to
+    *output*.
+    @param sequence_type The type of the sequence.
+    @param sequence_number The number of the sequence.
+    @return The relative path for that file.
+    """
+    return F'{sequence_type}_s{sequence_number:04d}_date.txt'
+
+
+def load_sweep(args_list: List[str]) -> List[Tuple[Dict, Dict]]:
+    """!
+    @brief Read the configuration file given on the command line and expand its sweep, if any.
+
+    See @ref _expand_sweep for how the sweep is expanded. The variants are not validated here, since
+    each is loaded like any other configuration when it runs.
+
+    @param args_list The arguments straight from the command line.
+    @return For each variant, the values the sweep set and the variant's whole configuration. This
+    is empty if the configuration has no sweep.
+    @exception FileNotFoundError Raised if the config file does not exist.
+    @exception KeyError, TypeError Raised if the sweep is not correctly described.
+    """
+    with open(file=_parse_args(args_list=args_list).parameter_file, mode='r',
+              encoding='utf8') as file:
+        configs = json.load(fp=file)
+    if 'sweep' not in configs:
+        return []
+    return _expand_sweep(configs)
+
+
+def replace_parameter_file(args_list: List[str], parameter_file: str) -> List[str]:
+    """!
+    @brief Swap the configuration file on a command line for another, keeping every other argument.
+    @param args_list The arguments straight from the command line.
+    @param parameter_file The configuration file to use instead.
+    @return The new arguments.
+    """
+    separator = args_list.index('--') + 1
+    script_args = args_list[separator:]
+    original_index = script_args.index(_parse_args(args_list=args_list).parameter_file)
+    return args_list[:separator] + script_args[:original_index] + [parameter_file] + \
+        script_args[original_index + 1:]
+
+
+def get_job_directory(args_list: List[str]) -> str:
+    """!
+    @brief Find the job directory to serve, if the command line asks for the long-lived job mode.
+    @param args_list The arguments straight from the command line.
+    @return The job directory, or None if this is a normal run.
+    """
+    return _parse_args(args_list=args_list).serve
+
+
+def _check_range(execution_configs: Dict, pose_count: int) -> None:
+    """!
+    @brief Verify the trajectory range assigned to this process fits within the trajectory.
+    @param execution_configs The execution section of the configuration.
+    @param pose_count How many poses are in the trajectory.
+    @return None
+    @exception ValueError Raised if the range is empty or extends past the trajectory.
+    """
+    if execution_configs['start_index'] is None and execution_configs['end_index'] is None:
+        return
+    start_index = execution_configs['start_index'] or 0
+    end_index = execution_configs['end_index']
+    if end_index is None:
+        end_index = pose_count
+    if start_index < 0 or end_index > pose_count or start_index >= end_index:
+        raise ValueError(
+            F'Trajectory range [{start_index}, {end_index}) does not fit within the {pose_count}'
+            F' poses of the trajectory.')
+
+
 def _load_config(filename: str) -> Dict:
     """!
     @brief Read in the user provided configuration JSON.
@@ -45,17 +208,22 @@ def _load_config(filename: str) -> Dict:
     JSON.
     @exception JSONDecoderError Raised if the file is not in JSON format.
     @exception TypeError Raised if any values are the incorrect types.
+    @exception ValueError Raised if any values are outside their allowed range.
     """
     with open(file=filename, mode='r', encoding='utf8') as file:
         configs = json.load(fp=file)
+    # Sweeps are expanded into their variants by the sweep runner, before any is loaded.
+    if 'sweep' in configs:
+        raise ValueError('A configuration with a sweep must be run from the command line')
     # Check for required top level options
     required_keys = ['output', 'trajectory', 'camera', 'sequence']
     if not all(key in configs for key in required_keys):
         raise KeyError('Required value missing from JSON')
-    # Verify the required camera values are present.
-    required_camera_keys = ['name']
-    if not all(key in configs['camera'] for key in required_camera_keys):
-        raise KeyError('Camera name missing from camera_properties in JSON')
+    # A single camera may be given directly, or several as a list. Either way, use a list from here.
+    if isinstance(configs['camera'], dict):
+        configs['camera'] = [configs['camera']]
+    if not isinstance(configs['camera'], list) or len(configs['camera']) == 0:
+        raise TypeError('camera must be an object or a non-empty list of objects')
     # Fill in any optional camera values
     default_camera_properties = {
         'x': 0.0,
@@ -65,9 +233,16 @@ def _load_config(filename: str) -> Dict:
         'pitch': 1.5708,
         'yaw': 0.0
     }
-    for key, _ in default_camera_properties.items():
-        if key not in configs['camera'].keys():
-            configs['camera'][key] = default_camera_properties[key]
+    for camera in configs['camera']:
+        # Verify the required camera values are present.
+        if not isinstance(camera, dict) or 'name' not in camera:
+            raise KeyError('Camera name missing from camera_properties in JSON')
+        for key, _ in default_camera_properties.items():
+            if key not in camera.keys():
+                camera[key] = default_camera_properties[key]
+    camera_names = [camera['name'] for camera in configs['camera']]
+    if len(set(camera_names)) != len(camera_names):
+        raise ValueError(F'Each camera must have a unique name. Got: {camera_names}')
     # Verify the required sequence values are present
     required_sequence_keys = ['texture_number',
                               'sequence_type', 'sequence_number']
@@ -84,10 +259,439 @@ def _load_config(filename: str) -> Dict:
             configs['sequence']['texture_number'])
     except (TypeError, ValueError) as ex:
         raise TypeError('texture_number must be an integer') from ex
+    if 'date' not in configs['sequence']:
+        configs['sequence']['date'] = None
+    if configs['sequence']['date'] is not None:
+        configs['sequence']['date'] = _check_date(configs['sequence']['date'])
+    # Fill in any optional execution values
+    default_execution_properties = {
+        'workers': 1,
+        'resume': False,
+        'pipeline': False,
+        'queue_size': 8,
+        'batch_size': 1,
+        'timing': False,
+        'start_index': None,
+        'end_index': None
+    }
+    if 'execution' not in configs:
+        configs['execution'] = {}
+    for key, _ in default_execution_properties.items():
+        if key not in configs['execution'].keys():
+            configs['execution'][key] = default_execution_properties[key]
+    try:
+        configs['execution']['workers'] = int(configs['execution']['workers'])
+    except (TypeError, ValueError) as ex:
+        raise TypeError('workers must be an integer') from ex
+    if configs['execution']['workers'] < 1:
+        raise ValueError('workers must be at least 1')
+    for key in ['resume', 'pipeline', 'timing']:
+        if not isinstance(configs['execution'][key], bool):
+            raise TypeError(F'{key} must be true or false')
+    try:
+        configs['execution']['queue_size'] = int(configs['execution']['queue_size'])
+    except (TypeError, ValueError) as ex:
+        raise TypeError('queue_size must be an integer') from ex
+    if configs['execution']['queue_size'] < 1:
+        raise ValueError('queue_size must be at least 1')
+    try:
+        configs['execution']['batch_size'] = int(configs['execution']['batch_size'])
+    except (TypeError, ValueError) as ex:
+        raise TypeError('batch_size must be an integer') from ex
+    if configs['execution']['batch_size'] < 1:
+        raise ValueError('batch_size must be at least 1')
+    for key in ['start_index', 'end_index']:
+        if configs['execution'][key] is None:
+            continue
+        try:
+            configs['execution'][key] = int(configs['execution'][key])
+        except (TypeError, ValueError) as ex:
+            raise TypeError(F'{key} must be an integer') from ex
+        if configs['execution'][key] < 0:
+            raise ValueError(F'{key} must not be negative')
+    # Fill in any optional image values. A value of None keeps the setting saved in Blender.
+    default_image_properties = {
+        'format': 'PNG',
+        'color_depth': None,
+        'compression': None
+    }
+    if 'image' not in configs:
+        configs['image'] = {}
+    for key, _ in default_image_properties.items():
+        if key not in configs['image'].keys():
+            configs['image'][key] = default_image_properties[key]
+    image_format = configs['image']['format']
+    if image_format not in IMAGE_EXTENSIONS:
+        raise ValueError(
+            F'Image format must be one of {list(IMAGE_EXTENSIONS.keys())}, not {image_format}')
+    if configs['image']['color_depth'] is not None:
+        configs['image']['color_depth'] = str(configs['image']['color_depth'])
+        if configs['image']['color_depth'] not in _IMAGE_COLOR_DEPTHS[image_format]:
+            raise ValueError(
+                F'{image_format} color_depth must be one of {_IMAGE_COLOR_DEPTHS[image_format]}')
+    if configs['image']['compression'] is not None:
+        if image_format != 'PNG':
+            raise ValueError('compression can only be set for PNG images')
+        try:
+            configs['image']['compression'] = int(configs['image']['compression'])
+        except (TypeError, ValueError) as ex:
+            raise TypeError('compression must be an integer') from ex
+        if configs['image']['compression'] < 0 or configs['image']['compression'] > 9:
+            raise ValueError('compression must be from 0 to 9')
+    # Fill in any optional render quality values. None keeps the setting saved in Blender.
+    default_render_properties = {
+        'noise_threshold': None,
+        'min_samples': None,
+        'max_samples': None,
+        'time_limit': None,
+        'denoise': None,
+        'backend': 'blender'
+    }
+    if 'render' not in configs:
+        configs['render'] = {}
+    for key, _ in default_render_properties.items():
+        if key not in configs['render'].keys():
+            configs['render'][key] = default_render_properties[key]
+    for key, value_type in [('noise_threshold', float), ('time_limit', float),
+                            ('min_samples', int), ('max_samples', int)]:
+        if configs['render'][key] is None:
+            continue
+        try:
+            configs['render'][key] = value_type(configs['render'][key])
+        except (TypeError, ValueError) as ex:
+            raise TypeError(F'{key} must be a number') from ex
+    for key in ['noise_threshold', 'time_limit', 'max_samples']:
+        if configs['render'][key] is not None and configs['render'][key] <= 0:
+            raise ValueError(F'{key} must be greater than 0')
+    if configs['render']['min_samples'] is not None and configs['render']['min_samples'] < 0:
+        raise ValueError('min_samples must not be negative')
+    if configs['render']['denoise'] is not None and \
+            not isinstance(configs['render']['denoise'], bool):
+        raise TypeError('denoise must be true or false')
+    if configs['render']['backend'] not in _BACKENDS:
+        raise ValueError(
+            F'Render backend must be one of {_BACKENDS}, not {configs["render"]["backend"]}')
+    # Fill in any optional device values. A type of None keeps the user's Blender preferences.
+    default_device_properties = {
+        'type': None,
+        'indices': None
+    }
+    if 'device' not in configs:
+        configs['device'] = {}
+    for key, _ in default_device_properties.items():
+        if key not in configs['device'].keys():
+            configs['device'][key] = default_device_properties[key]
+    device_type = configs['device']['type']
+    if device_type is not None and device_type not in _DEVICE_TYPES:
+        raise ValueError(F'Device type must be one of {_DEVICE_TYPES}, not {device_type}')
+    device_indices = configs['device']['indices']
+    if device_indices is not None:
+        if device_type is None or device_type == 'CPU':
+            raise ValueError('Device indices can only be set for a GPU device type')
+        if not isinstance(device_indices, list) or len(device_indices) == 0 or \
+                not all(isinstance(index, int) and index >= 0 for index in device_indices):
+            raise TypeError('Device indices must be a non-empty list of non-negative integers')
+        if len(set(device_indices)) != len(device_indices):
+            raise ValueError(F'Device indices must be unique. Got: {device_indices}')
+    # Fill in any optional list file values
+    default_list_properties = {
+        'flush_interval': 100,
+        'pose_records': False
+    }
+    if 'lists' not in configs:
+        configs['lists'] = {}
+    for key, _ in default_list_properties.items():
+        if key not in configs['lists'].keys():
+            configs['lists'][key] = default_list_properties[key]
+    try:
+        configs['lists']['flush_interval'] = int(configs['lists']['flush_interval'])
+    except (TypeError, ValueError) as ex:
+        raise TypeError('flush_interval must be an integer') from ex
+    if configs['lists']['flush_interval'] < 1:
+        raise ValueError('flush_interval must be at least 1')
+    if not isinstance(configs['lists']['pose_records'], bool):
+        raise TypeError('pose_records must be true or false')
+    # Fill in any optional deduplication values. A pixel tolerance of None renders every pose.
+    default_deduplicate_properties = {
+        'pixel_tolerance': None,
+        'yaw_tolerance': 0.001,
+        'method': 'link'
+    }
+    if 'deduplicate' not in configs:
+        configs['deduplicate'] = {}
+    for key, _ in default_deduplicate_properties.items():
+        if key not in configs['deduplicate'].keys():
+            configs['deduplicate'][key] = default_deduplicate_properties[key]
+    if configs['deduplicate']['pixel_tolerance'] is not None:
+        try:
+            configs['deduplicate']['pixel_tolerance'] = float(
+                configs['deduplicate']['pixel_tolerance'])
+        except (TypeError, ValueError) as ex:
+            raise TypeError('pixel_tolerance must be a number') from ex
+        if configs['deduplicate']['pixel_tolerance'] <= 0:
+            raise ValueError('pixel_tolerance must be greater than 0')
+    try:
+        configs['deduplicate']['yaw_tolerance'] = float(configs['deduplicate']['yaw_tolerance'])
+    except (TypeError, ValueError) as ex:
+        raise TypeError('yaw_tolerance must be a number') from ex
+    if configs['deduplicate']['yaw_tolerance'] < 0:
+        raise ValueError('yaw_tolerance must not be negative')
+    if configs['deduplicate']['method'] not in ['link', 'copy']:
+        raise ValueError('Deduplicate method must be "link" or "copy"')
+    # Fill in any optional mosaic values. The area is only required when rendering a mosaic.
+    default_mosaic_properties = {
+        'x_min': None,
+        'y_min': None,
+        'x_max': None,
+        'y_max': None,
+        'tile_size': 1024,
+        'compress': True
+    }
+    if 'mosaic' not in configs:
+        configs['mosaic'] = {}
+    for key, _ in default_mosaic_properties.items():
+        if key not in configs['mosaic'].keys():
+            configs['mosaic'][key] = default_mosaic_properties[key]
+    limit_keys = ['x_min', 'y_min', 'x_max', 'y_max']
+    if any(configs['mosaic'][key] is not None for key in limit_keys):
+        for key in limit_keys:
+            try:
+                configs['mosaic'][key] = float(configs['mosaic'][key])
+            except (TypeError, ValueError) as ex:
+                raise TypeError(F'Mosaic {key} must be a number') from ex
+        if configs['mosaic']['x_max'] <= configs['mosaic']['x_min'] or \
+                configs['mosaic']['y_max'] <= configs['mosaic']['y_min']:
+            raise ValueError('Mosaic x_max and y_max must be greater than x_min and y_min')
+    try:
+        configs['mosaic']['tile_size'] = int(configs['mosaic']['tile_size'])
+    except (TypeError, ValueError) as ex:
+        raise TypeError('tile_size must be an integer') from ex
+    if configs['mosaic']['tile_size'] < 16 or configs['mosaic']['tile_size'] % 16 != 0:
+        raise ValueError('tile_size must be a positive multiple of 16')
+    if not isinstance(configs['mosaic']['compress'], bool):
+        raise TypeError('Mosaic compress must be true or false')
+    # Fill in any optional dry run values. A cell size of None picks one from the image footprint.
+    default_dry_run_properties = {
+        'cell_size': None,
+        'min_overlap': 0.3
+    }
+    if 'dry_run' not in configs:
+        configs['dry_run'] = {}
+    for key, _ in default_dry_run_properties.items():
+        if key not in configs['dry_run'].keys():
+            configs['dry_run'][key] = default_dry_run_properties[key]
+    if configs['dry_run']['cell_size'] is not None:
+        try:
+            configs['dry_run']['cell_size'] = float(configs['dry_run']['cell_size'])
+        except (TypeError, ValueError) as ex:
+            raise TypeError('cell_size must be a number') from ex
+        if configs['dry_run']['cell_size'] <= 0:
+            raise ValueError('cell_size must be greater than 0')
+    try:
+        configs['dry_run']['min_overlap'] = float(configs['dry_run']['min_overlap'])
+    except (TypeError, ValueError) as ex:
+        raise TypeError('min_overlap must be a number') from ex
+    if not 0.0 <= configs['dry_run']['min_overlap'] <= 1.0:
+        raise ValueError('min_overlap must be between 0 and 1')
+    # Fill in any optional motion blur values. A shutter of None keeps the setting saved in Blender.
+    default_motion_blur_properties = {
+        'shutter': None,
+        'rolling_shutter': None
+    }
+    if 'motion_blur' not in configs:
+        configs['motion_blur'] = {}
+    for key, _ in default_motion_blur_properties.items():
+        if key not in configs['motion_blur'].keys():
+            configs['motion_blur'][key] = default_motion_blur_properties[key]
+    for key in ['shutter', 'rolling_shutter']:
+        if configs['motion_blur'][key] is None:
+            continue
+        try:
+            configs['motion_blur'][key] = float(configs['motion_blur'][key])
+        except (TypeError, ValueError) as ex:
+            raise TypeError(F'{key} must be a number') from ex
+    if configs['motion_blur']['shutter'] is not None:
+        if not 0.0 < configs['motion_blur']['shutter'] <= 1.0:
+            raise ValueError('shutter must be greater than 0 and at most 1')
+        # Batches already keyframe the camera, and deduplicated poses would reuse images blurred
+        # by different motion.
+        if configs['execution']['batch_size'] > 1 or \
+                configs['deduplicate']['pixel_tolerance'] is not None:
+            raise ValueError('Motion blur can not be combined with batches or deduplication')
+    if configs['motion_blur']['rolling_shutter'] is not None:
+        if configs['motion_blur']['shutter'] is None:
+            raise ValueError('rolling_shutter requires a shutter')
+        if not 0.0 <= configs['motion_blur']['rolling_shutter'] <= 1.0:
+            raise ValueError('rolling_shutter must be between 0 and 1')
+    # Fill in any optional image pyramid values. No factors writes only the full resolution.
+    default_pyramid_properties = {
+        'factors': []
+    }
+    if 'pyramid' not in configs:
+        configs['pyramid'] = {}
+    for key, _ in default_pyramid_properties.items():
+        if key not in configs['pyramid'].keys():
+            configs['pyramid'][key] = default_pyramid_properties[key]
+    factors = configs['pyramid']['factors']
+    if not isinstance(factors, list) or \
+            not all(isinstance(factor, int) and not isinstance(factor, bool) for factor in factors):
+        raise TypeError('Pyramid factors must be a list of integers')
+    if not all(factor >= 2 for factor in factors) or len(set(factors)) != len(factors):
+        raise ValueError(F'Pyramid factors must be unique and at least 2. Got: {factors}')
+    if len(factors) > 0 and configs['image']['format'] != 'PNG':
+        raise ValueError('Image pyramids are only written as PNG images')
+    # Fill in any optional shard values. No shard size writes each image as its own file.
+    default_shard_properties = {
+        'images_per_shard': None
+    }
+    if 'shards' not in configs:
+        configs['shards'] = {}
+    for key, _ in default_shard_properties.items():
+        if key not in configs['shards'].keys():
+            configs['shards'][key] = default_shard_properties[key]
+    images_per_shard = configs['shards']['images_per_shard']
+    if images_per_shard is not None:
+        if not isinstance(images_per_shard, int) or isinstance(images_per_shard, bool):
+            raise TypeError('images_per_shard must be an integer')
+        if images_per_shard < 1:
+            raise ValueError('images_per_shard must be at least 1')
+        # Resuming checks for each image on disk, which packed images are not.
+        if configs['execution']['resume']:
+            raise ValueError('Shards can not be combined with resume')
+    # Fill in any optional status values. No interval writes no status files.
+    default_status_properties = {
+        'interval': None,
+        'prometheus': False
+    }
+    if 'status' not in configs:
+        configs['status'] = {}
+    for key, _ in default_status_properties.items():
+        if key not in configs['status'].keys():
+            configs['status'][key] = default_status_properties[key]
+    if configs['status']['interval'] is not None:
+        try:
+            configs['status']['interval'] = float(configs['status']['interval'])
+        except (TypeError, ValueError) as ex:
+            raise TypeError('The status interval must be a number') from ex
+        if configs['status']['interval'] <= 0.0:
+            raise ValueError('The status interval must be greater than 0')
+    if not isinstance(configs['status']['prometheus'], bool):
+        raise TypeError('prometheus must be true or false')
+    if configs['status']['prometheus'] and configs['status']['interval'] is None:
+        raise ValueError('The Prometheus status requires a status interval')
+    # Fill in any optional texture values. No cache renders with the textures saved in the scene.
+    default_texture_properties = {
+        'cache': None,
+        'max_size': None
+    }
+    if 'textures' not in configs:
+        configs['textures'] = {}
+    for key, _ in default_texture_properties.items():
+        if key not in configs['textures'].keys():
+            configs['textures'][key] = default_texture_properties[key]
+    if configs['textures']['cache'] is not None and \
+            not isinstance(configs['textures']['cache'], str):
+        raise TypeError('The texture cache must be a folder name')
+    max_size = configs['textures']['max_size']
+    if max_size is not None:
+        if not isinstance(max_size, int) or isinstance(max_size, bool):
+            raise TypeError('The maximum texture size must be an integer')
+        if max_size < 1:
+            raise ValueError('The maximum texture size must be at least 1')
+        if configs['textures']['cache'] is None:
+            raise ValueError('The maximum texture size requires a texture cache')
+    # Fill in any optional preview values. A texture of None uses the ground's own diffuse texture.
+    default_preview_properties = {
+        'ground': 'Ground',
+        'texture': None
+    }
+    if 'preview' not in configs:
+        configs['preview'] = {}
+    for key, _ in default_preview_properties.items():
+        if key not in configs['preview'].keys():
+            configs['preview'][key] = default_preview_properties[key]
+    if not isinstance(configs['preview']['ground'], str) or \
+            (configs['preview']['texture'] is not None and
+             not isinstance(configs['preview']['texture'], str)):
+        raise TypeError('The preview ground and texture must be names')
+    if configs['render']['backend'] == 'preview':
+        _check_preview(configs)
     return configs
 
 
-def _load_trajectory(filename: str) -> List[List[float]]:
+def _check_preview(configs: Dict) -> None:
+    """!
+    @brief Verify the rest of the configuration can be previewed.
+
+    Previews are always written as PNG images, straight from the texture, so they can't be staged
+    as the TIFF images an image pyramid needs.
+
+    @param configs The configuration, with every section filled in.
+    @return None
+    @exception ValueError Raised if the configuration uses something previews don't support.
+    """
+    if configs['image']['format'] != 'PNG':
+        raise ValueError('Previews are only written as PNG images')
+    if len(configs['pyramid']['factors']) > 0:
+        raise ValueError('Previews can not be combined with an image pyramid')
+
+
+def _expand_sweep(configs: Dict) -> List[Tuple[Dict, Dict]]:
+    """!
+    @brief Expand the sweep section of a configuration into one configuration per variant.
+
+    The sweep maps the path of a setting, written as in the README such as "camera/z", to the list
+    of values to try. Every combination of the values is a variant, with the first path changing
+    slowest. Where the path passes through a list, such as several cameras, the value is set in
+    every element. Each variant writes to its own folder, *output*/sweep_\<number\>, so their list
+    files never collide.
+
+    @param configs The configuration as read from the JSON, including its sweep section.
+    @return For each variant, the values the sweep set and the variant's whole configuration,
+    without the sweep section.
+    @exception KeyError Raised if a path is empty.
+    @exception TypeError Raised if the sweep is not an object of non-empty lists.
+    """
+    sweep = configs['sweep']
+    if not isinstance(sweep, dict) or len(sweep) == 0 or \
+            not all(isinstance(values, list) and len(values) > 0 for values in sweep.values()):
+        raise TypeError('sweep must be an object mapping each setting to a non-empty list')
+    base_configs = {key: value for key, value in configs.items() if key != 'sweep'}
+    result = []
+    for number, values in enumerate(itertools.product(*sweep.values())):
+        overrides = dict(zip(sweep.keys(), values))
+        variant = copy.deepcopy(base_configs)
+        for setting_path, value in overrides.items():
+            keys = [key for key in setting_path.split('/') if key != '']
+            if len(keys) == 0:
+                raise KeyError(F'Sweep setting "{setting_path}" is empty')
+            _set_config_value(variant, keys, value)
+        variant['output'] = os.path.join(base_configs['output'], F'sweep_{number:03d}')
+        result.append((overrides, variant))
+    return result
+
+
+def _set_config_value(configs: Union[Dict, List], keys: List[str], value) -> None:
+    """!
+    @brief Set one setting of a configuration, creating any missing sections on the way.
+    @param configs The configuration, or the part of it the keys start from.
+    @param keys The path of the setting, split into its keys.
+    @param value The value to set.
+    @return None
+    """
+    if isinstance(configs, list):
+        for element in configs:
+            _set_config_value(element, keys, value)
+        return
+    if len(keys) == 1:
+        configs[keys[0]] = copy.deepcopy(value)
+        return
+    if keys[0] not in configs:
+        configs[keys[0]] = {}
+    _set_config_value(configs[keys[0]], keys[1:], value)
+
+
+def _load_trajectory(filename: Union[str, Dict]) -> Trajectory:
     """!
     @brief Read in the poses from the trajectory file.
 
@@ -95,11 +699,23 @@ def _load_trajectory(filename: str) -> List[List[float]]:
     (whitespace is optional). The theta value should be in radians. These coordinates are where the
     "robot" will be placed in the simulated world.
 
-    @param filename The file to read from. May be absolute or relative path.
-    @return A list of poses, where each item in the list is a list of the form [x, y, theta].
+    Files ending in .npy or .bin are instead read as binary, using @ref _map_trajectory. Instead of
+    a file, the trajectory section of the configuration may describe a generator, in which case
+    no file is read. See @ref create_trajectory.
+
+    @param filename The file to read from. May be absolute or relative path. Or, the dictionary
+    describing a generated trajectory.
+    @return A list of poses, where each item in the list is a list of the form [x, y, theta]. For
+    binary files, this is a read only, memory-mapped Nx3 Numpy array instead. For generators, it
+    is a @ref GeneratedTrajectory, which computes the poses as they are used.
     @exception FileNotFoundError Raised if the file provided in filename does not exist.
     @exception RuntimeError Raised if the pose format does not follow the correct structure.
+    @exception KeyError, TypeError, ValueError Raised if the generator is not correctly described.
     """
+    if isinstance(filename, dict):
+        return create_trajectory(filename)
+    if os.path.splitext(filename)[1].lower() in ['.npy', '.bin']:
+        return _map_trajectory(filename)
     result = []
     with open(file=filename, mode='r', encoding='utf8') as file:
         for line in file:
@@ -124,16 +740,79 @@ def _load_trajectory(filename: str) -> List[List[float]]:
     return result
 
 
-def _parse_args(args_list: List[str]) -> str:
+def _map_trajectory(filename: str) -> numpy.ndarray:
+    """!
+    @brief Memory-map the poses of a binary trajectory file, without reading them all in.
+
+    A .npy file must hold a 2D floating point array with one X, Y, Theta row per pose. A .bin file
+    is the same, but as raw little-endian 64 bit floats with no header. Only the poses actually
+    used are read from disk, so even very large trajectories take little memory.
+
+    @param filename The file to read from. May be absolute or relative path.
+    @return A read only Nx3 Numpy array of the poses.
+    @exception FileNotFoundError Raised if the file provided in filename does not exist.
+    @exception RuntimeError Raised if the file is not an array of poses.
+    """
+    if filename.lower().endswith('.npy'):
+        try:
+            trajectory = numpy.load(filename, mmap_mode='r')
+        except ValueError as error:
+            raise RuntimeError(F'{filename} is not a valid .npy file.') from error
+    elif os.path.getsize(filename) == 0:
+        # An empty file can't be memory-mapped, but is still an empty trajectory.
+        trajectory = numpy.zeros((0, 3))
+    else:
+        trajectory = numpy.memmap(filename, dtype='<f8', mode='r')
+        if trajectory.size % 3 != 0:
+            raise RuntimeError(
+                F'{filename} must hold 3 floats per pose, but holds {trajectory.size} floats.')
+        trajectory = trajectory.reshape((-1, 3))
+    if trajectory.ndim != 2 or trajectory.shape[1] != 3 or trajectory.dtype.kind != 'f':
+        raise RuntimeError(
+            F'{filename} must hold an Nx3 array of floats, not {trajectory.shape} of '
+            F'{trajectory.dtype}.')
+    return trajectory
+
+
+def _check_date(date: str) -> str:
+    """!
+    @brief Verify a collection date is given as YYYY-MM-DD.
+    @param date The date.
+    @return The date as YYYY-MM-DD, with the month and day padded to two digits.
+    @exception TypeError raised if the date is not a string.
+    @exception ValueError raised if the date is not a valid YYYY-MM-DD date.
+    """
+    if not isinstance(date, str):
+        raise TypeError(F'The sequence date must be a YYYY-MM-DD string, not {date}')
+    try:
+        parsed_date = datetime.datetime.strptime(date, '%Y-%m-%d').date()
+    except ValueError as ex:
+        raise ValueError(F'The sequence date must be given as YYYY-MM-DD, not {date}') from ex
+    return parsed_date.isoformat()
+
+
+def _parse_args(args_list: List[str]) -> argparse.Namespace:
     """!
     @brief Parse the command line for the location of the configuration file.
 
     Since this is only ever called as part of Blender, it must first remove any Blender-specific
     arguments. Blender ignores everything after a '--', so use that to split. Then, the only
-    required argument is the JSON file location.
+    required argument is the JSON file location. The optional start and end indices restrict the
+    run to part of the trajectory, such as one node's share of a sequence split across machines.
+    The script also uses them when it launches its own workers. The merge flag builds the list
+    files from every node's partial results instead of rendering. The mosaic flag renders the
+    global image of the floor instead of the trajectory, and the start and end then count tiles.
+    The dry run flag reports frame overlap and floor coverage without rendering. The date sets the
+    date the sequence was collected on, overriding the JSON, and is given to every worker.
+    Instead of a JSON file, a job directory may be given to serve, in which case the JSON files come
+    from there.
 
     @param args_list The arguments straight from the command line
-    @return The filename of the JSON.
+    @return The parsed arguments. parameter_file holds the filename of the JSON, start and end hold
+    the trajectory index range, workers holds the worker count, and device_index holds the one GPU
+    to render on, and date holds the collection date, each None if not provided.
+    merge, mosaic, dry_run, plan, and preview are true if their flags were given. serve holds the
+    job directory, or None if not serving.
     """
     if '--' not in args_list:
         args_list = []
@@ -142,7 +821,42 @@ def _parse_args(args_list: List[str]) -> str:
     parser = argparse.ArgumentParser(
         description='A script to generate texture data in Blender.')
     parser.add_argument(
-        'parameter_file', help='The JSON file specifying all parameters.')
+        'parameter_file', nargs='?', default=None,
+        help='The JSON file specifying all parameters. Required unless serving a job directory.')
+    parser.add_argument(
+        '--start', type=int, default=None,
+        help='The first trajectory index to render.')
+    parser.add_argument(
+        '--end', type=int, default=None,
+        help='One past the last trajectory index to render.')
+    parser.add_argument(
+        '--workers', type=int, default=None,
+        help='The number of Blender processes to render with, overriding the JSON.')
+    parser.add_argument(
+        '--device-index', type=int, default=None,
+        help='Render on only this GPU, overriding the JSON. Workers are assigned one each.')
+    parser.add_argument(
+        '--date', default=None, metavar='YYYY-MM-DD',
+        help='The date the sequence was collected on, overriding the JSON.')
+    parser.add_argument(
+        '--merge', action='store_true',
+        help='Build the list files from the partial results of every node, then exit.')
+    parser.add_argument(
+        '--mosaic', action='store_true',
+        help='Render the global image of the floor as a tiled TIFF instead of the trajectory.')
+    parser.add_argument(
+        '--dry-run', action='store_true',
+        help='Report frame overlap and floor coverage of the trajectory without rendering.')
+    parser.add_argument(
+        '--plan', action='store_true',
+        help='Plan and check every pose and output of the trajectory without rendering.')
+    parser.add_argument(
+        '--preview', action='store_true',
+        help='Preview each image from the floor texture instead of rendering it with Blender.')
+    parser.add_argument(
+        '--serve', default=None, metavar='JOB_DIRECTORY',
+        help='Stay running and render each JSON placed in this directory, keeping Blender loaded.')
     parsed_args = parser.parse_args(args_list)
-    param_file = parsed_args.parameter_file
-    return param_file
+    if parsed_args.parameter_file is None and parsed_args.serve is None:
+        parser.error('the following arguments are required: parameter_file')
+    return parsed_args
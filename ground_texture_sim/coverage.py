@@ -0,0 +1,166 @@
+"""!
+@brief This module provides the tools to measure how much consecutive frames of a trajectory overlap
+and how much of the floor they cover, without rendering anything.
+"""
+from typing import Dict, Tuple
+import numpy
+from ground_texture_sim.transforms import Transformer, create_planar_transform_matrices
+
+## The most cells the coverage raster may have, which bounds its memory to 400 MB.
+_MAX_RASTER_CELLS = 100000000
+## How many poses to project at once. This bounds the memory of the sample points.
+_BLOCK_SIZE = 4096
+
+
+class CoverageAnalyzer():
+    """!
+    @brief A class that accumulates frame overlap and floor coverage statistics for one camera.
+
+    Each image is represented by a grid of sample pixels, spaced half a raster cell apart, that are
+    projected onto the floor once. The overlap of consecutive frames is the fraction of the first
+    frame's samples that land inside the second frame's image. The coverage raster counts, for each
+    cell of the floor, how many frames saw it. Poses are passed in chunks, so any length of
+    trajectory can be analyzed in bounded memory.
+    """
+
+    def __init__(self, transformer: Transformer, image_size: Tuple[int, int],
+                 x_limits: Tuple[float, float], y_limits: Tuple[float, float],
+                 cell_size: float = None) -> None:
+        """!
+        @brief Construct the analyzer and its empty coverage raster.
+        @param transformer The transformer of the camera to analyze.
+        @param image_size The width and height of the camera's images, in pixels.
+        @param x_limits The smallest and largest X of the robot, in meters, in the world frame.
+        @param y_limits The smallest and largest Y of the robot, in meters, in the world frame.
+        @param cell_size The width of each raster cell, in meters. If None, it is an eighth of the
+        shorter side of an image's footprint on the floor.
+        @exception ValueError raised if the cell size is not positive or the raster would be too
+        large.
+        """
+        ## The transformer of the camera to analyze.
+        self._transformer = transformer
+        ## The width and height of the camera's images, in pixels.
+        self._image_size = image_size
+        width, height = image_size
+        corners = transformer.project_pixels_to_robot(
+            [[0.0, 0.0], [width, 0.0], [width, height], [0.0, height]])
+        ## The width and height of an image's footprint on the floor, in meters.
+        self.footprint = (float(numpy.linalg.norm(corners[1, 0:2] - corners[0, 0:2])),
+                          float(numpy.linalg.norm(corners[2, 0:2] - corners[1, 0:2])))
+        if cell_size is None:
+            cell_size = min(self.footprint) / 8.0
+        if cell_size <= 0:
+            raise ValueError('The coverage cell size must be greater than 0')
+        ## The width of each raster cell, in meters.
+        self.cell_size = cell_size
+        columns = int(numpy.ceil(2.0 * self.footprint[0] / cell_size))
+        rows = int(numpy.ceil(2.0 * self.footprint[1] / cell_size))
+        # Sample the center of each cell of a grid over the image.
+        sample_x, sample_y = numpy.meshgrid((numpy.arange(columns) + 0.5) * width / columns,
+                                            (numpy.arange(rows) + 0.5) * height / rows)
+        ## The sample points of an image on the floor, as Mx4 homogenous points in the robot frame.
+        self._samples = transformer.project_pixels_to_robot(
+            numpy.column_stack((sample_x.ravel(), sample_y.ravel())))
+        # Any part of an image can be as far from the robot as its furthest corner.
+        reach = float(numpy.max(numpy.linalg.norm(corners[:, 0:2], axis=1)))
+        ## The X and Y, in meters, of the corner of the raster's first cell.
+        self.raster_origin = (x_limits[0] - reach, y_limits[0] - reach)
+        raster_shape = (int(numpy.ceil((y_limits[1] - y_limits[0] + 2.0 * reach) / cell_size)),
+                        int(numpy.ceil((x_limits[1] - x_limits[0] + 2.0 * reach) / cell_size)))
+        if raster_shape[0] * raster_shape[1] > _MAX_RASTER_CELLS:
+            raise ValueError(
+                F'A coverage raster of {raster_shape[1]}x{raster_shape[0]} cells is too large. '
+                F'Use a larger cell size.')
+        ## How many frames saw each cell of the floor. Rows follow Y and columns follow X.
+        self.raster = numpy.zeros(raster_shape, dtype=numpy.uint32)
+        ## The overlap of each pair of consecutive frames, one array per block of poses.
+        self._overlaps = []
+        ## The total number of poses analyzed.
+        self._pose_count = 0
+        ## The last pose of the previous chunk, so overlap carries across chunks.
+        self._last_pose = None
+
+    def add_poses(self, robot_poses: numpy.ndarray) -> None:
+        """!
+        @brief Add the next poses of the trajectory to the statistics.
+        @param robot_poses Either an Nx4x4 Numpy array of homogenous robot poses or an Nx3 array of
+        planar X, Y, and yaw poses, all measured from the world frame, following any already added.
+        @return None
+        """
+        robot_poses = numpy.asarray(robot_poses, dtype=float)
+        if robot_poses.ndim == 2:
+            robot_poses = create_planar_transform_matrices(robot_poses)
+        for block_start in range(0, robot_poses.shape[0], _BLOCK_SIZE):
+            self._add_block(robot_poses[block_start:block_start + _BLOCK_SIZE])
+
+    def summary(self, min_overlap: float) -> Dict:
+        """!
+        @brief Summarize the statistics of every pose added so far.
+        @param min_overlap The smallest overlap of consecutive frames that is acceptable.
+        @return A dictionary of the pose count, footprint, and cell size, plus the overlap of
+        consecutive frames and the coverage of the floor. Overlap statistics are None if there is
+        no pair of frames.
+        """
+        overlaps = numpy.concatenate([numpy.zeros(0)] + self._overlaps)
+        overlap_summary = {'mean': None, 'min': None, 'p5': None, 'p50': None}
+        if overlaps.size > 0:
+            overlap_summary = {
+                'mean': float(numpy.mean(overlaps)),
+                'min': float(numpy.min(overlaps)),
+                'p5': float(numpy.percentile(overlaps, 5)),
+                'p50': float(numpy.percentile(overlaps, 50))
+            }
+        overlap_summary['minimum'] = min_overlap
+        overlap_summary['below_minimum'] = int(numpy.count_nonzero(overlaps < min_overlap))
+        observed = self.raster[self.raster > 0]
+        return {
+            'poses': self._pose_count,
+            'footprint': list(self.footprint),
+            'cell_size': self.cell_size,
+            'overlap': overlap_summary,
+            'coverage': {
+                'covered_area': float(observed.size * self.cell_size ** 2),
+                'mean_observations': float(numpy.mean(observed)) if observed.size > 0 else 0.0,
+                'observed_twice_fraction':
+                    float(numpy.count_nonzero(observed >= 2) / observed.size)
+                    if observed.size > 0 else 0.0
+            }
+        }
+
+    def _add_block(self, robot_poses: numpy.ndarray) -> None:
+        """!
+        @brief Add one block of poses to the overlap statistics and the coverage raster.
+        @param robot_poses An Nx4x4 Numpy array of homogenous robot poses.
+        @return None
+        """
+        if robot_poses.shape[0] == 0:
+            return
+        # The overlap of each frame with the one before it, including the last of the last block.
+        previous_poses = robot_poses[:-1]
+        next_poses = robot_poses[1:]
+        if self._last_pose is not None:
+            previous_poses = numpy.concatenate((self._last_pose[numpy.newaxis], previous_poses))
+            next_poses = robot_poses
+        if previous_poses.shape[0] > 0:
+            relative_poses = numpy.linalg.inv(next_poses) @ previous_poses
+            pixels = self._transformer.project_robot_to_pixels(
+                numpy.swapaxes(relative_poses @ self._samples.transpose(), 1, 2))
+            inside = (pixels[..., 0] >= 0.0) & (pixels[..., 0] <= self._image_size[0]) & \
+                (pixels[..., 1] >= 0.0) & (pixels[..., 1] <= self._image_size[1])
+            self._overlaps.append(numpy.mean(inside, axis=1))
+        self._last_pose = robot_poses[-1]
+        self._pose_count += robot_poses.shape[0]
+        # Find the cells each frame saw, counting each cell once per frame.
+        world_samples = robot_poses @ self._samples.transpose()
+        columns = numpy.floor(
+            (world_samples[:, 0, :] - self.raster_origin[0]) / self.cell_size).astype(numpy.int64)
+        rows = numpy.floor(
+            (world_samples[:, 1, :] - self.raster_origin[1]) / self.cell_size).astype(numpy.int64)
+        valid = (rows >= 0) & (rows < self.raster.shape[0]) & (columns >= 0) & \
+            (columns < self.raster.shape[1])
+        frames = numpy.broadcast_to(numpy.arange(robot_poses.shape[0])[:, numpy.newaxis],
+                                    rows.shape)
+        cells = rows[valid] * self.raster.shape[1] + columns[valid]
+        frame_cells = numpy.unique(frames[valid] * self.raster.size + cells)
+        cells, counts = numpy.unique(frame_cells % self.raster.size, return_counts=True)
+        self.raster.flat[cells] += counts.astype(numpy.uint32)
@@ -1,11 +1,42 @@
 """!
 @brief This module provides a class that writes all the data to the correct files.
 """
+import datetime
+import glob
+import json
 import os
-from typing import List
+import shutil
+from typing import Dict, List, Set
 import numpy
 from ground_texture_sim.name_configuration import NameConfigurator
-from ground_texture_sim.transforms import create_transform_matrix
+from ground_texture_sim.transforms import create_planar_transform_matrices
+
+
+## The final 12 bytes of every PNG, which is the empty IEND chunk. Truncated files won't have it.
+_PNG_END = b'\x00\x00\x00\x00IEND\xaeB`\x82'
+## How many little-endian 64 bit floats are in each record of a pose records file: the image
+## number, the robot's X, Y, and yaw, then the image's X, Y, and yaw in the global image.
+POSE_RECORD_SIZE = 7
+
+
+def read_pose_records(file_path: str) -> numpy.ndarray:
+    """!
+    @brief Memory-map a pose records file, as written next to the list files, without reading it.
+    @param file_path The file to read from.
+    @return A read only Nx7 Numpy array with one row per image. The columns are the image number,
+    the robot's X and Y in meters and yaw in radians, then the X and Y in pixels and yaw in radians
+    of the image's top left corner in the global image.
+    @exception RuntimeError raised if the file does not hold whole records.
+    """
+    if os.path.getsize(file_path) == 0:
+        # An empty file can't be memory-mapped, but still holds no records.
+        return numpy.zeros((0, POSE_RECORD_SIZE))
+    records = numpy.memmap(file_path, dtype='<f8', mode='r')
+    if records.size % POSE_RECORD_SIZE != 0:
+        raise RuntimeError(
+            F'{file_path} must hold {POSE_RECORD_SIZE} floats per record, but holds '
+            F'{records.size} floats.')
+    return records.reshape((-1, POSE_RECORD_SIZE))
 
 
 class DataWriter:
@@ -14,7 +45,9 @@ class DataWriter:
     """
 
     def __init__(self, output_folder: str, sequence_type: str, sequence_number: str,
-                 texture_number: str, camera_name: str) -> None:
+                 texture_number: str, camera_name: str, flush_interval: int = 100,
+                 image_extension: str = 'png', separate_lists: bool = False,
+                 pose_records: bool = False, collection_date: datetime.date = None) -> None:
         """!
         @brief Construct the DataWriter and ensure the output directory exists.
         @param output_folder The root output folder under which all data resides.
@@ -23,6 +56,14 @@ class DataWriter:
         this particular data collection event.
         @param texture_number An integer representing the texture type mapped.
         @param camera_name The name of the camera in Blender.
+        @param flush_interval When streaming the lists, how many entries to write between flushes
+        to disk.
+        @param image_extension The file extension of the images, without the leading period.
+        @param separate_lists If true, the camera name is added to the list, checkpoint, and partial
+        result files, so several cameras can write to the same output folder.
+        @param pose_records If true, every write of the lists also writes their poses, at full
+        precision, to a binary file of fixed size records. See @ref read_pose_records.
+        @param collection_date The date the sequence was collected on. If None, today is used.
         """
         ## The folder all data will be written to.
         self._output_directory = output_folder
@@ -36,7 +77,18 @@ class DataWriter:
         self._camera_name = camera_name
         ## A class to help with naming things
         self._namer = NameConfigurator(
-            output_folder, sequence_type, sequence_number, texture_number, camera_name)
+            output_folder, sequence_type, sequence_number, texture_number, camera_name,
+            image_extension, separate_lists, collection_date)
+        ## How many streamed entries to write between flushes.
+        self._flush_interval = flush_interval
+        ## The open .test, _meters.txt, and .txt files while streaming, in that order.
+        self._list_files = []
+        ## How many entries have been streamed since the last flush.
+        self._unflushed_entries = 0
+        ## If the poses are also written to a binary pose records file.
+        self._pose_records = pose_records
+        ## The open pose records file while streaming, or None.
+        self._pose_records_file = None
 
     def _write_array(self, array: numpy.ndarray, file_path: str) -> None:
         """!
@@ -51,17 +103,240 @@ class DataWriter:
         @return None
         """
         # Create a nicely formatted string first.
-        output = ''
+        rows = []
         for i in range(array.shape[0]):
-            for j in range(array.shape[1]):
-                output += F'{array[i, j]:0.6f} '
-            # At the end of the row, remove the trailing space and add a newline.
-            output = output.strip()
-            output += '\n'
+            rows.append(' '.join(F'{array[i, j]:0.6f}' for j in range(array.shape[1])) + '\n')
+        output = ''.join(rows)
         # Now write to file
         with open(file=file_path, mode='w', encoding='utf-8') as file:
             file.write(output)
 
+    def append_list_entry(self, index: int, robot_pose: numpy.ndarray, pixel_pose: numpy.ndarray,
+                          robot_transform: numpy.ndarray, pixel_transform: numpy.ndarray) -> None:
+        """!
+        @brief Append one image's entry to each list file opened by @ref open_lists.
+
+        Entries are written in the same format as @ref write_lists. The files are flushed every
+        flush_interval entries, so a crashed run still leaves usable lists up to that point.
+
+        @param index The image number of this entry.
+        @param robot_pose The ground truth robot pose, in the form [x, y, yaw]. This is written to
+        the pose records as is.
+        @param pixel_pose The pose of the image's top left corner in the global image, in the form
+        [x, y, yaw]. This is written to the pose records as is.
+        @param robot_transform The 4x4 homogenous matrix of the ground truth robot pose.
+        @param pixel_transform The 4x4 homogenous matrix of the pose of the image's top left corner
+        in the global image.
+        @return None
+        @exception RuntimeError raised if the lists are not open.
+        """
+        if len(self._list_files) == 0:
+            raise RuntimeError('List files must be opened before appending entries.')
+        image_path = self._namer.create_image_path(index, absolute=False) + '\n'
+        test_file, meters_txt_file, txt_file = self._list_files
+        test_file.write(image_path)
+        meters_txt_file.write(image_path)
+        meters_txt_file.write(self._format_planar_transform(robot_transform))
+        txt_file.write(image_path)
+        txt_file.write(self._format_planar_transform(pixel_transform))
+        if self._pose_records_file is not None:
+            self._pose_records_file.write(self._create_pose_records(
+                [index], numpy.reshape(robot_pose, (1, 3)),
+                numpy.reshape(pixel_pose, (1, 3))).tobytes())
+        self._unflushed_entries += 1
+        if self._unflushed_entries >= self._flush_interval:
+            for list_file in self._list_files:
+                list_file.flush()
+            if self._pose_records_file is not None:
+                self._pose_records_file.flush()
+            self._unflushed_entries = 0
+
+    def close_lists(self) -> None:
+        """!
+        @brief Close the list files opened by @ref open_lists. This does nothing if none are open.
+        @return None
+        """
+        for list_file in self._list_files:
+            list_file.close()
+        self._list_files = []
+        if self._pose_records_file is not None:
+            self._pose_records_file.close()
+            self._pose_records_file = None
+        self._unflushed_entries = 0
+
+    def open_lists(self) -> None:
+        """!
+        @brief Open the .test, _meters.txt, and .txt files, plus the pose records file if enabled,
+        to stream entries into them.
+
+        Any existing lists for this sequence are replaced. Call @ref append_list_entry as each image
+        is written, then @ref close_lists at the end.
+
+        @return None
+        """
+        self.close_lists()
+        for file_name in (self._namer.test_file, self._namer.meters_txt_file,
+                          self._namer.txt_file):
+            file_path = os.path.join(self._output_directory, file_name)
+            # The files stay open until close_lists, so a with block does not fit here.
+            # pylint: disable-next=consider-using-with
+            self._list_files.append(open(file=file_path, mode='w', encoding='utf-8'))
+        if self._pose_records:
+            file_path = os.path.join(self._output_directory, self._namer.pose_records_file)
+            # pylint: disable-next=consider-using-with
+            self._pose_records_file = open(file=file_path, mode='wb')
+
+    def clear_checkpoint(self) -> None:
+        """!
+        @brief Delete every checkpoint manifest so a fresh run does not inherit an old one.
+        @return None
+        """
+        pattern = os.path.join(self._output_directory, self._namer.checkpoint_file_pattern)
+        for file_path in glob.glob(pattern):
+            os.remove(file_path)
+
+    def image_is_complete(self, index: int) -> bool:
+        """!
+        @brief Check if the image for a given index exists on disk and was fully written.
+
+        Any empty file is rejected. PNG files must also end with the IEND chunk, which catches
+        images that were cut off partway through writing.
+
+        @param index The image number to check.
+        @return True if the image can be reused as is.
+        """
+        image_path = self._namer.create_image_path(index, absolute=True)
+        if not os.path.isfile(image_path):
+            return False
+        size = os.path.getsize(image_path)
+        if size == 0:
+            return False
+        if image_path.endswith('.png'):
+            if size < len(_PNG_END):
+                return False
+            with open(file=image_path, mode='rb') as image_file:
+                image_file.seek(-len(_PNG_END), os.SEEK_END)
+                return image_file.read() == _PNG_END
+        return True
+
+    def read_checkpoint(self) -> Set[int]:
+        """!
+        @brief Read which images a previous run recorded as finished, in any range.
+        @return The set of finished image indices. This is empty if there is no manifest.
+        """
+        pattern = os.path.join(self._output_directory, self._namer.checkpoint_file_pattern)
+        result = set()
+        for file_path in glob.glob(pattern):
+            with open(file=file_path, mode='r', encoding='utf-8') as checkpoint_file:
+                for line in checkpoint_file:
+                    line = line.strip()
+                    # A crash mid-write may leave a partial last line, so only trust whole numbers.
+                    if line.isdigit():
+                        result.add(int(line))
+        return result
+
+    def record_checkpoint(self, index: int, start_index: int, end_index: int) -> None:
+        """!
+        @brief Append an image index to its range's checkpoint manifest once that image is written.
+
+        The file is opened and closed each time so the entry is on disk even if the process dies
+        right after. Only the process rendering the range writes to its manifest, since appends
+        from several machines to one file are not atomic on network file systems.
+
+        @param index The image number that just finished.
+        @param start_index The first trajectory index of the range being rendered.
+        @param end_index One past the last trajectory index of the range being rendered.
+        @return None
+        """
+        file_path = os.path.join(self._output_directory,
+                                 self._namer.checkpoint_file(start_index, end_index))
+        with open(file=file_path, mode='a', encoding='utf-8') as checkpoint_file:
+            checkpoint_file.write(F'{index}\n')
+
+    def read_partial_poses(self, count: int) -> List[List[float]]:
+        """!
+        @brief Merge every partial result file into a single list of pixel poses.
+
+        Each file is named after the range of trajectory indices it covers, so the ranges are
+        recovered from the names and placed back into their spot in the full list.
+
+        @param count The number of poses in the full trajectory.
+        @return A list of pixel poses in trajectory order, in the same form as passed to
+        @ref write_partial_poses.
+        @exception RuntimeError raised if the partial files do not cover every index exactly once.
+        """
+        pattern = os.path.join(self._output_directory, self._namer.partial_file_pattern)
+        result = numpy.full((count, 3), numpy.nan)
+        covered = numpy.zeros(count, dtype=int)
+        for file_path in sorted(glob.glob(pattern)):
+            start_name, end_name = os.path.splitext(
+                os.path.basename(file_path))[0].split('_')[-2:]
+            start_index = int(start_name[1:])
+            end_index = int(end_name[1:])
+            poses = numpy.load(file_path)
+            if poses.shape != (end_index - start_index, 3) or end_index > count:
+                raise RuntimeError(
+                    F'Partial result {file_path} does not match its index range.')
+            result[start_index:end_index, :] = poses
+            covered[start_index:end_index] += 1
+        if not numpy.all(covered == 1):
+            missing = numpy.flatnonzero(covered != 1)
+            raise RuntimeError(
+                F'Partial results do not cover each pose exactly once. First bad index: '
+                F'{missing[0]}')
+        return result.tolist()
+
+    def remove_partial_poses(self) -> None:
+        """!
+        @brief Delete every partial result file once they have been merged.
+        @return None
+        """
+        pattern = os.path.join(self._output_directory, self._namer.partial_file_pattern)
+        for file_path in glob.glob(pattern):
+            os.remove(file_path)
+
+    def write_partial_poses(self, start_index: int, pixel_poses: List[List[float]]) -> None:
+        """!
+        @brief Save the pixel poses rendered by one worker so they can be merged later.
+
+        The poses are stored in Numpy's binary format so no precision is lost compared to a run that
+        keeps everything in memory.
+
+        @param start_index The trajectory index of the first pose in the list.
+        @param pixel_poses A list of poses for the top left corner of each image, in the same form
+        as @ref write_lists.
+        @return None
+        """
+        file_path = os.path.join(self._output_directory, self._namer.partial_file(
+            start_index, start_index + len(pixel_poses)))
+        os.makedirs(os.path.dirname(file_path), exist_ok=True)
+        numpy.save(file_path, numpy.array(pixel_poses, dtype=float).reshape(-1, 3))
+
+    def reuse_image(self, source_index: int, index: int, link: bool = True) -> None:
+        """!
+        @brief Give an image the same contents as an already written one, instead of rendering it.
+
+        A hard link takes no extra space. If the file system can't make one, the image is copied.
+
+        @param source_index The image number to reuse. Its image must already be written.
+        @param index The image number to write.
+        @param link If true, hard link the image. Otherwise, copy it.
+        @return None
+        """
+        source_path = self._namer.create_image_path(source_index, absolute=True)
+        image_path = self._namer.create_image_path(index, absolute=True)
+        os.makedirs(os.path.dirname(image_path), exist_ok=True)
+        # Linking fails if the destination exists, such as from an earlier run.
+        if os.path.lexists(image_path):
+            os.remove(image_path)
+        if link:
+            try:
+                os.link(source_path, image_path)
+                return
+            except OSError:
+                pass
+        shutil.copyfile(source_path, image_path)
+
     def write_camera_intrinsic_matrix(self, camera_intrinsic_matrix: numpy.ndarray) -> None:
         """!
         @brief Write the 3x3 intrinsic matrix to file.
@@ -98,7 +373,47 @@ class DataWriter:
             self._camera_directory, F'{self._camera_name}_pose.txt')
         self._write_array(camera_pose, file_path)
 
-    def write_lists(self, robot_poses: List[List[float]], pixel_poses: List[List[float]]) -> None:
+    def write_coverage_report(self, report: Dict) -> None:
+        """!
+        @brief Write the dry run's overlap and coverage summary to a JSON file in *output*.
+        @param report The summary, such as from @ref CoverageAnalyzer.summary.
+        @return None
+        """
+        file_path = os.path.join(self._output_directory, self._namer.coverage_report_file)
+        with open(file=file_path, mode='w', encoding='utf-8') as file:
+            json.dump(report, fp=file, indent=2)
+
+    def write_coverage_raster(self, raster: numpy.ndarray) -> None:
+        """!
+        @brief Write the dry run's coverage raster to a Numpy file in *output*.
+        @param raster The count of frames that saw each cell, such as
+        @ref CoverageAnalyzer.raster.
+        @return None
+        """
+        numpy.save(os.path.join(self._output_directory, self._namer.coverage_raster_file), raster)
+
+    def write_mosaic_metadata(self, metadata: Dict) -> None:
+        """!
+        @brief Write where the mosaic sits in the global image to a JSON file in *output*.
+        @param metadata The description, such as from @ref MosaicPlanner.metadata.
+        @return None
+        """
+        file_path = os.path.join(self._output_directory, self._namer.mosaic_metadata_file)
+        with open(file=file_path, mode='w', encoding='utf-8') as file:
+            json.dump(metadata, fp=file, indent=2)
+
+    def write_render_settings(self, render_settings: Dict) -> None:
+        """!
+        @brief Write the settings the images were rendered with to a JSON file in *output*.
+        @param render_settings The settings, such as from @ref BlenderInterface.render_settings.
+        @return None
+        """
+        file_path = os.path.join(self._output_directory, self._namer.render_settings_file)
+        with open(file=file_path, mode='w', encoding='utf-8') as file:
+            json.dump(render_settings, fp=file, indent=2)
+
+    def write_lists(self, robot_poses: List[List[float]], pixel_poses: List[List[float]],
+                    robot_transforms: numpy.ndarray = None) -> None:
         """!
         @brief Write all the data points in the provided lists to files names according to the data
         format standard.
@@ -111,12 +426,20 @@ class DataWriter:
         @param pixel_poses A list of poses for the top left corner of the image, relative to a
         global image aligned with the origin. Each element is in the form [x, y, yaw] where X and Y
         are in pixels and yaw is in radians.
+        @param robot_transforms Optionally, the Nx4x4 homogenous matrices already built from
+        robot_poses, such as by @ref create_planar_transform_matrices. If not provided, they are
+        computed here.
         @return None
         @exception ValueError returned if both lists are not identical in length.
         """
         # Ensure each list is the same size, otherwise, the alternating lists will be screwed up.
         if len(robot_poses) != len(pixel_poses):
             raise ValueError('Provided lists must be the same length.')
+        robot_poses = numpy.reshape(robot_poses, (-1, 3))
+        pixel_poses = numpy.reshape(pixel_poses, (-1, 3))
+        if robot_transforms is None:
+            robot_transforms = create_planar_transform_matrices(robot_poses)
+        pixel_transforms = create_planar_transform_matrices(pixel_poses)
         # Derive the list of image paths, making sure a newline will get written.
         image_paths = []
         for i in range(len(robot_poses)):
@@ -128,28 +451,54 @@ class DataWriter:
         with open(file=test_file_path, mode='w', encoding='utf-8') as test_file:
             for image_path in image_paths:
                 test_file.write(image_path)
-        # For the next two, alternate with the appropriate pose. Convert the yaw into a matrix.
+        # For the next two, alternate with the appropriate pose.
         meters_txt_file_path = os.path.join(
             self._output_directory, self._namer.meters_txt_file)
         with open(file=meters_txt_file_path, mode='w', encoding='utf-8') as meters_txt_file:
-            for image_path, robot_pose in zip(image_paths, robot_poses):
+            for image_path, robot_transform in zip(image_paths, robot_transforms):
                 meters_txt_file.write(image_path)
-                # Since there is only a yaw, we can safely extract the upper part of the matrix
-                rotation = create_transform_matrix(
-                    robot_pose[0], robot_pose[1], 0.0, 0.0, 0.0, robot_pose[2])
-                pose_string = F'{rotation[0, 0]:0.6f} {rotation[0, 1]:0.6f} {rotation[0, 3]:0.6f}' \
-                    F' {rotation[1, 0]:0.6f} {rotation[1, 1]:0.6f} {rotation[1, 3]:0.6f} ' \
-                    F'{0:0.6f} {0:0.6f} {1:0.6f}\n'
-                meters_txt_file.write(pose_string)
+                meters_txt_file.write(self._format_planar_transform(robot_transform))
         txt_file_path = os.path.join(
             self._output_directory, self._namer.txt_file)
         with open(file=txt_file_path, mode='w', encoding='utf-8') as txt_file:
-            for image_path, pixel_pose in zip(image_paths, pixel_poses):
+            for image_path, pixel_transform in zip(image_paths, pixel_transforms):
                 txt_file.write(image_path)
-                # Since there is only a yaw, we can safely extract the upper part of the matrix
-                rotation = create_transform_matrix(
-                    pixel_pose[0], pixel_pose[1], 0.0, 0.0, 0.0, pixel_pose[2])
-                pose_string = F'{rotation[0, 0]:0.6f} {rotation[0, 1]:0.6f} {rotation[0, 3]:0.6f}' \
-                    F' {rotation[1, 0]:0.6f} {rotation[1, 1]:0.6f} {rotation[1, 3]:0.6f} ' \
-                    F'{0:0.6f} {0:0.6f} {1:0.6f}\n'
-                txt_file.write(pose_string)
+                txt_file.write(self._format_planar_transform(pixel_transform))
+        if self._pose_records:
+            records_file_path = os.path.join(
+                self._output_directory, self._namer.pose_records_file)
+            with open(file=records_file_path, mode='wb') as records_file:
+                records_file.write(self._create_pose_records(
+                    range(len(robot_poses)), robot_poses, pixel_poses).tobytes())
+
+    def _create_pose_records(self, indices: List[int], robot_poses: numpy.ndarray,
+                             pixel_poses: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Build the rows of a pose records file from the planar poses of each image.
+
+        The poses are copied exactly as given, rather than recovered from their matrices, so no
+        yaw is wrapped and nothing is rounded.
+
+        @param indices The image number of each row.
+        @param robot_poses The Nx3 ground truth robot poses, in the form [x, y, yaw].
+        @param pixel_poses The Nx3 poses of each image's top left corner in the global image, in
+        the form [x, y, yaw].
+        @return An Nx7 Numpy array of little-endian 64 bit floats, laid out as in
+        @ref read_pose_records.
+        """
+        records = numpy.empty((len(indices), POSE_RECORD_SIZE), dtype='<f8')
+        records[:, 0] = indices
+        records[:, 1:4] = robot_poses
+        records[:, 4:7] = pixel_poses
+        return records
+
+    def _format_planar_transform(self, transform: numpy.ndarray) -> str:
+        """!
+        @brief Format a planar pose as the flattened 3x3 homogenous matrix used by the list files.
+        @param transform The 4x4 homogenous matrix of the pose. Since there is only a yaw, we can
+        safely extract the upper part of the matrix.
+        @return The formatted line, including the newline.
+        """
+        return F'{transform[0, 0]:0.6f} {transform[0, 1]:0.6f} {transform[0, 3]:0.6f}' \
+            F' {transform[1, 0]:0.6f} {transform[1, 1]:0.6f} {transform[1, 3]:0.6f} ' \
+            F'{0:0.6f} {0:0.6f} {1:0.6f}\n'
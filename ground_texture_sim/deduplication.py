@@ -0,0 +1,78 @@
+"""!
+@brief This module provides the tools to find poses whose images would be all but identical, so
+only one of each group needs to be rendered.
+"""
+from typing import Dict, List, Tuple
+import numpy
+
+
+def find_duplicates(pixel_poses: List[numpy.ndarray], pixel_tolerance: float,
+                    yaw_tolerance: float) -> numpy.ndarray:
+    """!
+    @brief Match each pose to an earlier pose whose images would be all but identical.
+
+    Two poses match when, for every camera, the top left corners of their images are within the
+    pixel tolerance of each other in the global image, and their yaws are within the yaw tolerance.
+    Since this compares where the images land, it accounts for the camera's pose, height, and
+    intrinsic matrix. Only poses that match nothing earlier are rendered and candidates to match,
+    so every image that is reused was rendered from a pose with a lower index.
+
+    @param pixel_poses For each camera, an Nx3 Numpy array of the X and Y in pixels and the yaw in
+    radians of the top left corner of each pose's image, such as from
+    @ref Transformer.project_image_corners.
+    @param pixel_tolerance The furthest apart, in pixels, the corners of matching images may be.
+    @param yaw_tolerance The most, in radians, the yaws of matching images may differ.
+    @return A 1D Numpy array holding, for each pose, the index of the pose whose image to use. This
+    is the pose's own index if it must be rendered.
+    """
+    result = numpy.arange(pixel_poses[0].shape[0])
+    # Grid cells are the tolerance in size, so any match is in the same or a neighboring cell.
+    cells = numpy.floor(pixel_poses[0][:, 0:2] / pixel_tolerance).astype(numpy.int64)
+    # The rendered poses in each grid cell, keyed by cell.
+    rendered = {}
+    for i, (cell_x, cell_y) in enumerate(cells.tolist()):
+        match = _find_match(pixel_poses, rendered, i, (cell_x, cell_y), pixel_tolerance,
+                            yaw_tolerance)
+        if match is None:
+            rendered.setdefault((cell_x, cell_y), []).append(i)
+        else:
+            result[i] = match
+    return result
+
+
+def _find_match(pixel_poses: List[numpy.ndarray], rendered: Dict[Tuple[int, int], List[int]],
+                index: int, cell: Tuple[int, int], pixel_tolerance: float,
+                yaw_tolerance: float) -> int:
+    """!
+    @brief Search the cells around a pose for a rendered pose that matches it.
+    @param pixel_poses For each camera, the Nx3 pixel poses of every pose.
+    @param rendered The rendered poses in each grid cell, keyed by cell.
+    @param index The index of the pose to match.
+    @param cell The grid cell the pose is in.
+    @param pixel_tolerance The furthest apart, in pixels, the corners of matching images may be.
+    @param yaw_tolerance The most, in radians, the yaws of matching images may differ.
+    @return The index of the first matching pose found, or None if there is none.
+    """
+    for offset_x in [-1, 0, 1]:
+        for offset_y in [-1, 0, 1]:
+            for candidate in rendered.get((cell[0] + offset_x, cell[1] + offset_y), []):
+                if all(_poses_match(camera_pixel_poses[index], camera_pixel_poses[candidate],
+                                    pixel_tolerance, yaw_tolerance)
+                       for camera_pixel_poses in pixel_poses):
+                    return candidate
+    return None
+
+
+def _poses_match(first: numpy.ndarray, second: numpy.ndarray, pixel_tolerance: float,
+                 yaw_tolerance: float) -> bool:
+    """!
+    @brief Check if two pixel poses of the same camera are within tolerance of each other.
+    @param first The X, Y, and yaw of the first pose.
+    @param second The X, Y, and yaw of the second pose.
+    @param pixel_tolerance The furthest apart, in pixels, the corners may be.
+    @param yaw_tolerance The most, in radians, the yaws may differ.
+    @return True if they match.
+    """
+    yaw_difference = numpy.arctan2(numpy.sin(first[2] - second[2]), numpy.cos(first[2] - second[2]))
+    return bool(numpy.hypot(first[0] - second[0], first[1] - second[1]) <= pixel_tolerance and
+                abs(yaw_difference) <= yaw_tolerance)
@@ -0,0 +1,295 @@
+"""!
+@brief This module provides the tools to move image encoding and disk writes off the render thread.
+"""
+import os
+import queue
+import struct
+import threading
+import zlib
+from typing import Callable, List, Tuple
+import numpy
+
+## The 8 bytes every PNG file starts with.
+_PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+## The PNG color type for each number of channels: gray, gray and alpha, RGB, and RGBA.
+_PNG_COLOR_TYPES = {1: 0, 2: 4, 3: 2, 4: 6}
+## The TIFF field types that tags are read from, as a struct format character and byte size.
+_TIFF_FIELD_TYPES = {1: ('B', 1), 3: ('H', 2), 4: ('I', 4)}
+
+
+def _read_png_chunks(data: bytes) -> List[Tuple[bytes, bytes]]:
+    """!
+    @brief Split the contents of a PNG file into its chunks.
+    @param data The raw bytes of the entire file.
+    @return A list of tuples, each holding the 4 byte chunk type and the chunk's data.
+    @exception ValueError raised if the data is not a well formed PNG.
+    """
+    if not data.startswith(_PNG_SIGNATURE):
+        raise ValueError('Data is not a PNG image.')
+    chunks = []
+    position = len(_PNG_SIGNATURE)
+    while position < len(data):
+        if position + 8 > len(data):
+            raise ValueError('PNG image is truncated.')
+        length, chunk_type = struct.unpack('>I4s', data[position:position + 8])
+        chunk_data = data[position + 8:position + 8 + length]
+        if len(chunk_data) != length:
+            raise ValueError('PNG image is truncated.')
+        chunks.append((chunk_type, chunk_data))
+        position += length + 12
+    return chunks
+
+
+def _write_png_chunk(chunk_type: bytes, chunk_data: bytes) -> bytes:
+    """!
+    @brief Format a single PNG chunk, including its length and CRC.
+    @param chunk_type The 4 byte chunk type, such as b'IDAT'.
+    @param chunk_data The contents of the chunk.
+    @return The bytes to write to file.
+    """
+    crc = zlib.crc32(chunk_type + chunk_data) & 0xffffffff
+    return struct.pack('>I', len(chunk_data)) + chunk_type + chunk_data + struct.pack('>I', crc)
+
+
+def downsample_image(pixels: numpy.ndarray, factor: int) -> numpy.ndarray:
+    """!
+    @brief Shrink an image by averaging each square block of pixels.
+
+    Since every block is exactly the factor in size, the camera intrinsic matrix of the result is
+    the original's, with the top two rows divided by the factor.
+
+    @param pixels An HxWxC Numpy array of unsigned integer pixels.
+    @param factor How many pixels wide each block is.
+    @return An (H / factor)x(W / factor)xC Numpy array of the same type.
+    @exception ValueError raised if the image size is not a multiple of the factor.
+    """
+    height, width, channels = pixels.shape
+    if height % factor != 0 or width % factor != 0:
+        raise ValueError(F'A {width}x{height} image can not be evenly shrunk by {factor}.')
+    blocks = pixels.reshape((height // factor, factor, width // factor, factor, channels))
+    return numpy.rint(blocks.mean(axis=(1, 3))).astype(pixels.dtype)
+
+
+def encode_png(pixels: numpy.ndarray, compression_level: int) -> bytes:
+    """!
+    @brief Encode an image as a PNG.
+
+    Every row uses the Paeth filter, which is computed for the whole image at once.
+
+    @param pixels An HxWxC Numpy array of 8 or 16 bit unsigned integer pixels, with 1 to 4
+    channels.
+    @param compression_level The zlib compression level, from 0 (none) to 9 (smallest).
+    @return The bytes of the PNG file.
+    """
+    height, width, channels = pixels.shape
+    sample_size = pixels.dtype.itemsize
+    # PNG stores 16 bit samples big endian. Filters work on bytes, a whole pixel apart.
+    rows = numpy.ascontiguousarray(pixels, dtype=F'>u{sample_size}').view(numpy.uint8).reshape(
+        (height, width * channels * sample_size)).astype(numpy.int16)
+    pixel_size = channels * sample_size
+    left = numpy.zeros_like(rows)
+    left[:, pixel_size:] = rows[:, :-pixel_size]
+    up = numpy.zeros_like(rows)
+    up[1:, :] = rows[:-1, :]
+    up_left = numpy.zeros_like(rows)
+    up_left[1:, pixel_size:] = rows[:-1, :-pixel_size]
+    estimate = left + up - up_left
+    left_distance = numpy.abs(estimate - left)
+    up_distance = numpy.abs(estimate - up)
+    up_left_distance = numpy.abs(estimate - up_left)
+    prediction = numpy.where((left_distance <= up_distance) & (left_distance <= up_left_distance),
+                             left, numpy.where(up_distance <= up_left_distance, up, up_left))
+    filtered = numpy.empty((height, rows.shape[1] + 1), dtype=numpy.uint8)
+    filtered[:, 0] = 4
+    filtered[:, 1:] = (rows - prediction) % 256
+    header = struct.pack('>IIBBBBB', width, height, sample_size * 8, _PNG_COLOR_TYPES[channels], 0,
+                         0, 0)
+    return _PNG_SIGNATURE + _write_png_chunk(b'IHDR', header) + \
+        _write_png_chunk(b'IDAT', zlib.compress(filtered.tobytes(), compression_level)) + \
+        _write_png_chunk(b'IEND', b'')
+
+
+def read_tiff(path: str) -> numpy.ndarray:
+    """!
+    @brief Read an uncompressed TIFF image, as Blender writes with no codec.
+    @param path The path of the file.
+    @return An HxWxC Numpy array of the pixels, top row first, as 8 or 16 bit unsigned integers.
+    @exception ValueError raised if the file is not a TIFF of uncompressed 8 or 16 bit samples,
+    interleaved and stored in strips, or is truncated.
+    """
+    with open(file=path, mode='rb') as tiff_file:
+        data = tiff_file.read()
+    byte_order = {b'II': '<', b'MM': '>'}.get(data[0:2])
+    if byte_order is None or struct.unpack_from(byte_order + 'H', data, 2)[0] != 42:
+        raise ValueError(F'{path} is not a TIFF image.')
+    directory_offset = struct.unpack_from(byte_order + 'I', data, 4)[0]
+    entry_count = struct.unpack_from(byte_order + 'H', data, directory_offset)[0]
+    tags = {}
+    for entry in range(entry_count):
+        position = directory_offset + 2 + entry * 12
+        tag, field_type, count = struct.unpack_from(byte_order + 'HHI', data, position)
+        if field_type not in _TIFF_FIELD_TYPES:
+            continue
+        value_format, size = _TIFF_FIELD_TYPES[field_type]
+        value_position = position + 8
+        if count * size > 4:
+            value_position = struct.unpack_from(byte_order + 'I', data, value_position)[0]
+        tags[tag] = list(struct.unpack_from(F'{byte_order}{count}{value_format}', data,
+                                            value_position))
+    bits = tags.get(258, [1])
+    if tags.get(259, [1])[0] != 1 or tags.get(284, [1])[0] != 1 or bits[0] not in [8, 16] or \
+            any(sample_bits != bits[0] for sample_bits in bits) or 273 not in tags:
+        raise ValueError(F'{path} is not an uncompressed, interleaved 8 or 16 bit TIFF image.')
+    width = tags[256][0]
+    height = tags[257][0]
+    channels = tags.get(277, [1])[0]
+    sample_type = numpy.dtype(F'{byte_order}u{bits[0] // 8}')
+    image_data = b''.join(
+        data[offset:offset + count] for offset, count in zip(tags[273], tags[279]))
+    image_size = width * height * channels * sample_type.itemsize
+    if len(image_data) < image_size:
+        raise ValueError(F'{path} is truncated.')
+    pixels = numpy.frombuffer(image_data[0:image_size], dtype=sample_type).reshape(
+        (height, width, channels)).astype(sample_type.newbyteorder('='))
+    # An orientation of 4 stores the bottom row first.
+    if tags.get(274, [1])[0] == 4:
+        pixels = pixels[::-1]
+    return pixels
+
+
+def write_pyramid(source_path: str, destinations: List[Tuple[str, int]],
+                  compression_level: int) -> None:
+    """!
+    @brief Write an image as PNGs at several resolutions, then remove the original.
+
+    Each PNG is written next to its destination and then renamed, so a destination never holds a
+    partially written image. They are written in the order given, so listing the full resolution
+    image last means it only exists once every smaller one does.
+
+    Zlib, Numpy, and file I/O mostly release Python's global interpreter lock, so this can run on
+    a background thread while the main thread renders the next image.
+
+    @param source_path The uncompressed TIFF to read, as rendered by Blender.
+    @param destinations The path of each PNG to write, and how many times smaller than the source
+    it is, where 1 is the full resolution. The folders must exist.
+    @param compression_level The zlib compression level, from 0 (none) to 9 (smallest).
+    @return None
+    @exception ValueError raised if the source is not an uncompressed TIFF or its size is not a
+    multiple of a factor.
+    """
+    pixels = read_tiff(source_path)
+    for destination_path, factor in destinations:
+        level_pixels = pixels if factor == 1 else downsample_image(pixels, factor)
+        temporary_path = destination_path + '.tmp'
+        with open(file=temporary_path, mode='wb') as destination_file:
+            destination_file.write(encode_png(level_pixels, compression_level))
+        os.replace(temporary_path, destination_path)
+    os.remove(source_path)
+
+
+def recompress_png(source_path: str, destination_path: str, compression_level: int) -> None:
+    """!
+    @brief Rewrite a PNG at a different zlib compression level, then remove the original.
+
+    The pixel data and every other chunk are left untouched, so the image itself is identical. The
+    new file is written next to its destination and then renamed, so the destination never holds a
+    partially written image.
+
+    Both zlib and file I/O release Python's global interpreter lock, so this can run on a
+    background thread while the main thread renders the next image.
+
+    @param source_path The PNG to read. This is typically rendered with no compression.
+    @param destination_path Where to write the recompressed PNG. The folder must exist.
+    @param compression_level The zlib compression level, from 0 (none) to 9 (smallest).
+    @return None
+    @exception ValueError raised if the source is not a well formed PNG.
+    """
+    with open(file=source_path, mode='rb') as source_file:
+        chunks = _read_png_chunks(source_file.read())
+    image_data = b''.join(
+        chunk_data for chunk_type, chunk_data in chunks if chunk_type == b'IDAT')
+    image_data = zlib.compress(zlib.decompress(image_data), compression_level)
+    # All the IDAT chunks are merged into one, placed where the first one was.
+    output = [_PNG_SIGNATURE]
+    image_data_written = False
+    for chunk_type, chunk_data in chunks:
+        if chunk_type != b'IDAT':
+            output.append(_write_png_chunk(chunk_type, chunk_data))
+        elif not image_data_written:
+            output.append(_write_png_chunk(chunk_type, image_data))
+            image_data_written = True
+    temporary_path = destination_path + '.tmp'
+    with open(file=temporary_path, mode='wb') as destination_file:
+        destination_file.write(b''.join(output))
+    os.replace(temporary_path, destination_path)
+    os.remove(source_path)
+
+
+class BackgroundWriter:
+    """!
+    @brief A single background thread that runs submitted jobs in the order they were submitted.
+
+    The queue of waiting jobs is bounded, so a slow disk eventually makes the renderer wait instead
+    of letting finished images pile up in memory or in the staging folder.
+    """
+
+    def __init__(self, queue_size: int = 8) -> None:
+        """!
+        @brief Create the queue and start the thread.
+        @param queue_size The most jobs that can wait at once before @ref submit blocks.
+        """
+        ## The jobs waiting to run. None tells the thread to stop.
+        self._jobs = queue.Queue(maxsize=queue_size)
+        ## The first exception raised by a job, if any.
+        self._error = None
+        ## The thread running the jobs.
+        self._thread = threading.Thread(target=self._run_jobs, daemon=True)
+        self._thread.start()
+
+    def close(self) -> None:
+        """!
+        @brief Wait for every submitted job to finish, then stop the thread.
+        @return None
+        @exception Exception re-raises the first exception raised by any job.
+        """
+        if self._thread.is_alive():
+            self._jobs.put(None)
+            self._thread.join()
+        self._raise_error()
+
+    def submit(self, function: Callable, *args) -> None:
+        """!
+        @brief Queue a job to run on the background thread, blocking if the queue is full.
+        @param function The function to call.
+        @param args The arguments to pass to the function.
+        @return None
+        @exception Exception re-raises the exception of any job that already failed, so the caller
+        stops producing more work.
+        """
+        self._raise_error()
+        self._jobs.put((function, args))
+
+    def _raise_error(self) -> None:
+        """!
+        @brief Raise the first exception a job raised, if there was one.
+        @return None
+        """
+        if self._error is not None:
+            raise self._error
+
+    def _run_jobs(self) -> None:
+        """!
+        @brief Run jobs until told to stop. After a job fails, later jobs are skipped.
+        @return None
+        """
+        while True:
+            job = self._jobs.get()
+            if job is None:
+                return
+            if self._error is not None:
+                continue
+            function, args = job
+            try:
+                function(*args)
+            except Exception as error:  # pylint: disable=broad-except
+                self._error = error
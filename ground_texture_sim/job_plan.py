@@ -0,0 +1,163 @@
+"""!
+@brief This module provides the plan of a range of the trajectory, computed and checked before
+anything is rendered.
+"""
+import json
+import os
+import shutil
+from typing import List, Tuple
+import numpy
+from ground_texture_sim.transforms import Transformer
+
+## How many poses to plan at once. This bounds the memory of the transform math.
+_BLOCK_SIZE = 4096
+## The name of the file describing a plan, in the plan's folder.
+PLAN_FILE = 'plan.json'
+## The longest file name to assume when the file system can't say.
+_DEFAULT_NAME_MAX = 255
+## The longest path to assume when the file system can't say.
+_DEFAULT_PATH_MAX = 4096
+
+
+class JobPlan():
+    """!
+    @brief A class holding the robot pose and each camera's pixel pose of every index in a range of
+    the trajectory, computed up front.
+
+    The poses are computed in vectorized blocks and written straight into memory-mapped Numpy files
+    in the plan's folder, so planning any length of trajectory takes bounded memory, and the plan is
+    saved as it is made. The render loop then only reads slices of it. The folder also holds
+    plan.json, which records the range, the cameras, the file of each array, and the results of
+    @ref validate. The arrays can be read back with `numpy.load(path, mmap_mode='r')`.
+    """
+
+    def __init__(self, folder: str, trajectory, cameras: List[Tuple[str, Transformer]],
+                 start_index: int, end_index: int) -> None:
+        """!
+        @brief Plan every pose in the range, replacing any plan already in the folder.
+        @param folder The folder to save the plan in. It is created if needed.
+        @param trajectory The trajectory, as anything that slices into Nx3 planar X, Y, and yaw
+        poses, such as a list, Numpy array, or trajectory generator.
+        @param cameras The name and transformer of each camera, in order.
+        @param start_index The first trajectory index to plan.
+        @param end_index One past the last trajectory index to plan.
+        """
+        os.makedirs(folder, exist_ok=True)
+        ## The folder the plan is saved in.
+        self.folder = folder
+        ## The first trajectory index of the plan.
+        self.start_index = start_index
+        ## One past the last trajectory index of the plan.
+        self.end_index = end_index
+        ## The name of each camera, in order.
+        self.camera_names = [name for name, _ in cameras]
+        ## The file of each array, relative to the plan's folder.
+        self._files = {'robot_poses': 'robot_poses.npy'}
+        for name in self.camera_names:
+            self._files[name] = F'{name}_pixel_poses.npy'
+        ## An Nx3 array of the planar X, Y, and yaw of the robot at each index of the range.
+        self.robot_poses = self._create_array('robot_poses')
+        ## For each camera, an Nx3 array of the X and Y in pixels and the yaw in radians of the top
+        ## left corner of its image at each index of the range.
+        self.pixel_poses = [self._create_array(name) for name in self.camera_names]
+        for block_start in range(start_index, end_index, _BLOCK_SIZE):
+            block_end = min(block_start + _BLOCK_SIZE, end_index)
+            offsets = slice(block_start - start_index, block_end - start_index)
+            self.robot_poses[offsets] = numpy.reshape(trajectory[block_start:block_end], (-1, 3))
+            for (_, transformer), camera_pixel_poses in zip(cameras, self.pixel_poses):
+                camera_pixel_poses[offsets] = transformer.project_image_corners(
+                    self.robot_poses[offsets])
+        for array in [self.robot_poses] + self.pixel_poses:
+            if isinstance(array, numpy.memmap):
+                array.flush()
+        ## The most bytes the planned images may take, once validated.
+        self.required_bytes = None
+        ## The bytes free where the images go, once validated.
+        self.free_bytes = None
+        self._write_description()
+
+    def __len__(self) -> int:
+        """!
+        @brief Get how many poses are planned.
+        @return The length of the range.
+        """
+        return self.end_index - self.start_index
+
+    def validate(self, output_folder: str, output_paths: List[str], required_bytes: int) -> bool:
+        """!
+        @brief Check that every output can be written, and whether the images should fit on disk.
+
+        Each output's folder is created, and must be writable. Its file name and path must also
+        fit the file system's limits, so checking the longest path of each output, such as the one
+        with the last index, covers them all. Running short of space is only warned about, since
+        images that are compressed take less than the estimate.
+
+        @param output_folder The folder everything is written under.
+        @param output_paths The absolute path of the longest file of each output.
+        @param required_bytes The most bytes the images may take.
+        @return True if the images should fit in the free space.
+        @exception RuntimeError raised if an output can't be written.
+        """
+        for output_path in output_paths:
+            output_directory = os.path.dirname(output_path)
+            try:
+                os.makedirs(output_directory, exist_ok=True)
+            except OSError as ex:
+                raise RuntimeError(F'Can not create the output folder {output_directory}') from ex
+            if not os.access(output_directory, os.W_OK):
+                raise RuntimeError(F'Can not write to the output folder {output_directory}')
+            name_max = _path_limit(output_directory, 'PC_NAME_MAX', _DEFAULT_NAME_MAX)
+            path_max = _path_limit(output_directory, 'PC_PATH_MAX', _DEFAULT_PATH_MAX)
+            if len(os.path.basename(output_path)) > name_max or len(output_path) > path_max:
+                raise RuntimeError(
+                    F'{output_path} is longer than its file system allows. Use a shorter output '
+                    F'folder or camera name.')
+        self.required_bytes = required_bytes
+        self.free_bytes = shutil.disk_usage(output_folder).free
+        self._write_description()
+        return self.required_bytes <= self.free_bytes
+
+    def _create_array(self, name: str) -> numpy.ndarray:
+        """!
+        @brief Create one of the plan's arrays, as a memory-mapped file in the plan's folder.
+        @param name The key of the array's file.
+        @return An Nx3 array of floats, the length of the range.
+        """
+        shape = (len(self), 3)
+        if shape[0] == 0:
+            # An empty file can't be memory-mapped, so an empty plan is only held in memory.
+            return numpy.zeros(shape)
+        return numpy.lib.format.open_memmap(os.path.join(self.folder, self._files[name]), mode='w+',
+                                            dtype=numpy.float64, shape=shape)
+
+    def _write_description(self) -> None:
+        """!
+        @brief Write plan.json, describing the plan.
+        @return None
+        """
+        description = {
+            'start_index': self.start_index,
+            'end_index': self.end_index,
+            'cameras': self.camera_names,
+            'files': self._files,
+            'required_bytes': self.required_bytes,
+            'free_bytes': self.free_bytes
+        }
+        with open(file=os.path.join(self.folder, PLAN_FILE), mode='w',
+                  encoding='utf-8') as plan_file:
+            json.dump(description, fp=plan_file, indent=2)
+
+
+def _path_limit(folder: str, name: str, default: int) -> int:
+    """!
+    @brief Find a limit of the file system a folder is on.
+    @param folder The folder.
+    @param name The name of the limit, as for os.pathconf.
+    @param default The limit to use if the file system can't say.
+    @return The limit.
+    """
+    try:
+        limit = os.pathconf(folder, name)
+    except (AttributeError, OSError, ValueError):
+        return default
+    return default if limit is None or limit < 0 else limit
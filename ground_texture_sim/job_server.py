@@ -0,0 +1,94 @@
+"""!
+@brief This module provides a long-lived mode that runs many jobs in one Blender process.
+"""
+import glob
+import os
+import time
+import traceback
+from ground_texture_sim.blender_interface import restore_scene_state, save_scene_state, \
+    warm_up_renderer
+from ground_texture_sim.script_runner import GroundTextureSim
+
+
+class JobServer:
+    """!
+    @brief A class that runs each configuration JSON dropped into a job directory.
+
+    The scene, its textures, and the compiled render kernels stay loaded between jobs, so only the
+    first job pays for Blender's startup. The scene and Cycles settings each job changes are put
+    back once it finishes, so every job starts from the settings of the .blend file, as if it ran
+    alone.
+
+    Each job is a configuration JSON, in the same format as normal runs, saved in the job directory
+    with a .json extension. Write it somewhere else first and then move it in, so it is never read
+    half written. The server claims a job by renaming it to *.json.running*, then renames it to
+    *.json.done* or *.json.failed* when finished. A failed job also gets a *.json.log* holding the
+    error. Since claiming is a rename, several servers may share one job directory. Create a file
+    called *stop* in the directory to shut the server down once its current job finishes.
+    """
+
+    def __init__(self, job_directory: str, poll_interval: float = 1.0) -> None:
+        """!
+        @brief Create the server, and the job directory if needed.
+        @param job_directory The folder to watch for jobs.
+        @param poll_interval How many seconds to wait between checks of an empty job directory.
+        """
+        ## The folder to watch for jobs.
+        self._job_directory = job_directory
+        ## How many seconds to wait between checks of an empty job directory.
+        self._poll_interval = poll_interval
+        ## The file that tells the server to stop.
+        self._stop_path = os.path.join(job_directory, 'stop')
+        os.makedirs(job_directory, exist_ok=True)
+
+    def run_pending_jobs(self) -> int:
+        """!
+        @brief Run every job currently waiting in the job directory, oldest name first.
+
+        A failed job does not stop the others. Its error is saved next to it instead. No more jobs
+        are started once the stop file exists.
+
+        @return How many jobs this server ran.
+        """
+        job_count = 0
+        for job_path in sorted(glob.glob(os.path.join(self._job_directory, '*.json'))):
+            if os.path.exists(self._stop_path):
+                break
+            running_path = job_path + '.running'
+            try:
+                os.rename(job_path, running_path)
+            except OSError:
+                # Another server claimed it first.
+                continue
+            job_name = os.path.basename(job_path)
+            print(F'Starting job {job_name}')
+            start_time = time.perf_counter()
+            scene_state = save_scene_state()
+            try:
+                GroundTextureSim(['--', running_path]).run()
+            except Exception:  # pylint: disable=broad-except
+                with open(file=job_path + '.log', mode='w', encoding='utf-8') as log_file:
+                    log_file.write(traceback.format_exc())
+                os.replace(running_path, job_path + '.failed')
+                print(F'Job {job_name} failed. See {job_path}.log for details.')
+            else:
+                os.replace(running_path, job_path + '.done')
+                print(F'Finished job {job_name} in {time.perf_counter() - start_time:0.2f}'
+                      F' seconds')
+            finally:
+                restore_scene_state(scene_state)
+            job_count += 1
+        return job_count
+
+    def serve(self) -> None:  # pragma: no cover
+        """!
+        @brief Warm up the renderer, then run jobs as they arrive until told to stop.
+        @return None
+        """
+        warm_up_renderer()
+        print(F'Waiting for jobs in {self._job_directory}')
+        while not os.path.exists(self._stop_path):
+            if self.run_pending_jobs() == 0:
+                time.sleep(self._poll_interval)
+        os.remove(self._stop_path)
+        print('Stopping job server')
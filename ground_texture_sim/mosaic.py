@@ -0,0 +1,312 @@
+"""!
+@brief This module provides the tools to render the whole floor as one tiled global image.
+"""
+import math
+import struct
+import zlib
+from typing import Dict, Tuple
+import numpy
+from ground_texture_sim.transforms import Transformer
+
+## The TIFF field type of 16 bit unsigned integers.
+_TIFF_SHORT = 3
+## The TIFF field type of 32 bit unsigned integers.
+_TIFF_LONG = 4
+## The BigTIFF field type of 64 bit unsigned integers.
+_TIFF_LONG8 = 16
+## The size in bytes of each TIFF field type used here.
+_TIFF_TYPE_SIZES = {_TIFF_SHORT: 2, _TIFF_LONG: 4, _TIFF_LONG8: 8}
+## The struct format character of each TIFF field type used here.
+_TIFF_TYPE_FORMATS = {_TIFF_SHORT: 'H', _TIFF_LONG: 'I', _TIFF_LONG8: 'Q'}
+
+
+def read_bmp(file_path: str) -> numpy.ndarray:
+    """!
+    @brief Read the pixels of an uncompressed 24 or 32 bit BMP image, such as Blender writes.
+    @param file_path The image to read.
+    @return An HxWx3 Numpy array of 8 bit RGB values, with the top row first.
+    @exception ValueError raised if the file is not an uncompressed 24 or 32 bit BMP.
+    """
+    with open(file=file_path, mode='rb') as bmp_file:
+        data = bmp_file.read()
+    if len(data) < 54 or data[0:2] != b'BM':
+        raise ValueError(F'{file_path} is not a BMP image.')
+    pixel_offset = struct.unpack_from('<I', data, 10)[0]
+    width, height, _, bits_per_pixel, compression = struct.unpack_from('<iiHHI', data, 18)
+    # Bit field compression is still uncompressed, just with the channel order spelled out.
+    if bits_per_pixel not in [24, 32] or compression not in [0, 3]:
+        raise ValueError(
+            F'{file_path} must be an uncompressed 24 or 32 bit BMP, not {bits_per_pixel} bit with '
+            F'compression {compression}.')
+    channels = bits_per_pixel // 8
+    # Each row is padded to a multiple of 4 bytes.
+    row_size = (width * channels + 3) // 4 * 4
+    rows = numpy.frombuffer(data, dtype=numpy.uint8, count=row_size * abs(height),
+                            offset=pixel_offset).reshape((abs(height), row_size))
+    pixels = rows[:, 0:width * channels].reshape((abs(height), width, channels))
+    # Rows are stored bottom up unless the height is negative, and channels are stored as BGR.
+    if height > 0:
+        pixels = pixels[::-1]
+    return numpy.ascontiguousarray(pixels[:, :, 2::-1])
+
+
+class TiledTiffWriter:
+    """!
+    @brief A class that writes a BigTIFF image one tile at a time, so it never holds the whole
+    image in memory.
+
+    Tiles may be written in any order. The table of where each tile is stored is written when the
+    file is closed. BigTIFF is used so the image may be larger than 4 GB.
+    """
+
+    def __init__(self, file_path: str, width: int, height: int, tile_size: int,
+                 compress: bool = True) -> None:
+        """!
+        @brief Create the file and write its header.
+        @param file_path Where to write the image. The containing folder must exist.
+        @param width The width of the whole image, in pixels.
+        @param height The height of the whole image, in pixels.
+        @param tile_size The width and height of each tile, in pixels. TIFF requires a multiple of
+        16.
+        @param compress If true, compress each tile with Deflate.
+        @exception ValueError raised if the tile size is not a positive multiple of 16.
+        """
+        if tile_size <= 0 or tile_size % 16 != 0:
+            raise ValueError(F'Tile size must be a positive multiple of 16, not {tile_size}.')
+        ## The width of the whole image, in pixels.
+        self._width = width
+        ## The height of the whole image, in pixels.
+        self._height = height
+        ## The width and height of each tile, in pixels.
+        self._tile_size = tile_size
+        ## Whether to compress each tile.
+        self._compress = compress
+        ## How many tiles across the image is.
+        self.tiles_across = math.ceil(width / tile_size)
+        ## How many tiles down the image is.
+        self.tiles_down = math.ceil(height / tile_size)
+        ## Where each tile's data starts in the file, or None if not yet written.
+        self._tile_offsets = [None] * (self.tiles_across * self.tiles_down)
+        ## How many bytes each tile's data takes.
+        self._tile_byte_counts = [0] * len(self._tile_offsets)
+        # The file stays open until close, so a with block does not fit here.
+        # pylint: disable-next=consider-using-with
+        ## The open image file.
+        self._file = open(file=file_path, mode='wb')
+        # Little endian BigTIFF, with 8 byte offsets. The first directory's offset is set on close.
+        self._file.write(b'II' + struct.pack('<HHHQ', 43, 8, 0, 0))
+
+    def close(self) -> None:
+        """!
+        @brief Write the table of tiles and close the file.
+        @return None
+        @exception RuntimeError raised if any tile was never written.
+        """
+        if self._file.closed:
+            return
+        missing_tiles = [i for i, offset in enumerate(self._tile_offsets) if offset is None]
+        if len(missing_tiles) > 0:
+            self._file.close()
+            raise RuntimeError(F'Tiles {missing_tiles} of the image were never written.')
+        entries = [
+            (256, _TIFF_LONG, [self._width]),
+            (257, _TIFF_LONG, [self._height]),
+            (258, _TIFF_SHORT, [8, 8, 8]),
+            (259, _TIFF_SHORT, [8 if self._compress else 1]),
+            (262, _TIFF_SHORT, [2]),
+            (277, _TIFF_SHORT, [3]),
+            (284, _TIFF_SHORT, [1]),
+            (322, _TIFF_LONG, [self._tile_size]),
+            (323, _TIFF_LONG, [self._tile_size]),
+            (324, _TIFF_LONG8, self._tile_offsets),
+            (325, _TIFF_LONG8, self._tile_byte_counts)
+        ]
+        # Values that do not fit in an entry are written before the directory, which points to them.
+        entry_values = []
+        for _, field_type, values in entries:
+            packed = struct.pack(F'<{len(values)}{_TIFF_TYPE_FORMATS[field_type]}', *values)
+            if len(packed) <= 8:
+                entry_values.append(packed.ljust(8, b'\x00'))
+            else:
+                self._align()
+                entry_values.append(struct.pack('<Q', self._file.tell()))
+                self._file.write(packed)
+        self._align()
+        directory_offset = self._file.tell()
+        self._file.write(struct.pack('<Q', len(entries)))
+        for (tag, field_type, values), value in zip(entries, entry_values):
+            self._file.write(struct.pack('<HHQ', tag, field_type, len(values)) + value)
+        self._file.write(struct.pack('<Q', 0))
+        self._file.seek(8)
+        self._file.write(struct.pack('<Q', directory_offset))
+        self._file.close()
+
+    def write_tile(self, row: int, column: int, pixels: numpy.ndarray) -> None:
+        """!
+        @brief Write one tile of the image.
+        @param row Which row of tiles this is, counting down from the top.
+        @param column Which column of tiles this is, counting from the left.
+        @param pixels An HxWx3 array of 8 bit RGB values, no larger than the tile size. Tiles on
+        the right and bottom edges may be smaller, and are padded with black.
+        @return None
+        @exception ValueError raised if the tile is out of range or the pixels are the wrong shape.
+        """
+        if row < 0 or row >= self.tiles_down or column < 0 or column >= self.tiles_across:
+            raise ValueError(F'Tile ({row}, {column}) is outside of the image.')
+        if pixels.ndim != 3 or pixels.shape[2] != 3 or pixels.shape[0] > self._tile_size or \
+                pixels.shape[1] > self._tile_size:
+            raise ValueError(
+                F'Tile pixels must be at most {self._tile_size}x{self._tile_size}x3, not '
+                F'{pixels.shape}.')
+        tile = numpy.zeros((self._tile_size, self._tile_size, 3), dtype=numpy.uint8)
+        tile[0:pixels.shape[0], 0:pixels.shape[1]] = pixels
+        data = tile.tobytes()
+        if self._compress:
+            data = zlib.compress(data)
+        index = row * self.tiles_across + column
+        self._tile_offsets[index] = self._file.tell()
+        self._tile_byte_counts[index] = len(data)
+        self._file.write(data)
+
+    def _align(self) -> None:
+        """!
+        @brief Pad the file to an even length, since TIFF requires offsets to be word aligned.
+        @return None
+        """
+        if self._file.tell() % 2 == 1:
+            self._file.write(b'\x00')
+
+
+class MosaicPlanner:
+    """!
+    @brief A class that splits part of the floor into tiles of the global image and finds where an
+    orthographic camera must be to render each tile.
+
+    The global image is the one used by @ref Transformer.project_image_corner, so pixel poses in
+    the list files can be looked up directly in the mosaic, after subtracting the mosaic's origin.
+    This requires the camera to face straight down with square pixels, so the global image is an
+    undistorted view of the floor.
+    """
+
+    def __init__(self, transformer: Transformer, x_limits: Tuple[float, float],
+                 y_limits: Tuple[float, float], tile_size: int) -> None:
+        """!
+        @brief Plan the tiles covering a rectangle of the floor.
+        @param transformer The transformer of the camera whose global image to build.
+        @param x_limits The smallest and largest X of the floor to cover, in meters.
+        @param y_limits The smallest and largest Y of the floor to cover, in meters.
+        @param tile_size The width and height of each tile, in pixels.
+        @exception ValueError raised if the camera does not face straight down with square pixels.
+        """
+        ## The width and height of each tile, in pixels.
+        self.tile_size = tile_size
+        ## How far above the floor, in meters, to place the camera.
+        self._height = transformer.camera_pose[2, 3]
+        ## The rotation from the image frame to the camera frame, as used by the transformer.
+        self._image_2_camera = transformer.image_2_camera
+        # The global image is an affine function of points on the floor. Find it, then invert it.
+        origin, u_step, v_step = transformer.project_ground_points(
+            numpy.array([[0.0, 0.0], [1.0, 0.0], [0.0, 1.0]]))
+        world_2_pixel = numpy.column_stack((u_step - origin, v_step - origin))
+        ## The 2x2 matrix from pixel offsets in the global image to X and Y offsets on the floor.
+        self._pixel_2_world = numpy.linalg.inv(world_2_pixel)
+        ## Where pixel (0, 0) of the global image is on the floor.
+        self._pixel_origin_world = -self._pixel_2_world @ origin
+        u_axis, v_axis = self._pixel_2_world[:, 0], self._pixel_2_world[:, 1]
+        ## How many meters of floor each pixel covers.
+        self.meters_per_pixel = float(numpy.linalg.norm(u_axis))
+        dot = numpy.dot(u_axis, v_axis) / self.meters_per_pixel ** 2
+        scale_ratio = numpy.linalg.norm(v_axis) / self.meters_per_pixel
+        # A positive cross product means the image would have to be mirrored to match the floor.
+        cross = u_axis[0] * v_axis[1] - u_axis[1] * v_axis[0]
+        if abs(dot) > 1e-3 or abs(scale_ratio - 1.0) > 1e-3 or cross > 0:
+            raise ValueError(
+                'The mosaic requires a camera facing straight down with square pixels.')
+        # Find the pixels of the global image covering every corner of the rectangle.
+        corners = transformer.project_ground_points(numpy.array([
+            [x_limits[0], y_limits[0]], [x_limits[0], y_limits[1]],
+            [x_limits[1], y_limits[0]], [x_limits[1], y_limits[1]]
+        ]))
+        # Allow for rounding, so an area that exactly fits whole pixels does not gain an extra one.
+        minimum = numpy.floor(corners.min(axis=0) + 1e-6)
+        maximum = numpy.ceil(corners.max(axis=0) - 1e-6)
+        ## The global image pixel at the top left corner of the mosaic.
+        self.pixel_origin = (int(minimum[0]), int(minimum[1]))
+        ## The width of the mosaic, in pixels.
+        self.width = int(maximum[0] - minimum[0])
+        ## The height of the mosaic, in pixels.
+        self.height = int(maximum[1] - minimum[1])
+        ## How many tiles across the mosaic is.
+        self.tiles_across = math.ceil(self.width / tile_size)
+        ## How many tiles down the mosaic is.
+        self.tiles_down = math.ceil(self.height / tile_size)
+
+    @property
+    def orthographic_scale(self) -> float:
+        """!
+        @brief Get how many meters of floor each tile covers across, as Blender's ortho_scale.
+        @return The width of a tile, in meters.
+        """
+        return self.tile_size * self.meters_per_pixel
+
+    @property
+    def tile_count(self) -> int:
+        """!
+        @brief Get how many tiles cover the mosaic.
+        @return The tile count.
+        """
+        return self.tiles_across * self.tiles_down
+
+    def tile_position(self, index: int) -> Tuple[int, int]:
+        """!
+        @brief Find where a tile sits in the mosaic. Tiles are numbered across each row in turn.
+        @param index The number of the tile.
+        @return The row and column of the tile.
+        """
+        return index // self.tiles_across, index % self.tiles_across
+
+    def tile_shape(self, index: int) -> Tuple[int, int]:
+        """!
+        @brief Find how much of a tile is inside the mosaic. Tiles on the right and bottom edges may
+        hang over.
+        @param index The number of the tile.
+        @return The height and width of the part of the tile inside the mosaic, in pixels.
+        """
+        row, column = self.tile_position(index)
+        return (min(self.tile_size, self.height - row * self.tile_size),
+                min(self.tile_size, self.width - column * self.tile_size))
+
+    def tile_camera_pose(self, index: int) -> numpy.ndarray:
+        """!
+        @brief Find the pose of an orthographic camera that renders exactly one tile.
+        @param index The number of the tile.
+        @return The 4x4 homogenous pose of the camera, measured from the world frame, in the same
+        conventions as @ref Transformer.transform_camera_to_world.
+        """
+        row, column = self.tile_position(index)
+        center_pixel = numpy.array([
+            self.pixel_origin[0] + (column + 0.5) * self.tile_size,
+            self.pixel_origin[1] + (row + 0.5) * self.tile_size
+        ])
+        center_world = self._pixel_origin_world + self._pixel_2_world @ center_pixel
+        # The image axes follow the global image's pixel axes, and look down into the floor.
+        image_pose = numpy.identity(4)
+        image_pose[0:2, 0] = self._pixel_2_world[:, 0] / self.meters_per_pixel
+        image_pose[0:2, 1] = self._pixel_2_world[:, 1] / self.meters_per_pixel
+        image_pose[0:3, 2] = numpy.cross(image_pose[0:3, 0], image_pose[0:3, 1])
+        image_pose[0:3, 3] = [center_world[0], center_world[1], self._height]
+        return image_pose @ self._image_2_camera.transpose()
+
+    def metadata(self) -> Dict:
+        """!
+        @brief Describe how the mosaic lines up with the global image and the floor.
+        @return A dictionary suitable for saving as JSON.
+        """
+        return {
+            'pixel_origin': list(self.pixel_origin),
+            'width': self.width,
+            'height': self.height,
+            'tile_size': self.tile_size,
+            'meters_per_pixel': self.meters_per_pixel
+        }
+
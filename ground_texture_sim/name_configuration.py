@@ -4,6 +4,14 @@
 import datetime
 from os import path
 
+## The file extension of each image format Blender can be told to write.
+IMAGE_EXTENSIONS = {
+    'PNG': 'png',
+    'WEBP': 'webp',
+    'TIFF': 'tif',
+    'OPEN_EXR': 'exr'
+}
+
 
 class NameConfigurator:
     """!
@@ -11,7 +19,8 @@ class NameConfigurator:
     """
 
     def __init__(self, output_folder: str, sequence_type: str, sequence_number: int,
-                 texture_number: int, camera_name: str) -> None:
+                 texture_number: int, camera_name: str, image_extension: str = 'png',
+                 separate_lists: bool = False, collection_date: datetime.date = None) -> None:
         """!
         @brief Construct the class with given sequence and texture information.
         @param output_folder The root output folder under which all data resides.
@@ -20,11 +29,17 @@ class NameConfigurator:
         this particular data collection event.
         @param texture_number An integer representing the texture type mapped.
         @param camera_name The name of the camera in Blender.
+        @param image_extension The file extension of the images, without the leading period.
+        @param separate_lists If true, the camera name is added to the list, checkpoint, and partial
+        result files, so several cameras can write to the same output folder.
+        @param collection_date The date the sequence was collected on. Every process of a run must
+        give the same one, such as from @ref pin_collection_date. If None, today is used.
         """
         ## The absolute path of the folder containing all data.
         self._output_folder = path.abspath(output_folder)
-        ## The current date data is collected
-        self._current_date = datetime.date.today()
+        ## The date the data is collected on.
+        self._current_date = collection_date if collection_date is not None else \
+            datetime.date.today()
         ## A string description of which type of data collection run this is.
         self._sequence_type = sequence_type
         ## A unique number, relative to the date and sequence type, to identify this event.
@@ -33,8 +48,14 @@ class NameConfigurator:
         self._texture_number = texture_number
         ## The name of the camera in Blender.
         self._camera_name = camera_name
-        ## The base name of the three top-level files listing images and poses.
+        ## The file extension of the images, without the leading period.
+        self._image_extension = image_extension
+        ## The base name of files describing the whole run.
         self._base_name = F'{self._sequence_type}_{self._current_date.strftime("%y%m%d")}'
+        ## The base name of the three top-level files listing images and poses.
+        self._list_name = self._base_name
+        if separate_lists:
+            self._list_name = F'{self._base_name}_{self._camera_name}'
 
     def create_image_path(self, index: int, absolute: bool = False) -> str:
         """!
@@ -44,7 +65,7 @@ class NameConfigurator:
         ```
         sequence_type/date_collected/sequence_number/
         HDG$VersionNumber_t$TextureNumber_$SequenceType_
-        $DateOfRecording_s$SequenceNumber_c01_i$ImageNumber.png
+        $DateOfRecording_s$SequenceNumber_c01_i$ImageNumber.$Extension
         ```
 
         @param index The image number to use
@@ -63,20 +84,190 @@ class NameConfigurator:
         sequence_number_name = F's{self._sequence_number:04d}'
         image_name = F'i{index:07d}'
         file_name = F'HDG2_{texture_name}_{self._sequence_type}_{date_name}' \
-            F'_{sequence_number_name}_{self._camera_name}_{image_name}.png'
+            F'_{sequence_number_name}_{self._camera_name}_{image_name}.{self._image_extension}'
         result = path.join(file_directory, file_name)
         # Make absolute or relative, depending on the specification
         if absolute:
             result = path.join(self._output_folder, result)
         return result
 
+    def partial_file(self, start_index: int, end_index: int) -> str:
+        """!
+        @brief Return the relative path of the file holding one worker's results.
+
+        These files hold the pixel poses for a contiguous range of the trajectory so they can be
+        merged into the main lists once every worker finishes.
+
+        @param start_index The first trajectory index covered by the file.
+        @param end_index One past the last trajectory index covered by the file.
+        @return The path for that file, relative to *output*.
+        """
+        return path.join('partial_results',
+                         F'{self._list_name}_i{start_index:07d}_i{end_index:07d}.npy')
+
+    @property
+    def mosaic_file(self) -> str:
+        """!
+        @brief Return the path of the tiled global image of the floor, relative to *output*.
+        @return The relative path for that file.
+        """
+        return F'{self._base_name}_mosaic.tif'
+
+    @property
+    def mosaic_metadata_file(self) -> str:
+        """!
+        @brief Return the path of the file describing where the mosaic sits in the global image,
+        relative to *output*.
+        @return The relative path for that file.
+        """
+        return F'{self._base_name}_mosaic.json'
+
+    def mosaic_tile_file(self, index: int) -> str:
+        """!
+        @brief Return the path of one rendered tile of the mosaic, before it is added to the mosaic.
+        @param index The number of the tile.
+        @return The path for that file, relative to *output*.
+        """
+        return path.join('mosaic_tiles', F'{self._base_name}_t{index:07d}.bmp')
+
+    @property
+    def coverage_report_file(self) -> str:
+        """!
+        @brief Return the path of the dry run's overlap and coverage summary, relative to *output*.
+        @return The relative path for that file.
+        """
+        return F'{self._list_name}_coverage.json'
+
+    @property
+    def coverage_raster_file(self) -> str:
+        """!
+        @brief Return the path of the dry run's coverage raster, relative to *output*.
+        @return The relative path for that file.
+        """
+        return F'{self._list_name}_coverage.npy'
+
+    @property
+    def partial_file_pattern(self) -> str:
+        """!
+        @brief Return a glob pattern matching every file made by @ref partial_file.
+        @return The pattern, relative to *output*.
+        """
+        return path.join('partial_results', F'{self._list_name}_i*_i*.npy')
+
+    def checkpoint_file(self, start_index: int, end_index: int) -> str:
+        """!
+        @brief Return the path of the manifest listing the finished images of one range.
+
+        Each range has its own manifest, so workers and nodes never append to the same file.
+
+        @param start_index The first trajectory index of the range.
+        @param end_index One past the last trajectory index of the range.
+        @return The path for that file, relative to *output*.
+        """
+        return F'{self._list_name}_i{start_index:07d}_i{end_index:07d}.checkpoint'
+
+    @property
+    def checkpoint_file_pattern(self) -> str:
+        """!
+        @brief Return a glob pattern matching every file made by @ref checkpoint_file.
+        @return The pattern, relative to *output*.
+        """
+        return F'{self._list_name}_i*_i*.checkpoint'
+
     @property
     def meters_txt_file(self) -> None:
         """!
         @brief Return the absolute path of the *_meters.txt file.
         @return The absolute path for that file.
         """
-        return F'{self._base_name}_meters.txt'
+        return F'{self._list_name}_meters.txt'
+
+    @property
+    def pose_records_file(self) -> str:
+        """!
+        @brief Return the path of the binary companion of the list files, relative to *output*.
+        @return The relative path for that file.
+        """
+        return F'{self._list_name}_poses.bin'
+
+    @property
+    def render_settings_file(self) -> str:
+        """!
+        @brief Return the path of the file recording the run's render settings, relative to
+        *output*.
+        @return The relative path for that file.
+        """
+        return F'{self._base_name}_render_settings.json'
+
+    def timing_file(self, start_index: int = None, end_index: int = None) -> str:
+        """!
+        @brief Return the path of the timing report, relative to *output*.
+        @param start_index For a worker, the first trajectory index it rendered. Leave as None for
+        the report of the whole run.
+        @param end_index For a worker, one past the last trajectory index it rendered.
+        @return The relative path for that file.
+        """
+        if start_index is None:
+            return F'{self._base_name}_timing.json'
+        return F'{self._base_name}_timing_i{start_index:07d}_i{end_index:07d}.json'
+
+    def plan_folder(self, start_index: int = None, end_index: int = None) -> str:
+        """!
+        @brief Return the path of the folder holding a job plan, relative to *output*.
+        @param start_index For a range, the first trajectory index it plans. Leave as None for the
+        plan of the whole run.
+        @param end_index For a range, one past the last trajectory index it plans.
+        @return The relative path for that folder.
+        """
+        if start_index is None:
+            return path.join('plan', self._base_name)
+        return path.join('plan', F'{self._base_name}_i{start_index:07d}_i{end_index:07d}')
+
+    def status_file(self, start_index: int = None, end_index: int = None) -> str:
+        """!
+        @brief Return the path of the status file, relative to *output*.
+        @param start_index For a worker, the first trajectory index it renders. Leave as None for
+        the status of the whole run.
+        @param end_index For a worker, one past the last trajectory index it renders.
+        @return The relative path for that file.
+        """
+        if start_index is None:
+            return F'{self._base_name}_status.json'
+        return F'{self._base_name}_status_i{start_index:07d}_i{end_index:07d}.json'
+
+    def shard_file(self, start_index: int, shard_number: int) -> str:
+        """!
+        @brief Return the relative path of one tar shard of packed images.
+        @param start_index The first trajectory index of the range whose images the shard holds,
+        so workers rendering different ranges never share a shard.
+        @param shard_number The number of the shard within that range.
+        @return The path for that file, relative to *output*.
+        """
+        return path.join('shards', F'{self._list_name}_i{start_index:07d}_s{shard_number:05d}.tar')
+
+    @property
+    def shard_index_file(self) -> str:
+        """!
+        @brief Return the path of the index of every image packed into shards, relative to *output*.
+        @return The relative path for that file.
+        """
+        return F'{self._list_name}_shards.txt'
+
+    def shard_index_part_file(self, start_index: int) -> str:
+        """!
+        @brief Return the relative path of the index of the shards of one range of the trajectory.
+        @param start_index The first trajectory index of the range.
+        @return The path for that file, relative to *output*.
+        """
+        return path.join('shards', F'{self._list_name}_i{start_index:07d}.idx')
+
+    @property
+    def shard_index_part_pattern(self) -> str:
+        """!
+        @brief Return a glob pattern matching the index of every range's shards.
+        @return The pattern, relative to *output*.
+        """
+        return path.join('shards', F'{self._list_name}_i*.idx')
 
     @property
     def test_file(self) -> None:
@@ -84,7 +275,7 @@ class NameConfigurator:
         @brief Return the absolute path of the *.test file.
         @return The absolute path for that file.
         """
-        return F'{self._base_name}.test'
+        return F'{self._list_name}.test'
 
     @property
     def txt_file(self) -> None:
@@ -92,4 +283,4 @@ class NameConfigurator:
         @brief Return the absolute path of the *.txt file.
         @return The absolute path for that file.
         """
-        return F'{self._base_name}.txt'
+        return F'{self._list_name}.txt'
@@ -0,0 +1,246 @@
+"""!
+@brief This module provides a stand-in for the Blender interface that previews images from the floor
+texture instead of rendering them.
+"""
+from os import path
+import re
+from typing import Dict, List
+import bpy
+import numpy
+from ground_texture_sim.blender_interface import BlenderInterface
+from ground_texture_sim.image_pipeline import encode_png
+from ground_texture_sim.transforms import Transformer
+
+
+class PreviewInterface(BlenderInterface):
+    """!
+    @brief A Blender interface that makes each image by looking up the floor's texture.
+
+    Each pixel's ray, from the same camera pose and intrinsic matrix as a real render, is
+    intersected with the floor, and the floor's diffuse texture is sampled with bilinear filtering
+    where it lands. There is no lighting, shading, or relief, so this is only meant for checking
+    trajectories and camera settings, but every image is one vectorized Numpy pass. Everything else,
+    such as the intrinsic matrix and scene settings, still comes from Blender, so a configuration
+    can be previewed and then rendered for real without changes.
+
+    The floor is taken to be the ground object's bounding box at a height of 0, with the texture
+    stretched over it once, as in the example environment. Pixels that miss the floor are black.
+    """
+
+    def __init__(self, camera_name: str = 'Camera', ground_name: str = 'Ground',
+                 texture_path: str = None) -> None:
+        """!
+        @brief Create the interface. The texture is loaded when the first image is previewed.
+        @param camera_name The name of the camera in the target Blender environment. Defaults to
+        "Camera".
+        @param ground_name The name of the object in Blender the texture covers.
+        @param texture_path The image to use as the floor texture. If None, the diffuse texture of
+        the ground's material is used.
+        """
+        super().__init__(camera_name)
+        ## The name of the object in Blender the texture covers.
+        self._ground_name = ground_name
+        ## The image to use as the floor texture, or None for the ground's own.
+        self._texture_path = texture_path
+        ## The texture as an HxWx3 Numpy array of floats from 0 to 1, bottom row first, once loaded.
+        self._texture = None
+        ## The smallest and largest X, then Y, of the floor in meters, once loaded.
+        self._ground_limits = None
+        ## The direction through the center of each pixel, as an Nx3 array in the camera frame, for
+        ## the resolution it was computed at.
+        self._pixel_rays = None
+        ## The resolution the pixel rays were computed at.
+        self._ray_resolution = None
+        ## The 4x4 homogenous pose of the camera in the world frame, once placed.
+        self._camera_pose = None
+
+    @property
+    def render_settings(self) -> Dict:
+        """!
+        @brief Get the settings that affect the images, noting that they are previews.
+        @return A dictionary of the settings, suitable for saving as JSON.
+        """
+        settings = super().render_settings
+        settings['backend'] = 'preview'
+        return settings
+
+    def clear_motion(self) -> None:
+        """!
+        @brief Do nothing, since previews never keyframe the camera.
+        @return None
+        """
+
+    def place_camera(self, camera_pose: numpy.ndarray) -> None:
+        """!
+        @brief Set the pose to preview the next image from. The camera in Blender is not moved.
+        @param camera_pose The 4x4 homogenous matrix representing the pose of the camera in the
+        world frame.
+        @return None
+        """
+        self._camera_pose = numpy.array(camera_pose, dtype=float)
+
+    def place_moving_camera(self, previous_pose: numpy.ndarray, camera_pose: numpy.ndarray,
+                            next_pose: numpy.ndarray) -> None:
+        """!
+        @brief Set the pose to preview the next image from. Previews are never blurred, so only the
+        middle pose is used.
+        @param previous_pose The 4x4 homogenous pose of the camera one frame earlier. Unused.
+        @param camera_pose The 4x4 homogenous pose of the camera in the world frame.
+        @param next_pose The 4x4 homogenous pose of the camera one frame later. Unused.
+        @return None
+        """
+        self.place_camera(camera_pose)
+
+    def preview_image(self) -> numpy.ndarray:
+        """!
+        @brief Make the image seen from the camera's current pose.
+        @return An HxWx3 Numpy array of the pixels, top row first, as 8 bit unsigned integers, or 16
+        bit if the scene writes 16 bit images.
+        @exception RuntimeError raised if the camera was never placed, or the ground or its texture
+        can't be found.
+        """
+        if self._camera_pose is None:
+            raise RuntimeError('The camera must be placed before previewing an image.')
+        if self._texture is None:
+            self._load_floor()
+        resolution_x, resolution_y, percentage = self.render_resolution
+        width = resolution_x * percentage // 100
+        height = resolution_y * percentage // 100
+        if self._ray_resolution != (width, height):
+            self._compute_pixel_rays(width, height)
+        # Intersect each pixel's ray with the floor.
+        directions = self._pixel_rays @ self._camera_pose[0:3, 0:3].transpose()
+        origin = self._camera_pose[0:3, 3]
+        with numpy.errstate(divide='ignore', invalid='ignore'):
+            distances = -origin[2] / directions[:, 2]
+        hits = numpy.isfinite(distances) & (distances > 0.0)
+        distances = numpy.where(hits, distances, 0.0)
+        points = origin[0:2] + distances[:, numpy.newaxis] * directions[:, 0:2]
+        # Find where each point is in the texture, in pixels, and blend its four neighbors.
+        x_min, x_max, y_min, y_max = self._ground_limits
+        texture_height, texture_width = self._texture.shape[0:2]
+        columns = (points[:, 0] - x_min) / (x_max - x_min) * texture_width - 0.5
+        rows = (points[:, 1] - y_min) / (y_max - y_min) * texture_height - 0.5
+        hits &= (columns >= -0.5) & (columns <= texture_width - 0.5) & (rows >= -0.5) & \
+            (rows <= texture_height - 0.5)
+        column_starts = numpy.floor(columns)
+        row_starts = numpy.floor(rows)
+        column_weights = (columns - column_starts)[:, numpy.newaxis]
+        row_weights = (rows - row_starts)[:, numpy.newaxis]
+        column_starts = column_starts.astype(numpy.int64)
+        row_starts = row_starts.astype(numpy.int64)
+        left = numpy.clip(column_starts, 0, texture_width - 1)
+        right = numpy.clip(column_starts + 1, 0, texture_width - 1)
+        bottom = numpy.clip(row_starts, 0, texture_height - 1)
+        top = numpy.clip(row_starts + 1, 0, texture_height - 1)
+        colors = (self._texture[bottom, left] * (1.0 - column_weights) +
+                  self._texture[bottom, right] * column_weights) * (1.0 - row_weights) + \
+            (self._texture[top, left] * (1.0 - column_weights) +
+             self._texture[top, right] * column_weights) * row_weights
+        colors[~hits] = 0.0
+        dtype = numpy.uint16 if \
+            bpy.context.scene.render.image_settings.color_depth == '16' else numpy.uint8
+        pixels = numpy.rint(numpy.clip(colors, 0.0, 1.0) * numpy.iinfo(dtype).max).astype(dtype)
+        return pixels.reshape((height, width, 3))
+
+    def render_animation(self, frame_path: str, camera_poses: numpy.ndarray) -> List[str]:
+        """!
+        @brief Preview one image from each of several camera poses.
+        @param frame_path An absolute path for the frames, where a run of '#' characters is replaced
+        by the frame number, starting from 1.
+        @param camera_poses An Nx4x4 Numpy array of the homogenous pose of the camera in the world
+        frame for each image.
+        @return The absolute path of each image, in the order of the poses.
+        @exception ValueError raised if the provided path is not absolute.
+        """
+        if not path.isabs(frame_path):
+            raise ValueError(
+                F'Frame path must be absolute. Received: {frame_path}')
+        # Blender adds the extension when writing frames, so do the same.
+        frame_number = re.search('#+', frame_path)
+        result = []
+        for frame, camera_pose in enumerate(camera_poses, 1):
+            image_path = frame_path
+            if frame_number is not None:
+                image_path = frame_path[:frame_number.start()] + \
+                    str(frame).zfill(frame_number.end() - frame_number.start()) + \
+                    frame_path[frame_number.end():]
+            image_path += '.png'
+            self.place_camera(camera_pose)
+            self.render_image(image_path)
+            result.append(image_path)
+        return result
+
+    def render_image(self, image_path: str) -> None:
+        """!
+        @brief Preview an image from wherever the camera currently is and save it as a PNG, at the
+        scene's PNG compression level.
+        @param image_path An absolute path to where the image should go.
+        @return None
+        @exception ValueError raised if the provided path is not absolute.
+        """
+        if not path.isabs(image_path):
+            raise ValueError(
+                F'Image path must be absolute. Received: {image_path}')
+        data = encode_png(self.preview_image(), self.png_compression_level)
+        with open(file=image_path, mode='wb') as image_file:
+            image_file.write(data)
+
+    def _compute_pixel_rays(self, width: int, height: int) -> None:
+        """!
+        @brief Find the direction through the center of each pixel, in the camera frame.
+        @param width The width of the images, in pixels.
+        @param height The height of the images, in pixels.
+        @return None
+        """
+        pixel_x, pixel_y = numpy.meshgrid(numpy.arange(width) + 0.5, numpy.arange(height) + 0.5)
+        pixels = numpy.column_stack((pixel_x.ravel(), pixel_y.ravel(), numpy.ones(width * height)))
+        rays_image = pixels @ numpy.linalg.inv(self.camera_intrinsic_matrix).transpose()
+        image_2_camera = Transformer(numpy.identity(4), numpy.identity(3)).image_2_camera
+        self._pixel_rays = rays_image @ image_2_camera[0:3, 0:3].transpose()
+        self._ray_resolution = (width, height)
+
+    def _load_floor(self) -> None:
+        """!
+        @brief Load the floor texture and find the area of the floor it covers.
+        @return None
+        @exception RuntimeError raised if the ground or its texture can't be found.
+        """
+        if self._ground_name not in bpy.data.objects.keys():
+            raise RuntimeError(F'There is no {self._ground_name} object to preview the floor of.')
+        ground = bpy.data.objects[self._ground_name]
+        corners = numpy.column_stack((numpy.array([list(corner) for corner in ground.bound_box]),
+                                      numpy.ones(8)))
+        corners = corners @ numpy.array(ground.matrix_world).transpose()
+        self._ground_limits = (corners[:, 0].min(), corners[:, 0].max(),
+                               corners[:, 1].min(), corners[:, 1].max())
+        if self._texture_path is not None:
+            image = bpy.data.images.load(self._texture_path, check_existing=True)
+        else:
+            image = self._find_ground_texture(ground)
+        width, height = image.size
+        buffer = numpy.empty(width * height * image.channels, dtype=numpy.float32)
+        image.pixels.foreach_get(buffer)
+        buffer = buffer.reshape((height, width, image.channels))
+        if image.channels < 3:
+            buffer = numpy.repeat(buffer[..., 0:1], 3, axis=2)
+        self._texture = buffer[..., 0:3]
+
+    def _find_ground_texture(self, ground) -> 'bpy.types.Image':
+        """!
+        @brief Find the diffuse texture in the ground's material.
+        @param ground The ground object in Blender.
+        @return The image of the texture node named, labelled, or holding an image named for
+        "diffuse", or of the only texture node if there is just one.
+        @exception RuntimeError raised if there is no such texture.
+        """
+        material = ground.active_material
+        nodes = [] if material is None or material.node_tree is None else material.node_tree.nodes
+        images = [node for node in nodes if node.type == 'TEX_IMAGE' and node.image is not None]
+        for node in images:
+            if 'diffuse' in F'{node.name} {node.label} {node.image.name}'.lower():
+                return node.image
+        if len(images) == 1:
+            return images[0].image
+        raise RuntimeError(
+            F'No diffuse texture found on {self._ground_name}. Set preview/texture instead.')
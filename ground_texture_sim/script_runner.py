@@ -1,8 +1,92 @@
 """!
 @brief The module containing the primary script execution class.
 """
-from typing import List
+import datetime
+import os
+import subprocess
+import tempfile
+import time
+from typing import Callable, Dict, List
+import numpy
 import ground_texture_sim
+from ground_texture_sim.coverage import CoverageAnalyzer
+from ground_texture_sim.deduplication import find_duplicates
+from ground_texture_sim.image_pipeline import BackgroundWriter, recompress_png, write_pyramid
+from ground_texture_sim.job_plan import JobPlan
+from ground_texture_sim.mosaic import MosaicPlanner, TiledTiffWriter, read_bmp
+from ground_texture_sim.preview_interface import PreviewInterface
+from ground_texture_sim.shard_writer import ShardWriter, write_shard_index
+from ground_texture_sim.status import LATENCY_BUCKETS, StatusReporter
+from ground_texture_sim.texture_cache import cache_textures
+from ground_texture_sim.timing import StageTimer, format_progress
+
+## How many poses to do the transform math for at once. This bounds memory on long trajectories.
+_CHUNK_SIZE = 1024
+## The bytes of each image sample at each color depth. Anything else is 8 bits.
+_SAMPLE_BYTES = {'16': 2, '32': 4}
+## The name of the orthographic camera added to the scene to render the mosaic.
+_MOSAIC_CAMERA = 'GroundTextureSimMosaic'
+
+
+class _CameraOutput():
+    """!
+    @brief Everything needed to render and record the data of one configured camera.
+    """
+
+    def __init__(self, configs: Dict, camera_configs: Dict, separate_lists: bool,
+                 downsample_factor: int = 1) -> None:
+        """!
+        @brief Create the Blender interface, transformer, namer, and writer for a camera.
+        @param configs The properly formatted configuration dictionary.
+        @param camera_configs The entry of the configuration's camera list for this camera.
+        @param separate_lists If true, this camera writes its own list files, named after it.
+        @param downsample_factor How many times smaller than the render this camera's images are.
+        Above 1, the intrinsic matrix is scaled to match and everything is written to its own output
+        tree, named after the output folder and the factor.
+        """
+        image_extension = ground_texture_sim.name_configuration.IMAGE_EXTENSIONS[
+            configs['image']['format']]
+        output_folder = configs['output']
+        if downsample_factor > 1:
+            output_folder = F'{os.path.normpath(output_folder)}_downsample{downsample_factor}'
+        ## How many times smaller than the render this camera's images are.
+        self.downsample_factor = downsample_factor
+        ## The name of the camera in Blender.
+        self.name = camera_configs['name']
+        ## The root folder this camera's data is written under.
+        self.output_folder = output_folder
+        ## While rendering into shards, the writer packing this camera's images, or None.
+        self.shard_writer = None
+        ## The camera pose as specified by the configuration details.
+        self.pose = ground_texture_sim.transforms.create_transform_matrix(
+            camera_configs['x'], camera_configs['y'], camera_configs['z'],
+            camera_configs['roll'], camera_configs['pitch'], camera_configs['yaw']
+        )
+        ## The interface with blender for this camera. Previews look up the floor texture instead.
+        self.blender_interface = ground_texture_sim.blender_interface.BlenderInterface(self.name) \
+            if configs['render']['backend'] == 'blender' else PreviewInterface(
+                self.name, configs['preview']['ground'], configs['preview']['texture'])
+        # Averaging blocks of pixels scales the focal lengths and principal point alike.
+        camera_intrinsic_matrix = self.blender_interface.camera_intrinsic_matrix
+        camera_intrinsic_matrix[0:2, :] /= downsample_factor
+        ## A class to help with transform math.
+        self.transformer = ground_texture_sim.transforms.Transformer(
+            self.pose, camera_intrinsic_matrix)
+        # Every process of the run names its files from the same, pinned date.
+        collection_date = datetime.date.fromisoformat(configs['sequence']['date'])
+        ## A class to help with naming things
+        self.namer = ground_texture_sim.name_configuration.NameConfigurator(
+            output_folder, configs['sequence']['sequence_type'],
+            configs['sequence']['sequence_number'], configs['sequence']['texture_number'],
+            self.name, image_extension, separate_lists, collection_date
+        )
+        ## A class to write things to file
+        self.writer = ground_texture_sim.data_writer.DataWriter(
+            output_folder, configs['sequence']['sequence_type'],
+            configs['sequence']['sequence_number'], configs['sequence']['texture_number'],
+            self.name, configs['lists']['flush_interval'], image_extension, separate_lists,
+            configs['lists']['pose_records'], collection_date
+        )
 
 
 class GroundTextureSim():
@@ -18,6 +102,8 @@ class GroundTextureSim():
         @param args The command line arguments specified by the user. Generally, this is the result
         of sys.argv
         """
+        ## The arguments meant for this script, i.e. everything after Blender's '--'.
+        self._script_args = args[args.index('--') + 1:] if '--' in args else []
         # Parse the command line arguments
         configs, trajectory = ground_texture_sim.configuration_loader.load_configuration(
             args_list=args)
@@ -25,53 +111,903 @@ class GroundTextureSim():
         self._configs = configs
         ## The list of trajectories.
         self._trajectory = trajectory
-        ## The camera pose as specified by the configuration details.
-        self._camera_pose = ground_texture_sim.transforms.create_transform_matrix(
-            configs['camera']['x'], configs['camera']['y'], configs['camera']['z'],
-            configs['camera']['roll'], configs['camera']['pitch'], configs['camera']['yaw']
-        )
-        # Create any needed classes
-        ## The interface with blender for the given camera.
-        self._blender_interface = ground_texture_sim.blender_interface.BlenderInterface(
-            configs['camera']['name'])
-        ## A class to help with transform math.
-        self._transformer = ground_texture_sim.transforms.Transformer(
-            self._camera_pose, self._blender_interface.camera_intrinsic_matrix)
-        ## A class to help with naming things
-        self._namer = ground_texture_sim.name_configuration.NameConfigurator(
-            configs['output'], configs['sequence']['sequence_type'],
-            configs['sequence']['sequence_number'], configs['sequence']['texture_number'],
-            configs['camera']['name']
-        )
-        ## A class to write things to file
-        self._writer = ground_texture_sim.data_writer.DataWriter(
-            configs['output'], configs['sequence']['sequence_type'],
-            configs['sequence']['sequence_number'], configs['sequence']['texture_number'],
-            configs['camera']['name']
-        )
+        ## Records how long each stage takes, if timing or the status is enabled. Only the timing
+        ## report's percentiles need every duration, and only the status needs histograms.
+        self._timer = StageTimer(
+            configs['execution']['timing'] or configs['status']['interval'] is not None,
+            configs['execution']['timing'],
+            LATENCY_BUCKETS if configs['status']['interval'] is not None else None)
+        ## Reports the progress of the images being made. It is only enabled while they are.
+        self._status = StatusReporter('', 0)
+        ## How many images this process actually rendered, as opposed to skipped.
+        self._rendered_images = 0
+        # Create any needed classes. With several cameras, each gets its own list files.
+        ## The interface, transformer, namer, and writer of each configured camera, in order.
+        self._cameras = [
+            _CameraOutput(configs, camera_configs, len(configs['camera']) > 1)
+            for camera_configs in configs['camera']
+        ]
+        ## For each camera, the same camera at each smaller resolution of the image pyramid.
+        self._levels = [
+            [_CameraOutput(configs, camera_configs, len(configs['camera']) > 1, factor)
+             for factor in configs['pyramid']['factors']]
+            for camera_configs in configs['camera']
+        ]
+        # The device, output, and quality settings belong to the scene, so any camera's interface
+        # can set them.
+        self._cameras[0].blender_interface.configure_device(
+            configs['device']['type'], configs['device']['indices'])
+        self._cameras[0].blender_interface.configure_output(
+            configs['image']['format'], configs['image']['color_depth'],
+            configs['image']['compression'])
+        self._cameras[0].blender_interface.configure_quality(
+            configs['render']['noise_threshold'], configs['render']['min_samples'],
+            configs['render']['max_samples'], configs['render']['time_limit'],
+            configs['render']['denoise'])
+        self._cameras[0].blender_interface.configure_motion_blur(
+            configs['motion_blur']['shutter'], configs['motion_blur']['rolling_shutter'])
+        # Repoint the textures before anything renders, so the originals are never loaded.
+        if configs['textures']['cache'] is not None and not configs['execution']['dry_run'] and \
+                not configs['execution']['plan']:
+            cached_count = cache_textures(configs['textures']['cache'],
+                                          configs['textures']['max_size'])
+            print(F'Using {cached_count} cached textures from {configs["textures"]["cache"]}')
+        resolution_x, resolution_y, percentage = \
+            self._cameras[0].blender_interface.render_resolution
+        for factor in configs['pyramid']['factors']:
+            if (resolution_x * percentage // 100) % factor != 0 or \
+                    (resolution_y * percentage // 100) % factor != 0:
+                raise ValueError(
+                    F'The rendered image size must be a multiple of every pyramid factor, but '
+                    F'{factor} does not divide {resolution_x * percentage // 100}x'
+                    F'{resolution_y * percentage // 100}.')
 
     def run(self) -> None:
         """!
         @brief Generate and write the data to file.
+
+        If more than one worker is configured, the trajectory is split into contiguous shards and
+        each shard is rendered by its own headless Blender process. Otherwise, every pose is
+        rendered in this process and its list entries are streamed to file as each image is
+        written.
+
+        If this process was given an index range, it is one node of a sequence split across
+        machines, or a worker of this script. It only renders its range, split across its own
+        workers if configured, and saves its partial results. Once every range is done, running
+        with the merge flag builds the list files from all the partial results. Images are always
+        named by their index in the whole trajectory, so every node writes into the same tree.
+
+        Every camera renders each pose, and each camera has its own intrinsic matrix, pose, and,
+        if there are several cameras, list files.
+
+        Every finished image is recorded in the checkpoint manifest of the range being rendered.
+        When resuming, images that are in any manifest and still complete on disk are not rendered
+        again.
+
+        If timing is enabled, a report of how long each stage took is written to the output folder
+        at the end.
+
+        If a status interval is configured, a status file with the progress, throughput, stage
+        latencies, device assignment, and errors is rewritten in the output folder while images are
+        made. A process with workers adds theirs to its own.
+
+        Before anything is rendered, every pose of the range is planned and every output checked.
+        See @ref _plan. A process with workers checks the whole range before starting them, and
+        each worker plans its own shard.
+
+        With the mosaic flag, the global image of the floor is rendered instead of the trajectory.
+        See @ref _run_mosaic. With the dry run flag, nothing is rendered and only the overlap and
+        coverage of the trajectory are reported. See @ref _run_dry_run. With the plan flag, the
+        plan is made and checked, and nothing is rendered. See @ref _run_plan.
+
+        @return None
+        @exception RuntimeError raised when merging if the partial results do not cover the whole
+        trajectory exactly once.
+        """
+        execution_configs = self._configs['execution']
+        if execution_configs['dry_run']:
+            self._run_dry_run()
+            return
+        if execution_configs['plan']:
+            self._run_plan()
+            return
+        if execution_configs['mosaic']:
+            self._run_mosaic()
+            return
+        if execution_configs['merge']:
+            self._write_camera_properties()
+            self._merge_partial_results()
+            self._write_timing_report(self._cameras[0].namer.timing_file())
+            return
+        if execution_configs['start_index'] is not None or \
+                execution_configs['end_index'] is not None:
+            start_index = execution_configs['start_index'] or 0
+            end_index = execution_configs['end_index']
+            if end_index is None:
+                end_index = len(self._trajectory)
+            with self._report_status(start_index, end_index, end_index - start_index):
+                if execution_configs['workers'] > 1:
+                    self._plan(start_index, end_index, self._read_checkpoints())
+                    self._run_workers(start_index, end_index)
+                else:
+                    pixel_poses = self._render_range(start_index, end_index, False)
+                    for camera, camera_pixel_poses in zip(self._cameras, pixel_poses):
+                        camera.writer.write_partial_poses(start_index, camera_pixel_poses)
+            self._write_timing_report(self._cameras[0].namer.timing_file(start_index, end_index))
+            return
+        if not execution_configs['resume']:
+            for camera in self._cameras:
+                camera.writer.clear_checkpoint()
+        self._write_camera_properties()
+        with self._report_status(None, None, len(self._trajectory)):
+            if execution_configs['workers'] > 1:
+                # Clear out anything left behind by an earlier run that did not finish.
+                for camera in self._cameras:
+                    camera.writer.remove_partial_poses()
+                self._plan(0, len(self._trajectory), self._read_checkpoints())
+                self._run_workers(0, len(self._trajectory))
+                self._merge_partial_results()
+            else:
+                try:
+                    for camera in self._cameras:
+                        camera.writer.open_lists()
+                    self._render_range(0, len(self._trajectory), True)
+                finally:
+                    for camera in self._cameras:
+                        camera.writer.close_lists()
+                self._write_level_lists()
+                self._write_shard_indices()
+        self._write_timing_report(self._cameras[0].namer.timing_file())
+
+    def _merge_partial_results(self) -> None:
+        """!
+        @brief Build each camera's list files from the partial results of every worker or node.
+
+        The partial results are removed once the lists are written.
+
+        @return None
+        @exception RuntimeError raised if the partial results do not cover the whole trajectory
+        exactly once.
+        """
+        with self._timer.measure('write_lists'):
+            for camera in self._cameras:
+                pixel_poses = camera.writer.read_partial_poses(len(self._trajectory))
+                camera.writer.write_lists(self._trajectory, pixel_poses)
+        for camera in self._cameras:
+            camera.writer.remove_partial_poses()
+        self._write_level_lists()
+        self._write_shard_indices()
+
+    def _write_shard_indices(self) -> None:
+        """!
+        @brief Join the shard indices of every range into one index for each camera and level. This
+        does nothing unless images are packed into shards.
+        @return None
+        """
+        if self._configs['shards']['images_per_shard'] is None:
+            return
+        for camera in self._cameras + [level for levels in self._levels for level in levels]:
+            write_shard_index(camera.output_folder, camera.namer)
+
+    def _write_level_lists(self) -> None:
+        """!
+        @brief Write the list files of each smaller resolution of the image pyramid.
+
+        The pixel poses are projected with each level's own intrinsic matrix, in chunks, and
+        streamed to its lists. This does nothing without a pyramid.
+
+        @return None
+        """
+        levels = [level for camera_levels in self._levels for level in camera_levels]
+        if len(levels) == 0:
+            return
+        with self._timer.measure('write_lists'):
+            try:
+                for level in levels:
+                    level.writer.open_lists()
+                for chunk_start in range(0, len(self._trajectory), _CHUNK_SIZE):
+                    chunk_end = min(chunk_start + _CHUNK_SIZE, len(self._trajectory))
+                    planar_poses = numpy.reshape(self._trajectory[chunk_start:chunk_end], (-1, 3))
+                    robot_poses = ground_texture_sim.transforms.create_planar_transform_matrices(
+                        planar_poses)
+                    for level in levels:
+                        pixel_poses = level.transformer.project_image_corners(robot_poses)
+                        pixel_transforms = \
+                            ground_texture_sim.transforms.create_planar_transform_matrices(
+                                pixel_poses)
+                        for k, i in enumerate(range(chunk_start, chunk_end)):
+                            level.writer.append_list_entry(
+                                i, planar_poses[k], pixel_poses[k], robot_poses[k],
+                                pixel_transforms[k])
+            finally:
+                for level in levels:
+                    level.writer.close_lists()
+
+    def _write_camera_properties(self) -> None:
+        """!
+        @brief Write the intrinsic matrix and pose of each camera, plus the render settings.
+        @return None
+        """
+        render_settings = self._cameras[0].blender_interface.render_settings
+        self._cameras[0].writer.write_render_settings(render_settings)
+        for factor, level in zip(self._configs['pyramid']['factors'], self._levels[0]):
+            level.writer.write_render_settings({**render_settings, 'downsample_factor': factor})
+        for camera in self._cameras + [level for levels in self._levels for level in levels]:
+            camera.writer.write_camera_intrinsic_matrix(
+                camera.transformer.camera_intrinsic_matrix)
+            camera.writer.write_camera_pose(camera.pose)
+
+    def _render_range(self, start_index: int, end_index: int,
+                      stream_lists: bool) -> List[numpy.ndarray]:
+        """!
+        @brief Render every trajectory pose with an index in the given range.
+
+        The range is planned and checked first, see @ref _plan. The camera poses are then found
+        from the planned robot poses in vectorized chunks, and each pose in the chunk is rendered.
+        At each pose, every camera is placed first, then each renders in turn, so all cameras see
+        the same scene state. Progress, throughput, and the estimated time remaining are printed
+        after each pose.
+
+        When pipelining, Blender writes each image uncompressed to a local staging folder. A
+        background thread then compresses it at the scene's PNG compression level and writes it to
+        its final location while the next pose renders. Checkpoint and list entries go through the
+        same thread, so they are only written once their image is.
+
+        If deduplication is enabled, poses whose images would be all but identical to an earlier
+        pose in the range reuse that pose's image, by hard link or copy, instead of rendering. Their
+        list entries are still written with their own poses.
+
+        If the batch size is more than 1, each camera renders the poses of a chunk that need it as
+        the frames of animations of up to that many keyframes, to a staging folder. Each frame is
+        then moved to its image path, or compressed there by the background thread if pipelining.
+
+        With motion blur, each camera moves from its pose at the previous trajectory index, through
+        the current one, to the next, while the shutter is open. The first and last poses only blur
+        towards their one neighbor.
+
+        With an image pyramid, Blender writes each image as an uncompressed TIFF to a staging
+        folder. It is then shrunk to each smaller resolution, and every resolution is written as a
+        PNG at the scene's compression level, in the background if pipelining.
+
+        With shards, every image is staged in a local temporary folder, then packed into its
+        camera's current shard instead of being written as its own file.
+
+        @param start_index The first trajectory index to render.
+        @param end_index One past the last trajectory index to render.
+        @param stream_lists If true, append each pose's entry to the open list files as soon as its
+        image is written, instead of keeping the pixel poses in memory.
+        @return For each camera, an Nx3 Numpy array of the projected image corner for each rendered
+        pose, in order, or None if the entries were streamed.
+        @exception RuntimeError raised if pipelining is requested for images that are not PNGs.
+        @exception Exception re-raises any error of the background writer, unless rendering had
+        already failed, in which case that error is raised instead.
+        """
+        finished_images = self._read_checkpoints()
+        plan = self._plan(start_index, end_index, finished_images)
+        pipeline = None
+        staging_directory = None
+        compression_level = None
+        submit = self._run_now
+        batch_size = self._configs['execution']['batch_size']
+        pyramid = len(self._configs['pyramid']['factors']) > 0
+        images_per_shard = self._configs['shards']['images_per_shard']
+        outputs = self._cameras + [level for levels in self._levels for level in levels]
+        progress_start = time.perf_counter()
+        # The image settings belong to the scene, so any camera's interface can read or set them.
+        scene_interface = self._cameras[0].blender_interface
+        if pyramid:
+            compression_level = scene_interface.png_compression_level
+        if self._configs['execution']['pipeline']:
+            image_format = scene_interface.image_format
+            if image_format != 'PNG':
+                raise RuntimeError(
+                    F'Pipelining only supports PNG images, not {image_format}')
+            compression_level = scene_interface.png_compression_level
+            scene_interface.png_compression_level = 0
+            staging_directory = tempfile.TemporaryDirectory()
+            pipeline = BackgroundWriter(self._configs['execution']['queue_size'])
+            submit = pipeline.submit
+        elif images_per_shard is not None:
+            # Packed images are copied into their shard anyway, so stage them on the local disk.
+            staging_directory = tempfile.TemporaryDirectory()
+        elif batch_size > 1 or pyramid:
+            # Stage images next to their final location, so moving them is only a rename.
+            os.makedirs(self._configs['output'], exist_ok=True)
+            staging_directory = tempfile.TemporaryDirectory(dir=self._configs['output'])
+        if images_per_shard is not None:
+            for output in outputs:
+                output.shard_writer = ShardWriter(
+                    output.output_folder, output.namer, start_index, images_per_shard,
+                    self._configs['deduplicate']['pixel_tolerance'] is not None)
+        staging_extension = 'png'
+        if pyramid:
+            scene_interface.configure_output('TIFF', self._configs['image']['color_depth'])
+            staging_extension = 'tif'
+        source_indices = None
+        if self._configs['deduplicate']['pixel_tolerance'] is not None:
+            with self._timer.measure('deduplicate'):
+                source_indices = self._find_duplicates(plan)
+            reused_count = numpy.count_nonzero(
+                source_indices != numpy.arange(start_index, end_index))
+            print(F'Reusing images for {reused_count} of {end_index - start_index} poses')
+        link_images = self._configs['deduplicate']['method'] == 'link'
+        motion_blur = self._configs['motion_blur']['shutter'] is not None
+        # Whether every pose was rendered, so a writer error is the only one to report.
+        rendered = False
+        try:
+            for chunk_start in range(start_index, end_index, _CHUNK_SIZE):
+                chunk_end = min(chunk_start + _CHUNK_SIZE, end_index)
+                offsets = slice(chunk_start - start_index, chunk_end - start_index)
+                # Convert each planned robot pose into a pose for each camera. The pixel values of
+                # the image corners were already planned.
+                with self._timer.measure('transforms'):
+                    robot_poses = ground_texture_sim.transforms.create_planar_transform_matrices(
+                        plan.robot_poses[offsets])
+                    camera_poses = [camera.transformer.transform_cameras_to_world(robot_poses)
+                                    for camera in self._cameras]
+                    if motion_blur:
+                        # Include the poses on either side of the chunk, where there are any.
+                        neighbor_start = max(chunk_start - 1, 0)
+                        neighbor_end = min(chunk_end + 1, len(self._trajectory))
+                        neighbor_robot_poses = \
+                            ground_texture_sim.transforms.create_planar_transform_matrices(
+                                numpy.reshape(self._trajectory[neighbor_start:neighbor_end],
+                                              (-1, 3)))
+                        neighbor_camera_poses = [
+                            camera.transformer.transform_cameras_to_world(neighbor_robot_poses)
+                            for camera in self._cameras]
+                if stream_lists:
+                    pixel_transforms = [
+                        ground_texture_sim.transforms.create_planar_transform_matrices(
+                            camera_pixel_poses[offsets]) for camera_pixel_poses in plan.pixel_poses]
+                # Find each camera's images that need writing, unless an earlier run already did.
+                chunk_pending_cameras = [
+                    [c for c, camera in enumerate(self._cameras)
+                     if i not in finished_images[c] or not camera.writer.image_is_complete(i)]
+                    for i in range(chunk_start, chunk_end)]
+                chunk_source_indices = numpy.arange(chunk_start, chunk_end)
+                if source_indices is not None:
+                    chunk_source_indices = source_indices[
+                        chunk_start - start_index:chunk_end - start_index]
+                if batch_size > 1:
+                    for c, camera in enumerate(self._cameras):
+                        render_offsets = [
+                            k for k, i in enumerate(range(chunk_start, chunk_end))
+                            if c in chunk_pending_cameras[k] and chunk_source_indices[k] == i]
+                        for batch_start in range(0, len(render_offsets), batch_size):
+                            self._render_batch(
+                                c, chunk_start,
+                                render_offsets[batch_start:batch_start + batch_size],
+                                camera_poses[c], staging_directory.name, submit,
+                                compression_level)
+                for k, i in enumerate(range(chunk_start, chunk_end)):
+                    pending_cameras = chunk_pending_cameras[k]
+                    source_index = int(chunk_source_indices[k])
+                    if source_index == i and batch_size == 1:
+                        with self._timer.measure('scene_update'):
+                            for c in pending_cameras:
+                                if motion_blur:
+                                    n = i - neighbor_start
+                                    self._cameras[c].blender_interface.place_moving_camera(
+                                        neighbor_camera_poses[c][max(n - 1, 0)],
+                                        neighbor_camera_poses[c][n],
+                                        neighbor_camera_poses[c][min(
+                                            n + 1, neighbor_end - neighbor_start - 1)])
+                                else:
+                                    self._cameras[c].blender_interface.place_camera(
+                                        camera_poses[c][k])
+                    for c in pending_cameras:
+                        camera = self._cameras[c]
+                        image_path = camera.namer.create_image_path(i, absolute=True)
+                        if source_index != i:
+                            # The background thread writes images in order, so the source image
+                            # is written before it is reused.
+                            for output in [camera] + self._levels[c]:
+                                if output.shard_writer is not None:
+                                    submit(self._timed, 'image_write', output.shard_writer.reuse,
+                                           source_index, i)
+                                else:
+                                    submit(self._timed, 'image_write', output.writer.reuse_image,
+                                           source_index, i, link_images)
+                            submit(self._timed, 'checkpoint', camera.writer.record_checkpoint, i,
+                                   start_index, end_index)
+                            continue
+                        # With batches, the image was already rendered with the rest of its batch.
+                        if batch_size == 1 and staging_directory is None:
+                            with self._timer.measure('render'):
+                                camera.blender_interface.render_image(image_path)
+                        elif batch_size == 1:
+                            staging_path = os.path.join(
+                                staging_directory.name,
+                                F'{camera.name}_{i:07d}.{staging_extension}')
+                            with self._timer.measure('render'):
+                                camera.blender_interface.render_image(staging_path)
+                            self._submit_staged_image(c, i, staging_path, submit,
+                                                      compression_level)
+                        submit(self._timed, 'checkpoint', camera.writer.record_checkpoint, i,
+                               start_index, end_index)
+                        self._rendered_images += 1
+                    if stream_lists:
+                        for c, camera in enumerate(self._cameras):
+                            submit(self._timed, 'lists', camera.writer.append_list_entry,
+                                   i, plan.robot_poses[i - start_index],
+                                   plan.pixel_poses[c][i - start_index],
+                                   robot_poses[k], pixel_transforms[c][k])
+                    self._status.update(i + 1 - start_index)
+                    print(format_progress(i + 1 - start_index, end_index - start_index,
+                                          time.perf_counter() - progress_start))
+            rendered = True
+        finally:
+            try:
+                if pipeline is not None:
+                    try:
+                        pipeline.close()
+                    except Exception as ex:  # pylint: disable=broad-except
+                        # Don't let the writer's error, often the same full disk, replace the
+                        # error that stopped rendering.
+                        if rendered:
+                            raise
+                        print(F'The background writer also failed: {ex}')
+                    finally:
+                        scene_interface.png_compression_level = compression_level
+            finally:
+                for output in outputs:
+                    if output.shard_writer is not None:
+                        output.shard_writer.close()
+                        output.shard_writer = None
+                if staging_directory is not None:
+                    staging_directory.cleanup()
+                if pyramid:
+                    scene_interface.configure_output('PNG', self._configs['image']['color_depth'])
+                if motion_blur:
+                    for camera in self._cameras:
+                        camera.blender_interface.clear_motion()
+        if stream_lists:
+            return None
+        return [numpy.array(camera_pixel_poses) for camera_pixel_poses in plan.pixel_poses]
+
+    def _render_batch(self, camera_index: int, chunk_start: int, offsets: List[int],
+                      camera_poses: numpy.ndarray, staging_folder: str, submit: Callable,
+                      compression_level: int) -> None:
+        """!
+        @brief Render several poses of one camera as a single animation, then move each frame to
+        its image path.
+        @param camera_index The index of the camera to render with.
+        @param chunk_start The trajectory index of the first pose of the chunk.
+        @param offsets The position within the chunk of each pose to render.
+        @param camera_poses The Nx4x4 pose of the camera in the world frame for each pose of the
+        chunk.
+        @param staging_folder The folder to render the frames to.
+        @param submit The function to pass each frame's move to, so it is ordered with the rest of
+        the writes.
+        @param compression_level If given, the PNG compression level to write each frame at, as
+        when pipelining. If None, each frame is moved as is.
+        @return None
+        """
+        camera = self._cameras[camera_index]
+        with self._timer.measure('render'):
+            frame_paths = camera.blender_interface.render_animation(
+                os.path.join(staging_folder, F'{camera.name}_#######'), camera_poses[offsets])
+        for offset, frame_path in zip(offsets, frame_paths):
+            self._submit_staged_image(camera_index, chunk_start + offset, frame_path, submit,
+                                      compression_level)
+
+    def _submit_staged_image(self, camera_index: int, index: int, staging_path: str,
+                             submit: Callable, compression_level: int) -> None:
+        """!
+        @brief Move a rendered image from the staging folder to its image path, writing each
+        smaller resolution too if there is an image pyramid.
+
+        With shards, the finished images stay in the staging folder until they are packed into
+        their shards.
+
+        @param camera_index The index of the camera that rendered the image.
+        @param index The trajectory index of the image.
+        @param staging_path The rendered image.
+        @param submit The function to pass the move to, so it is ordered with the rest of the
+        writes.
+        @param compression_level If given, the PNG compression level to write the image at. If
+        None, the image is moved as is.
+        @return None
+        """
+        outputs = [self._cameras[camera_index]] + self._levels[camera_index]
+        packing = outputs[0].shard_writer is not None
+        image_paths = []
+        for output in outputs:
+            if packing:
+                image_paths.append(os.path.join(
+                    os.path.dirname(staging_path), F'{output.downsample_factor}_' +
+                    os.path.basename(output.namer.create_image_path(index, absolute=False))))
+            else:
+                image_paths.append(output.namer.create_image_path(index, absolute=True))
+                os.makedirs(os.path.dirname(image_paths[-1]), exist_ok=True)
+        if len(outputs) > 1:
+            # Write the full resolution last, so it only exists once every level does.
+            destinations = [(image_path, output.downsample_factor)
+                            for output, image_path in zip(outputs[1:], image_paths[1:])]
+            destinations.append((image_paths[0], 1))
+            submit(self._timed, 'image_write', write_pyramid, staging_path, destinations,
+                   compression_level)
+        elif compression_level is None:
+            submit(self._timed, 'image_write', os.replace, staging_path, image_paths[0])
+        else:
+            submit(self._timed, 'image_write', recompress_png, staging_path, image_paths[0],
+                   compression_level)
+        if packing:
+            for output, image_path in zip(outputs, image_paths):
+                submit(self._timed, 'image_write', output.shard_writer.add, index, image_path)
+
+    def _find_duplicates(self, plan: JobPlan) -> numpy.ndarray:
+        """!
+        @brief Find which poses in a range can reuse the image of an earlier pose in the range.
+        @param plan The plan of the range to check.
+        @return A 1D Numpy array holding, for each pose in the range, the trajectory index of the
+        pose whose image to use. This is the pose's own index if it must be rendered.
+        """
+        return plan.start_index + find_duplicates(
+            plan.pixel_poses, self._configs['deduplicate']['pixel_tolerance'],
+            self._configs['deduplicate']['yaw_tolerance'])
+
+    def _read_checkpoints(self) -> List[set]:
+        """!
+        @brief Find the images each camera already finished, if resuming.
+        @return For each camera, the set of trajectory indices in its checkpoint manifest. These are
+        empty unless resuming.
+        """
+        if not self._configs['execution']['resume']:
+            return [set() for _ in self._cameras]
+        return [camera.writer.read_checkpoint() for camera in self._cameras]
+
+    def _plan(self, start_index: int, end_index: int, finished_images: List[set]) -> JobPlan:
+        """!
+        @brief Plan every pose of a range and check that its images can be written.
+
+        The robot pose and each camera's pixel pose are computed for the whole range and saved in
+        the output folder, under plan, before anything renders. See @ref JobPlan. Every output's
+        folder must then be writable, and its longest path must fit the file system. Finally, the
+        images still to render are checked against the free disk space. Since that estimate is of
+        uncompressed images, running short is only warned about.
+
+        @param start_index The first trajectory index to plan.
+        @param end_index One past the last trajectory index to plan.
+        @param finished_images For each camera, the trajectory indices an earlier run finished,
+        which take no more space.
+        @return The plan.
+        @exception RuntimeError raised if an output can't be written.
+        """
+        namer = self._cameras[0].namer
+        plan_folder = namer.plan_folder()
+        if start_index != 0 or end_index != len(self._trajectory):
+            plan_folder = namer.plan_folder(start_index, end_index)
+        with self._timer.measure('plan'):
+            plan = JobPlan(os.path.join(self._configs['output'], plan_folder), self._trajectory,
+                           [(camera.name, camera.transformer) for camera in self._cameras],
+                           start_index, end_index)
+            # The resolution belongs to the scene, so any camera's interface can read it.
+            resolution_x, resolution_y, percentage = \
+                self._cameras[0].blender_interface.render_resolution
+            sample_bytes = _SAMPLE_BYTES.get(self._configs['image']['color_depth'], 1)
+            output_paths = []
+            required_bytes = 0
+            for camera, levels, camera_finished in zip(self._cameras, self._levels,
+                                                       finished_images):
+                pending_count = len(plan) - len(
+                    [i for i in camera_finished if start_index <= i < end_index])
+                for output in [camera] + levels:
+                    factor = output.downsample_factor
+                    required_bytes += pending_count * 3 * sample_bytes * \
+                        (resolution_x * percentage // 100 // factor) * \
+                        (resolution_y * percentage // 100 // factor)
+                    if len(plan) == 0:
+                        continue
+                    if self._configs['shards']['images_per_shard'] is not None:
+                        output_paths.append(os.path.abspath(os.path.join(
+                            output.output_folder, output.namer.shard_file(start_index, 0))))
+                    else:
+                        output_paths.append(output.namer.create_image_path(
+                            end_index - 1, absolute=True))
+            os.makedirs(self._configs['output'], exist_ok=True)
+            if not plan.validate(self._configs['output'], output_paths, required_bytes):
+                print(F'WARNING: The images may take up to {required_bytes / 1e9:.2f} GB '
+                      F'uncompressed, but only {plan.free_bytes / 1e9:.2f} GB is free')
+        return plan
+
+    def _run_plan(self) -> None:
+        """!
+        @brief Plan and check the trajectory, or this process's range of it, without rendering.
+        See @ref _plan.
+        @return None
+        @exception RuntimeError raised if an output can't be written.
+        """
+        execution_configs = self._configs['execution']
+        start_index = execution_configs['start_index'] or 0
+        end_index = execution_configs['end_index']
+        if end_index is None:
+            end_index = len(self._trajectory)
+        plan = self._plan(start_index, end_index, self._read_checkpoints())
+        print(F'Planned {len(plan)} poses of {len(self._cameras)} cameras in {plan.folder}')
+        print(F'The images may take up to {plan.required_bytes / 1e9:.2f} GB uncompressed, with '
+              F'{plan.free_bytes / 1e9:.2f} GB free')
+        self._write_timing_report(self._cameras[0].namer.timing_file())
+
+    def _run_dry_run(self) -> None:
+        """!
+        @brief Report how much consecutive frames overlap and how much of the floor is covered,
+        without rendering.
+
+        The trajectory, or this process's range of it, is read twice in chunks: once to find the
+        area it spans, then once to project every frame of every camera onto the floor. A summary
+        and a raster counting how often each cell of the floor was seen are written for each
+        camera, and the summary is printed.
+
+        @return None
+        """
+        execution_configs = self._configs['execution']
+        dry_run_configs = self._configs['dry_run']
+        start_index = execution_configs['start_index'] or 0
+        end_index = execution_configs['end_index']
+        if end_index is None:
+            end_index = len(self._trajectory)
+        x_limits = [numpy.inf, -numpy.inf]
+        y_limits = [numpy.inf, -numpy.inf]
+        for chunk_start in range(start_index, end_index, _CHUNK_SIZE):
+            poses = numpy.reshape(
+                self._trajectory[chunk_start:min(chunk_start + _CHUNK_SIZE, end_index)], (-1, 3))
+            x_limits = [min(x_limits[0], poses[:, 0].min()), max(x_limits[1], poses[:, 0].max())]
+            y_limits = [min(y_limits[0], poses[:, 1].min()), max(y_limits[1], poses[:, 1].max())]
+        if start_index >= end_index:
+            x_limits = [0.0, 0.0]
+            y_limits = [0.0, 0.0]
+        # The resolution belongs to the scene, so any camera's interface can read it.
+        resolution_x, resolution_y, percentage = \
+            self._cameras[0].blender_interface.render_resolution
+        image_size = (resolution_x * percentage // 100, resolution_y * percentage // 100)
+        analyzers = [
+            CoverageAnalyzer(camera.transformer, image_size, x_limits, y_limits,
+                             dry_run_configs['cell_size']) for camera in self._cameras]
+        with self._timer.measure('coverage'):
+            for chunk_start in range(start_index, end_index, _CHUNK_SIZE):
+                robot_poses = ground_texture_sim.transforms.create_planar_transform_matrices(
+                    numpy.reshape(self._trajectory[
+                        chunk_start:min(chunk_start + _CHUNK_SIZE, end_index)], (-1, 3)))
+                for analyzer in analyzers:
+                    analyzer.add_poses(robot_poses)
+        for camera, analyzer in zip(self._cameras, analyzers):
+            summary = analyzer.summary(dry_run_configs['min_overlap'])
+            camera.writer.write_coverage_report(summary)
+            camera.writer.write_coverage_raster(analyzer.raster)
+            overlap = summary['overlap']
+            if overlap['mean'] is not None:
+                print(F'{camera.name}: overlap mean {overlap["mean"]:.3f}, min '
+                      F'{overlap["min"]:.3f}, 5th percentile {overlap["p5"]:.3f}')
+            print(F'{camera.name}: covered {summary["coverage"]["covered_area"]:.3f} m^2, seen '
+                  F'{summary["coverage"]["mean_observations"]:.2f} times on average')
+            if overlap['below_minimum'] > 0:
+                print(F'WARNING: {overlap["below_minimum"]} consecutive frames of {camera.name} '
+                      F'overlap less than {overlap["minimum"]}')
+        self._write_timing_report(self._cameras[0].namer.timing_file())
+
+    def _run_mosaic(self) -> None:
+        """!
+        @brief Render the configured area of the floor as one tiled TIFF of the global image.
+
+        The global image is the one the list files' pixel poses are measured in, for the first
+        camera. Each tile is rendered by an orthographic camera looking straight down, then added
+        to the TIFF and deleted, so the whole image is never held in memory or on disk twice. A
+        JSON file records the global image pixel at the mosaic's top left corner.
+
+        If more than one worker is configured, the tiles are split between them and each worker
+        saves its tiles to the staging folder, which are then added to the TIFF in turn. If this
+        process was given an index range, it only renders those tiles to the staging folder.
+
+        @return None
+        @exception ValueError raised if the tile range does not fit within the mosaic.
+        """
+        execution_configs = self._configs['execution']
+        mosaic_configs = self._configs['mosaic']
+        camera = self._cameras[0]
+        planner = MosaicPlanner(
+            camera.transformer, (mosaic_configs['x_min'], mosaic_configs['x_max']),
+            (mosaic_configs['y_min'], mosaic_configs['y_max']), mosaic_configs['tile_size'])
+        os.makedirs(os.path.join(self._configs['output'], 'mosaic_tiles'), exist_ok=True)
+        if execution_configs['start_index'] is not None or \
+                execution_configs['end_index'] is not None:
+            start_index = execution_configs['start_index'] or 0
+            end_index = execution_configs['end_index']
+            if end_index is None:
+                end_index = planner.tile_count
+            if start_index >= end_index or end_index > planner.tile_count:
+                raise ValueError(
+                    F'Tile range [{start_index}, {end_index}) does not fit within the '
+                    F'{planner.tile_count} tiles of the mosaic.')
+            with self._report_status(start_index, end_index, end_index - start_index):
+                self._render_mosaic_tiles(planner, range(start_index, end_index), None)
+            self._write_timing_report(camera.namer.timing_file(start_index, end_index))
+            return
+        print(F'Rendering a {planner.width}x{planner.height} mosaic in {planner.tile_count} tiles')
+        tiff_writer = TiledTiffWriter(
+            os.path.join(self._configs['output'], camera.namer.mosaic_file), planner.width,
+            planner.height, planner.tile_size, mosaic_configs['compress'])
+        try:
+            with self._report_status(None, None, planner.tile_count):
+                if execution_configs['workers'] > 1:
+                    self._run_workers(0, planner.tile_count)
+                    for index in range(planner.tile_count):
+                        self._timed('image_write', self._add_mosaic_tile, planner, tiff_writer,
+                                    index)
+                else:
+                    self._render_mosaic_tiles(planner, range(planner.tile_count), tiff_writer)
+        finally:
+            tiff_writer.close()
+        camera.writer.write_mosaic_metadata(planner.metadata())
+        self._write_timing_report(camera.namer.timing_file())
+
+    def _render_mosaic_tiles(self, planner: MosaicPlanner, indices: range,
+                             tiff_writer: TiledTiffWriter) -> None:
+        """!
+        @brief Render tiles of the mosaic with an orthographic camera.
+
+        The scene's resolution and image format are changed to suit the tiles, then put back, and
+        the orthographic camera is deleted afterwards, so later jobs on the same scene are
+        unaffected.
+
+        @param planner The layout of the mosaic's tiles.
+        @param indices The numbers of the tiles to render.
+        @param tiff_writer If given, each tile is added to it as soon as it is rendered. Otherwise,
+        the tiles are left in the staging folder.
+        @return None
+        """
+        ground_texture_sim.blender_interface.create_orthographic_camera(
+            _MOSAIC_CAMERA, planner.orthographic_scale)
+        try:
+            interface = ground_texture_sim.blender_interface.BlenderInterface(_MOSAIC_CAMERA)
+            original_resolution = interface.render_resolution
+            original_format = interface.image_format
+            interface.configure_output('BMP')
+            interface.render_resolution = (planner.tile_size, planner.tile_size, 100)
+            start_time = time.perf_counter()
+            try:
+                for done, index in enumerate(indices, 1):
+                    tile_path = os.path.join(
+                        self._configs['output'], self._cameras[0].namer.mosaic_tile_file(index))
+                    self._timed('scene_update', interface.place_camera,
+                                planner.tile_camera_pose(index))
+                    self._timed('render', interface.render_image, tile_path)
+                    self._rendered_images += 1
+                    if tiff_writer is not None:
+                        self._timed('image_write', self._add_mosaic_tile, planner, tiff_writer,
+                                    index)
+                    self._status.update(done)
+                    print(format_progress(done, len(indices), time.perf_counter() - start_time))
+            finally:
+                interface.render_resolution = original_resolution
+                interface.configure_output(original_format)
+        finally:
+            ground_texture_sim.blender_interface.remove_orthographic_camera(_MOSAIC_CAMERA)
+
+    def _add_mosaic_tile(self, planner: MosaicPlanner, tiff_writer: TiledTiffWriter,
+                         index: int) -> None:
+        """!
+        @brief Move one rendered tile from the staging folder into the mosaic.
+        @param planner The layout of the mosaic's tiles.
+        @param tiff_writer The mosaic to add the tile to.
+        @param index The number of the tile.
+        @return None
+        """
+        tile_path = os.path.join(
+            self._configs['output'], self._cameras[0].namer.mosaic_tile_file(index))
+        height, width = planner.tile_shape(index)
+        row, column = planner.tile_position(index)
+        tiff_writer.write_tile(row, column, read_bmp(tile_path)[0:height, 0:width])
+        os.remove(tile_path)
+
+    @staticmethod
+    def _run_now(function: Callable, *args) -> None:
+        """!
+        @brief Call a function right away. This stands in for the pipeline when it is disabled.
+        @param function The function to call.
+        @param args The arguments to pass to the function.
+        @return None
+        """
+        function(*args)
+
+    def _timed(self, stage: str, function: Callable, *args) -> None:
+        """!
+        @brief Call a function, recording how long it took under the given stage.
+        @param stage The name of the stage.
+        @param function The function to call.
+        @param args The arguments to pass to the function.
+        @return None
+        """
+        with self._timer.measure(stage):
+            function(*args)
+
+    def _write_timing_report(self, file_name: str) -> None:
+        """!
+        @brief Write the timing report to the output folder, if timing is enabled.
+        @param file_name The name of the report, relative to *output*.
+        @return None
+        """
+        if not self._configs['execution']['timing']:
+            return
+        file_path = os.path.join(self._configs['output'], file_name)
+        self._timer.write_report(file_path, self._rendered_images)
+        print(F'Timing report written to {file_path}')
+
+    def _report_status(self, start_index: int, end_index: int, total: int) -> StatusReporter:
+        """!
+        @brief Create the reporter of the images about to be made, which is enabled if a status
+        interval is configured.
+        @param start_index For a range, the first trajectory index or tile it makes. Leave as None
+        for the whole run.
+        @param end_index For a range, one past the last trajectory index or tile it makes.
+        @param total How many images or tiles will be made.
+        @return The reporter, to use as a context manager around making them.
+        """
+        status_configs = self._configs['status']
+        labels = {'output': os.path.abspath(self._configs['output']),
+                  'start': str(start_index or 0),
+                  'end': str(end_index if end_index is not None else total)}
+        self._status = StatusReporter(
+            os.path.join(self._configs['output'],
+                         self._cameras[0].namer.status_file(start_index, end_index)),
+            total, status_configs['interval'], self._timer, status_configs['prometheus'],
+            {'device_type': self._configs['device']['type'],
+             'device_indices': self._configs['device']['indices']}, labels)
+        return self._status
+
+    def _run_workers(self, start_index: int, end_index: int) -> None:
+        """!
+        @brief Split a trajectory range into one shard per worker and render each in its own
+        Blender.
+
+        Each worker is a headless Blender process running this same script on the same scene, but
+        restricted to its shard. In mosaic mode, the range counts tiles instead of poses. When
+        rendering on GPUs, each worker is pinned to its own one, in turn. This blocks until all
+        workers finish.
+
+        @param start_index The first trajectory index to render.
+        @param end_index One past the last trajectory index to render.
         @return None
+        @exception RuntimeError raised if any worker exits with an error.
         """
-        # For each trajectory, convert it into a camera pose and write the image. Capture the pixel
-        # values of the image corners too
-        pixel_poses = []
-        for i, trajectory in enumerate(self._trajectory):
-            robot_pose = ground_texture_sim.transforms.create_transform_matrix(
-                trajectory[0], trajectory[1], 0.0, 0.0, 0.0, trajectory[2])
-            # Convert to a camera pose
-            camera_pose = self._transformer.transform_camera_to_world(
-                robot_pose)
-            # Write camera image
-            image_path = self._namer.create_image_path(i, absolute=True)
-            self._blender_interface.generate_image(image_path, camera_pose)
-            # Project the image corner
-            pixel_poses.append(
-                self._transformer.project_image_corner(robot_pose))
-        # Write main list files.
-        self._writer.write_camera_intrinsic_matrix(
-            self._blender_interface.camera_intrinsic_matrix)
-        self._writer.write_camera_pose(self._camera_pose)
-        self._writer.write_lists(self._trajectory, pixel_poses)
+        pose_count = end_index - start_index
+        worker_count = min(self._configs['execution']['workers'], max(pose_count, 1))
+        device_type = self._configs['device']['type']
+        device_indices = []
+        if device_type is not None and device_type != 'CPU':
+            device_indices = self._configs['device']['indices']
+            if device_indices is None:
+                device_indices = list(range(len(
+                    self._cameras[0].blender_interface.available_devices(device_type))))
+        processes = []
+        workers = []
+        for worker in range(worker_count):
+            shard_start = start_index + pose_count * worker // worker_count
+            shard_end = start_index + pose_count * (worker + 1) // worker_count
+            # Later arguments win, so this replaces any range or worker count given to this process.
+            worker_args = ['--start', str(shard_start), '--end', str(shard_end), '--workers', '1',
+                           '--date', self._configs['sequence']['date']]
+            if len(device_indices) > 0:
+                worker_args += ['--device-index', str(device_indices[worker % len(device_indices)])]
+            command = self._cameras[0].blender_interface.create_worker_command(
+                self._script_args + worker_args)
+            processes.append(subprocess.Popen(command))
+            workers.append({
+                'range': [shard_start, shard_end],
+                'device_index': device_indices[worker % len(device_indices)]
+                if len(device_indices) > 0 else None,
+                'pid': processes[-1].pid,
+                'status_file': os.path.abspath(os.path.join(
+                    self._configs['output'],
+                    self._cameras[0].namer.status_file(shard_start, shard_end)))
+            })
+        self._status.set_workers(workers)
+        failed_workers = []
+        for worker, process in enumerate(processes):
+            return_code = process.wait()
+            self._status.finish_worker(worker, return_code)
+            if return_code != 0:
+                failed_workers.append(worker)
+        if len(failed_workers) > 0:
+            raise RuntimeError(F'Workers {failed_workers} failed to render their shards.')
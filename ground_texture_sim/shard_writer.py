@@ -0,0 +1,177 @@
+"""!
+@brief This module provides a class that packs finished images into tar shards, so a sequence of
+millions of images is a few thousand files instead of millions.
+"""
+import glob
+import os
+import tarfile
+from typing import Dict, Tuple
+from ground_texture_sim.name_configuration import NameConfigurator
+
+
+class ShardWriter():
+    """!
+    @brief A class that streams the images of one range of the trajectory into tar shards.
+
+    Each image is stored uncompressed under its usual relative path, so extracting a shard gives
+    the same tree as writing loose images. Every image also gets a line in the range's index,
+    recording where its bytes start in its shard, so a reader can seek straight to any image. Once
+    every range is done, @ref write_shard_index joins the ranges' indices into one.
+    """
+
+    def __init__(self, output_folder: str, namer: NameConfigurator, start_index: int,
+                 images_per_shard: int, track_locations: bool = False) -> None:
+        """!
+        @brief Construct the writer. No shard is created until the first image is added.
+        @param output_folder The root output folder under which all data resides.
+        @param namer The namer of the camera whose images are packed.
+        @param start_index The first trajectory index of the range being rendered.
+        @param images_per_shard How many images to pack into each shard before starting the next.
+        @param track_locations If true, remember where each image went, so @ref reuse can point
+        later images at it.
+        """
+        ## The root output folder under which all data resides.
+        self._output_folder = output_folder
+        ## The namer of the camera whose images are packed.
+        self._namer = namer
+        ## The first trajectory index of the range being rendered.
+        self._start_index = start_index
+        ## How many images to pack into each shard.
+        self._images_per_shard = images_per_shard
+        ## The shard, size, and offset of each image added, keyed by index, or None if not tracked.
+        self._locations = {} if track_locations else None
+        ## The number of the next shard to open.
+        self._shard_number = 0
+        ## The open shard, or None.
+        self._shard = None
+        ## The path of the open shard, relative to *output*.
+        self._shard_name = None
+        ## How many images are in the open shard.
+        self._shard_images = 0
+        ## The open index of this range, or None.
+        self._index_file = None
+
+    def add(self, index: int, file_path: str) -> None:
+        """!
+        @brief Pack a finished image into the current shard, then remove it.
+        @param index The image number.
+        @param file_path The image to pack.
+        @return None
+        """
+        if self._shard is None:
+            self._open_shard()
+        member_name = self._namer.create_image_path(index, absolute=False)
+        tar_info = self._shard.gettarinfo(name=file_path, arcname=member_name)
+        with open(file=file_path, mode='rb') as image_file:
+            self._shard.addfile(tar_info, image_file)
+        # The header's length depends on the name, so find the data back from the member's end.
+        padded_size = -(-tar_info.size // tarfile.BLOCKSIZE) * tarfile.BLOCKSIZE
+        location = (self._shard_name, self._shard.offset - padded_size, tar_info.size)
+        self._record(index, location)
+        os.remove(file_path)
+        self._shard_images += 1
+        if self._shard_images >= self._images_per_shard:
+            self._close_shard()
+
+    def close(self) -> None:
+        """!
+        @brief Finish the open shard and the range's index. This does nothing if none are open.
+        @return None
+        """
+        self._close_shard()
+        if self._index_file is not None:
+            self._index_file.close()
+            self._index_file = None
+
+    def reuse(self, source_index: int, index: int) -> None:
+        """!
+        @brief Give an image the same contents as an already packed one, without packing it again.
+        @param source_index The image number to reuse. It must already be added to this writer.
+        @param index The image number that reuses it.
+        @return None
+        @exception RuntimeError raised if locations are not tracked or the source was not added.
+        """
+        if self._locations is None or source_index not in self._locations:
+            raise RuntimeError(F'Image {source_index} was not packed, so it can not be reused.')
+        self._record(index, self._locations[source_index])
+
+    def _close_shard(self) -> None:
+        """!
+        @brief Finish the open shard. This does nothing if none is open.
+        @return None
+        """
+        if self._shard is None:
+            return
+        self._shard.close()
+        self._shard = None
+        self._index_file.flush()
+
+    def _open_shard(self) -> None:
+        """!
+        @brief Start the next shard, and the range's index if this is the first shard.
+        @return None
+        """
+        if self._index_file is None:
+            index_path = os.path.join(
+                self._output_folder, self._namer.shard_index_part_file(self._start_index))
+            os.makedirs(os.path.dirname(index_path), exist_ok=True)
+            # The index stays open until close, so a with block does not fit here.
+            # pylint: disable-next=consider-using-with
+            self._index_file = open(file=index_path, mode='w', encoding='utf-8')
+        self._shard_name = self._namer.shard_file(self._start_index, self._shard_number)
+        self._shard = tarfile.open(
+            name=os.path.join(self._output_folder, self._shard_name), mode='w',
+            format=tarfile.PAX_FORMAT)
+        self._shard_number += 1
+        self._shard_images = 0
+
+    def _record(self, index: int, location: Tuple[str, int, int]) -> None:
+        """!
+        @brief Add an image's line to the range's index.
+        @param index The image number.
+        @param location The path of the image's shard, relative to *output*, the offset of its
+        bytes in the shard, and how many bytes it is.
+        @return None
+        """
+        if self._locations is not None:
+            self._locations[index] = location
+        shard_name, offset, size = location
+        self._index_file.write(
+            F'{index} {self._namer.create_image_path(index, absolute=False)} {shard_name} '
+            F'{offset} {size}\n')
+
+
+def read_shard_index(file_path: str) -> Dict[int, Tuple[str, str, int, int]]:
+    """!
+    @brief Read an index written by @ref write_shard_index.
+    @param file_path The index to read.
+    @return The image path, shard path, offset, and size of each image, keyed by image number. The
+    paths are relative to *output*.
+    """
+    result = {}
+    with open(file=file_path, mode='r', encoding='utf-8') as index_file:
+        for line in index_file:
+            index, image_path, shard_name, offset, size = line.split()
+            result[int(index)] = (image_path, shard_name, int(offset), int(size))
+    return result
+
+
+def write_shard_index(output_folder: str, namer: NameConfigurator) -> None:
+    """!
+    @brief Join the index of every range's shards into the one index of the sequence.
+
+    Each line is the image number, its path as in the list files, the path of its shard, the offset
+    of its bytes in the shard, and how many bytes it is, separated by spaces. The ranges' names
+    sort by their first index, so joining them in order keeps the images in order.
+
+    @param output_folder The root output folder under which all data resides.
+    @param namer The namer of the camera whose shards to index.
+    @return None
+    """
+    part_paths = sorted(glob.glob(os.path.join(output_folder, namer.shard_index_part_pattern)))
+    with open(file=os.path.join(output_folder, namer.shard_index_file), mode='w',
+              encoding='utf-8') as index_file:
+        for part_path in part_paths:
+            with open(file=part_path, mode='r', encoding='utf-8') as part_file:
+                for line in part_file:
+                    index_file.write(line)
@@ -0,0 +1,331 @@
+"""!
+@brief This module provides a status file, rewritten in the background, so schedulers can follow a
+long run's progress, throughput, and failures without parsing its console output.
+"""
+import json
+import os
+import socket
+import threading
+import time
+from typing import Dict, List
+from ground_texture_sim.timing import StageTimer
+
+## The upper bound, in seconds, of each bucket of the stage latency histograms.
+LATENCY_BUCKETS = [0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 10.0, 30.0, 60.0, 300.0]
+## The prefix of every Prometheus metric name.
+_METRIC_PREFIX = 'ground_texture_sim'
+
+
+class StatusReporter:
+    """!
+    @brief A class that keeps a JSON status file, and optionally a Prometheus text file, up to date
+    while images are made.
+
+    The render loop only updates counters, which is cheap, while a background thread rewrites the
+    files every interval, even when a single image takes longer than that. Each file is written next
+    to its destination and then renamed, so readers never see a partial file. While workers run,
+    each writes its own status, and this one adds their progress, errors, and stage latencies to
+    its own.
+
+    It is a context manager, so the files are marked finished or failed however the run ends:
+    ```
+    with StatusReporter(file_path, total, 10.0, timer) as status:
+        status.update(done)
+    ```
+    """
+
+    def __init__(self, file_path: str, total: int, interval: float = None,
+                 timer: StageTimer = None, prometheus: bool = False,
+                 assignment: Dict = None, labels: Dict[str, str] = None) -> None:
+        """!
+        @brief Create the reporter. Nothing is written until it is started.
+        @param file_path Where to write the status JSON.
+        @param total How many images this run makes.
+        @param interval How many seconds to wait between rewrites. If None, nothing is ever
+        written, so reporting can be left in place at no real cost.
+        @param timer The timer whose stage durations to report as latency histograms, if any. It
+        must have been created with @ref LATENCY_BUCKETS as its bucket bounds.
+        @param prometheus If true, also write the status in the Prometheus text format, next to the
+        JSON with a .prom extension, for the node exporter's textfile collector.
+        @param assignment What this process was given to render with, such as its device.
+        @param labels The Prometheus labels that tell this run apart from others.
+        """
+        ## Whether anything is written at all.
+        self.enabled = interval is not None
+        ## Where to write the status JSON.
+        self._file_path = file_path
+        ## Where to write the Prometheus text file, or None.
+        self._prometheus_path = os.path.splitext(file_path)[0] + '.prom' if prometheus else None
+        ## How many images this run makes.
+        self._total = total
+        ## How many seconds to wait between rewrites.
+        self._interval = interval
+        ## The timer whose stage durations are reported.
+        self._timer = timer
+        ## What this process was given to render with.
+        self._assignment = assignment or {}
+        ## The Prometheus labels that tell this run apart from others.
+        self._labels = labels or {}
+        ## Guards the counters, which the render loop and background thread share.
+        self._lock = threading.Lock()
+        ## How many images this process has finished.
+        self._done = 0
+        ## How many errors this process has had.
+        self._errors = 0
+        ## Whether the run is running, finished, or failed.
+        self._state = 'running'
+        ## The range, device, process ID, status file, and exit code of each worker, if any.
+        self._workers = []
+        ## The wall clock time the run started.
+        self._start_time = time.time()
+        ## The time the run started, for throughput.
+        self._start_counter = time.perf_counter()
+        ## Tells the background thread to stop.
+        self._stop = threading.Event()
+        ## The background thread rewriting the files, once started.
+        self._thread = None
+
+    def __enter__(self) -> 'StatusReporter':
+        """!
+        @brief Start the reporter.
+        @return This reporter.
+        """
+        self.start()
+        return self
+
+    def __exit__(self, exception_type, exception_value, traceback) -> bool:
+        """!
+        @brief Stop the reporter, marking the run failed if an exception is leaving the block.
+        @param exception_type The type of the exception, or None.
+        @param exception_value The exception, or None.
+        @param traceback The traceback of the exception, or None.
+        @return False, so any exception keeps going.
+        """
+        self.close('finished' if exception_type is None else 'failed')
+        return False
+
+    def start(self) -> None:
+        """!
+        @brief Write the first status and start rewriting it in the background.
+        @return None
+        """
+        if not self.enabled:
+            return
+        self.write()
+        self._thread = threading.Thread(target=self._run, daemon=True)
+        self._thread.start()
+
+    def update(self, done: int) -> None:
+        """!
+        @brief Record how many images this process has finished.
+        @param done How many images are finished.
+        @return None
+        """
+        with self._lock:
+            self._done = done
+
+    def set_workers(self, workers: List[Dict]) -> None:
+        """!
+        @brief Record the workers this process started.
+        @param workers For each worker, a dictionary of its 'range', 'device_index', 'pid', and the
+        absolute path of its 'status_file'.
+        @return None
+        """
+        with self._lock:
+            self._workers = [{**worker, 'return_code': None} for worker in workers]
+
+    def finish_worker(self, worker: int, return_code: int) -> None:
+        """!
+        @brief Record that a worker exited.
+        @param worker The number of the worker, in the order they were set.
+        @param return_code The worker's exit code. Anything but 0 counts as an error.
+        @return None
+        """
+        with self._lock:
+            self._workers[worker]['return_code'] = return_code
+
+    def close(self, state: str) -> None:
+        """!
+        @brief Stop rewriting in the background and write the final status.
+        @param state Either 'finished' or 'failed'. Failing counts as an error.
+        @return None
+        """
+        if not self.enabled:
+            return
+        self._stop.set()
+        if self._thread is not None:
+            self._thread.join()
+            self._thread = None
+        with self._lock:
+            self._state = state
+            if state == 'failed':
+                self._errors += 1
+        self.write()
+
+    def snapshot(self) -> Dict:
+        """!
+        @brief Gather the current status, including that of any workers.
+        @return A dictionary of the status, suitable for saving as JSON.
+        """
+        with self._lock:
+            done = self._done
+            errors = self._errors
+            state = self._state
+            workers = [dict(worker) for worker in self._workers]
+        stages = self._timer.histograms() if self._timer is not None else {}
+        worker_statuses = []
+        for worker in workers:
+            worker_status = read_status(worker['status_file'])
+            worker_done = 0
+            worker_errors = 0
+            worker_state = 'starting'
+            if worker_status is not None:
+                worker_done = worker_status['frames']['done']
+                worker_errors = worker_status['errors']
+                worker_state = worker_status['state']
+                _add_histograms(stages, worker_status['stages'])
+            # A worker that crashed may not have been able to say so.
+            if worker['return_code'] not in [None, 0] and worker_state != 'failed':
+                worker_state = 'failed'
+                worker_errors += 1
+            done += worker_done
+            errors += worker_errors
+            worker_statuses.append({
+                'range': worker['range'],
+                'device_index': worker['device_index'],
+                'pid': worker['pid'],
+                'state': worker_state,
+                'frames_done': worker_done,
+                'errors': worker_errors
+            })
+        elapsed = time.perf_counter() - self._start_counter
+        rate = done / elapsed if elapsed > 0 else 0.0
+        return {
+            'state': state,
+            'host': socket.gethostname(),
+            'pid': os.getpid(),
+            'started': self._start_time,
+            'updated': time.time(),
+            'frames': {
+                'done': done,
+                'total': self._total,
+                'per_second': rate,
+                'eta_seconds': (self._total - done) / rate if rate > 0 else None
+            },
+            'errors': errors,
+            'assignment': {**self._assignment, 'workers': worker_statuses},
+            'stages': stages
+        }
+
+    def write(self) -> None:
+        """!
+        @brief Write the current status to its files.
+        @return None
+        """
+        status = self.snapshot()
+        os.makedirs(os.path.dirname(os.path.abspath(self._file_path)), exist_ok=True)
+        _replace_file(self._file_path, json.dumps(status, indent=2))
+        if self._prometheus_path is not None:
+            _replace_file(self._prometheus_path, format_prometheus(status, self._labels))
+
+    def _run(self) -> None:
+        """!
+        @brief Rewrite the status every interval until stopped. A failed write is reported and
+        tried again next interval, rather than stopping the run.
+        @return None
+        """
+        while not self._stop.wait(self._interval):
+            try:
+                self.write()
+            except OSError as ex:
+                print(F'Could not write the status to {self._file_path}: {ex}')
+
+
+def read_status(file_path: str) -> Dict:
+    """!
+    @brief Read a status JSON, such as one written by a worker.
+    @param file_path The status file.
+    @return The status, or None if it doesn't exist or can't be read yet.
+    """
+    try:
+        with open(file=file_path, mode='r', encoding='utf-8') as status_file:
+            return json.load(status_file)
+    except (OSError, ValueError):
+        return None
+
+
+def format_prometheus(status: Dict, labels: Dict[str, str]) -> str:
+    """!
+    @brief Format a status in the Prometheus text exposition format.
+    @param status The status, as from @ref StatusReporter.snapshot.
+    @param labels The labels to add to every sample.
+    @return The text, ending in a newline.
+    """
+    label_text = ','.join(F'{name}="{_escape_label(value)}"' for name, value in labels.items())
+    frames = status['frames']
+    gauges = [
+        ('frames_done', 'Images finished so far.', frames['done']),
+        ('frames_total', 'Images this run makes.', frames['total']),
+        ('frames_per_second', 'Images finished per second so far.', frames['per_second']),
+        ('running', 'Whether the run is still going.', int(status['state'] == 'running')),
+        ('workers', 'Workers started by this run.', len(status['assignment']['workers'])),
+        ('updated_timestamp_seconds', 'When this status was written.', status['updated'])
+    ]
+    lines = []
+    for name, description, value in gauges:
+        lines += [F'# HELP {_METRIC_PREFIX}_{name} {description}',
+                  F'# TYPE {_METRIC_PREFIX}_{name} gauge',
+                  F'{_METRIC_PREFIX}_{name}{{{label_text}}} {value}']
+    lines += [F'# HELP {_METRIC_PREFIX}_errors_total Errors so far, including failed workers.',
+              F'# TYPE {_METRIC_PREFIX}_errors_total counter',
+              F'{_METRIC_PREFIX}_errors_total{{{label_text}}} {status["errors"]}']
+    name = F'{_METRIC_PREFIX}_stage_seconds'
+    lines += [F'# HELP {name} How long each stage of making the images took.',
+              F'# TYPE {name} histogram']
+    for stage, histogram in sorted(status['stages'].items()):
+        stage_labels = ','.join(filter(None, [label_text, F'stage="{_escape_label(stage)}"']))
+        for bound, count in zip(LATENCY_BUCKETS, histogram['buckets']):
+            lines.append(F'{name}_bucket{{{stage_labels},le="{bound}"}} {count}')
+        lines += [F'{name}_bucket{{{stage_labels},le="+Inf"}} {histogram["count"]}',
+                  F'{name}_sum{{{stage_labels}}} {histogram["sum"]}',
+                  F'{name}_count{{{stage_labels}}} {histogram["count"]}']
+    return '\n'.join(lines) + '\n'
+
+
+def _add_histograms(histograms: Dict[str, Dict], other: Dict[str, Dict]) -> None:
+    """!
+    @brief Add one set of stage histograms, with the same buckets, into another.
+    @param histograms The histograms to add to, keyed by stage name. This is updated in place.
+    @param other The histograms to add, keyed by stage name.
+    @return None
+    """
+    for stage, histogram in other.items():
+        if stage not in histograms:
+            histograms[stage] = {'count': 0, 'sum': 0.0, 'buckets': [0] * len(LATENCY_BUCKETS)}
+        histograms[stage]['count'] += histogram['count']
+        histograms[stage]['sum'] += histogram['sum']
+        histograms[stage]['buckets'] = [
+            count + other_count
+            for count, other_count in zip(histograms[stage]['buckets'], histogram['buckets'])]
+
+
+def _escape_label(value: str) -> str:
+    """!
+    @brief Escape a Prometheus label value.
+    @param value The value.
+    @return The value with backslashes, quotes, and newlines escaped.
+    """
+    return str(value).replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n')
+
+
+def _replace_file(file_path: str, text: str) -> None:
+    """!
+    @brief Write a text file next to its destination, then rename it into place.
+    @param file_path The destination.
+    @param text The contents.
+    @return None
+    """
+    temporary_path = file_path + '.tmp'
+    with open(file=temporary_path, mode='w', encoding='utf-8') as temporary_file:
+        temporary_file.write(text)
+    os.replace(temporary_path, file_path)
@@ -0,0 +1,71 @@
+"""!
+@brief This module provides the runner that renders every variant of a parameter sweep in one
+Blender process.
+"""
+import json
+import os
+import time
+from typing import List
+from ground_texture_sim.blender_interface import restore_scene_state, save_scene_state
+from ground_texture_sim.configuration_loader import load_sweep, replace_parameter_file
+from ground_texture_sim.script_runner import GroundTextureSim
+
+
+class SweepRunner:
+    """!
+    @brief A class that runs a configuration, or each variant of its sweep in turn.
+
+    Every variant runs in this process, so the scene, its textures, and the compiled render kernels
+    are only loaded once. Each variant still gets its own simulator, with its own cameras, namers,
+    and writers, and the scene settings each variant changes are put back before the next, so each
+    runs exactly as if it were run on its own. Each variant's configuration is saved next
+    to its output folder, and *output*/sweep.json lists every variant, so a variant can be rerun on
+    its own, such as with --merge after a multi-node run.
+    """
+
+    def __init__(self, args: List[str]) -> None:
+        """!
+        @brief Read the configuration and expand its sweep.
+        @param args The command line arguments specified by the user. Generally, this is the result
+        of sys.argv
+        """
+        ## The command line arguments specified by the user.
+        self._args = args
+        ## The values each variant sets and its whole configuration. Empty without a sweep.
+        self._variants = load_sweep(args)
+
+    def run(self) -> None:
+        """!
+        @brief Run the configuration, or every variant of its sweep in order.
+
+        A failed variant stops the sweep, since the rest likely share its problem. The variants
+        already finished are kept.
+
+        @return None
+        """
+        if len(self._variants) == 0:
+            GroundTextureSim(self._args).run()
+            return
+        # Every variant's output is inside the base output, so its parent holds the sweep's files.
+        sweep_directory = os.path.dirname(self._variants[0][1]['output'])
+        os.makedirs(sweep_directory, exist_ok=True)
+        manifest = []
+        for overrides, variant in self._variants:
+            variant_path = variant['output'] + '.json'
+            with open(file=variant_path, mode='w', encoding='utf-8') as variant_file:
+                json.dump(variant, fp=variant_file, indent=2)
+            manifest.append({'output': variant['output'], 'config': variant_path,
+                             'overrides': overrides})
+        with open(file=os.path.join(sweep_directory, 'sweep.json'), mode='w',
+                  encoding='utf-8') as manifest_file:
+            json.dump(manifest, fp=manifest_file, indent=2)
+        for number, entry in enumerate(manifest):
+            print(F'Starting sweep variant {number + 1} of {len(manifest)}: {entry["overrides"]}')
+            start_time = time.perf_counter()
+            scene_state = save_scene_state()
+            try:
+                GroundTextureSim(replace_parameter_file(self._args, entry['config'])).run()
+            finally:
+                restore_scene_state(scene_state)
+            print(F'Finished sweep variant {number + 1} in '
+                  F'{time.perf_counter() - start_time:0.2f} seconds')
@@ -2,9 +2,11 @@
 This module tests the blender_interface module.
 """
 import unittest
+from types import SimpleNamespace
 from unittest.mock import MagicMock, patch
 import numpy
-from ground_texture_sim.blender_interface import BlenderInterface
+from ground_texture_sim.blender_interface import BlenderInterface, create_orthographic_camera, \
+    remove_orthographic_camera, restore_scene_state, save_scene_state, warm_up_renderer
 
 
 class TestBlenderInterface(unittest.TestCase):
@@ -61,6 +63,273 @@ class TestBlenderInterface(unittest.TestCase):
             self.assertEqual(interface.camera_name, 'c55',
                              msg='Camera name not correctly set.')
 
+    def test_configure_device(self) -> None:
+        """!
+        @brief Tests that only the requested GPUs are enabled, and missing ones raise an error.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context:
+            mock.cameras = MagicMock()
+            mock.cameras.keys = MagicMock()
+            mock.cameras.keys.return_value = ['Camera']
+            preferences = mock_context.preferences.addons.__getitem__.return_value.preferences
+            preferences.bl_rna.properties.__getitem__.return_value.enum_items.keys.return_value = \
+                ['NONE', 'CUDA', 'OPTIX']
+            devices = []
+            for name, device_type in [('CPU', 'CPU'), ('GPU 0', 'CUDA'), ('GPU 1', 'CUDA')]:
+                device = MagicMock()
+                device.name = name
+                device.type = device_type
+                devices.append(device)
+            preferences.devices = devices
+            interface = BlenderInterface()
+            self.assertListEqual(interface.available_devices('CUDA'), ['GPU 0', 'GPU 1'],
+                                 msg='Wrong devices found.')
+            interface.configure_device('CUDA', [1])
+            self.assertEqual(preferences.compute_device_type, 'CUDA', msg='Type not set.')
+            self.assertListEqual([device.use for device in devices], [False, False, True],
+                                 msg='Wrong devices enabled.')
+            self.assertEqual(mock_context.scene.cycles.device, 'GPU', msg='GPU not used.')
+            interface.configure_device('CUDA')
+            self.assertListEqual([device.use for device in devices], [False, True, True],
+                                 msg='Every device of the type not enabled.')
+            with self.assertRaises(RuntimeError, msg='Missing device not rejected.'):
+                interface.configure_device('CUDA', [2])
+            with self.assertRaises(RuntimeError, msg='Unsupported type not rejected.'):
+                interface.configure_device('HIP')
+            interface.configure_device('CPU')
+            self.assertEqual(mock_context.scene.cycles.device, 'CPU', msg='CPU not used.')
+
+    def test_configure_output(self) -> None:
+        """!
+        @brief Tests that the output format is applied to the scene, and unsupported ones rejected.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context, \
+                patch(target='bpy.types') as mock_types:
+            mock.cameras = MagicMock()
+            mock.cameras.keys = MagicMock()
+            mock.cameras.keys.return_value = ['Camera']
+            mock_types.ImageFormatSettings.bl_rna.properties.__getitem__.return_value.enum_items.\
+                keys.return_value = ['PNG', 'TIFF', 'OPEN_EXR']
+            image_settings = mock_context.scene.render.image_settings
+            interface = BlenderInterface()
+            interface.configure_output('PNG', '16', 9)
+            self.assertEqual(image_settings.file_format, 'PNG', msg='Format not set.')
+            self.assertEqual(image_settings.color_depth, '16', msg='Color depth not set.')
+            self.assertEqual(image_settings.compression, 100, msg='Compression not set.')
+            interface.configure_output('TIFF')
+            self.assertEqual(image_settings.file_format, 'TIFF', msg='Format not set.')
+            self.assertEqual(image_settings.tiff_codec, 'NONE', msg='TIFF is not uncompressed.')
+            self.assertEqual(image_settings.color_depth, '16', msg='Unset depth was changed.')
+            with self.assertRaises(RuntimeError, msg='Unsupported format not rejected.'):
+                interface.configure_output('WEBP')
+
+    def test_configure_quality(self) -> None:
+        """!
+        @brief Tests that quality settings are applied to Cycles, and rejected for other engines.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context:
+            mock.cameras = MagicMock()
+            mock.cameras.keys = MagicMock()
+            mock.cameras.keys.return_value = ['Camera']
+            scene = mock_context.scene
+            scene.render.engine = 'CYCLES'
+            interface = BlenderInterface()
+            interface.configure_quality(noise_threshold=0.02, max_samples=64, time_limit=1.5,
+                                        denoise=True)
+            self.assertTrue(scene.cycles.use_adaptive_sampling, msg='Adaptive sampling not on.')
+            self.assertEqual(scene.cycles.adaptive_threshold, 0.02, msg='Threshold not set.')
+            self.assertEqual(scene.cycles.samples, 64, msg='Samples not set.')
+            self.assertEqual(scene.cycles.time_limit, 1.5, msg='Time limit not set.')
+            self.assertTrue(scene.cycles.use_denoising, msg='Denoising not on.')
+            self.assertEqual(scene.cycles.denoiser, 'OPENIMAGEDENOISE', msg='Wrong denoiser.')
+            scene.render.engine = 'BLENDER_EEVEE'
+            # Leaving everything unset is fine for any engine.
+            interface.configure_quality()
+            with self.assertRaises(RuntimeError, msg='Non Cycles engine not rejected.'):
+                interface.configure_quality(max_samples=64)
+
+    def test_configure_motion_blur(self) -> None:
+        """!
+        @brief Tests that the shutter is applied, and a rolling shutter rejected outside Cycles.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context:
+            mock.cameras.keys.return_value = ['Camera']
+            scene = mock_context.scene
+            scene.render.engine = 'CYCLES'
+            scene.render.use_motion_blur = False
+            interface = BlenderInterface()
+            interface.configure_motion_blur()
+            self.assertFalse(scene.render.use_motion_blur, msg='Blender setting not kept.')
+            interface.configure_motion_blur(0.5, 0.25)
+            self.assertTrue(scene.render.use_motion_blur, msg='Motion blur not on.')
+            self.assertEqual(scene.render.motion_blur_shutter, 0.5, msg='Shutter not set.')
+            self.assertEqual(scene.cycles.rolling_shutter_type, 'TOP',
+                             msg='Rolling shutter not on.')
+            self.assertEqual(scene.cycles.rolling_shutter_duration, 0.25,
+                             msg='Rolling shutter duration not set.')
+            scene.render.engine = 'BLENDER_EEVEE'
+            interface.configure_motion_blur(0.5)
+            with self.assertRaises(RuntimeError, msg='Non Cycles rolling shutter not rejected.'):
+                interface.configure_motion_blur(0.5, 0.25)
+
+    def test_create_worker_command(self) -> None:
+        """!
+        @brief Tests that worker commands load the same scene and pass along the script arguments.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.app') as mock_app:
+            mock.cameras = MagicMock()
+            mock.cameras.keys = MagicMock()
+            mock.cameras.keys.return_value = ['Camera']
+            mock.filepath = '/scenes/environment.blend'
+            mock_app.binary_path = '/usr/bin/blender'
+            interface = BlenderInterface()
+            command = interface.create_worker_command(['config.json', '--start', '0'])
+            self.assertEqual(command[0], '/usr/bin/blender', msg='Wrong Blender executable.')
+            self.assertEqual(command[1], '/scenes/environment.blend', msg='Wrong scene loaded.')
+            self.assertIn('--background', command, msg='Worker is not headless.')
+            self.assertListEqual(command[-4:], ['--', 'config.json', '--start', '0'],
+                                 msg='Script arguments not passed along.')
+            # Unsaved scenes can't be reloaded by the workers.
+            mock.filepath = ''
+            with self.assertRaises(RuntimeError, msg='Unsaved scene does not raise error.'):
+                interface.create_worker_command(['config.json'])
+
+    def test_png_compression_level(self) -> None:
+        """!
+        @brief Tests that PNG compression levels round trip through Blender's percentage.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context:
+            mock.cameras = MagicMock()
+            mock.cameras.keys = MagicMock()
+            mock.cameras.keys.return_value = ['Camera']
+            interface = BlenderInterface()
+            for level in range(10):
+                interface.png_compression_level = level
+                self.assertEqual(interface.png_compression_level, level,
+                                 msg=F'Level {level} does not round trip.')
+            mock_context.scene.render.image_settings.compression = 15
+            self.assertEqual(interface.png_compression_level, 1,
+                             msg='Percentage not mapped to the zlib level Blender uses.')
+            with self.assertRaises(ValueError, msg='Out of range level not rejected.'):
+                interface.png_compression_level = 10
+
+    def test_place_moving_camera(self) -> None:
+        """!
+        @brief Tests that the neighboring poses are keyframed around the current one, linearly, and
+        can be cleared.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context, \
+                patch(target='mathutils.Matrix'), patch(target='mathutils.Euler'):
+            mock.cameras.keys.return_value = ['Camera']
+            camera = mock.objects.__getitem__.return_value
+            keyframe = MagicMock()
+            fcurve = MagicMock()
+            fcurve.keyframe_points = [keyframe]
+            camera.animation_data.action.fcurves = [fcurve]
+            interface = BlenderInterface()
+            interface.place_moving_camera(numpy.identity(4), numpy.identity(4), numpy.identity(4))
+            for frame in range(3):
+                camera.keyframe_insert.assert_any_call(data_path='location', frame=frame)
+                camera.keyframe_insert.assert_any_call(data_path='rotation_euler', frame=frame)
+            self.assertEqual(camera.rotation_euler.make_compatible.call_count, 2,
+                             msg='Neighboring angles not kept compatible.')
+            self.assertEqual(keyframe.interpolation, 'LINEAR', msg='Motion not linear.')
+            mock_context.scene.frame_set.assert_called_once_with(1)
+            camera.animation_data_clear.reset_mock()
+            interface.clear_motion()
+            camera.animation_data_clear.assert_called_once()
+
+    def test_render_animation(self) -> None:
+        """!
+        @brief Tests that each pose is keyframed and rendered in one animation job, and the scene
+        is put back afterwards.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context, \
+                patch(target='bpy.ops') as mock_ops, patch(target='mathutils.Matrix'), \
+                patch(target='mathutils.Euler'):
+            mock.cameras.keys.return_value = ['Camera']
+            scene = mock_context.scene
+            scene.frame_start, scene.frame_end, scene.frame_current = 5, 50, 7
+            scene.render.filepath = '/original/'
+            scene.render.use_persistent_data = False
+            scene.render.frame_path.side_effect = lambda frame: F'/staging/frame_{frame:07d}.png'
+            camera = mock.objects.__getitem__.return_value
+            interface = BlenderInterface()
+            frame_paths = interface.render_animation(
+                '/staging/frame_#######', numpy.stack([numpy.identity(4)] * 3))
+            self.assertListEqual(frame_paths, [F'/staging/frame_{frame:07d}.png'
+                                               for frame in range(1, 4)],
+                                 msg='Wrong frame paths.')
+            self.assertEqual(camera.keyframe_insert.call_count, 6, msg='Poses not keyframed.')
+            camera.keyframe_insert.assert_any_call(data_path='rotation_euler', frame=3)
+            mock_ops.render.render.assert_called_once_with(animation=True)
+            self.assertEqual(camera.animation_data_clear.call_count, 2,
+                             msg='Keyframes not removed.')
+            self.assertTupleEqual((scene.frame_start, scene.frame_end, scene.frame_current,
+                                   scene.render.filepath, scene.render.use_persistent_data),
+                                  (5, 50, 7, '/original/', False), msg='Scene not put back.')
+            with self.assertRaises(ValueError, msg='Relative path does not raise error.'):
+                interface.render_animation('frame_#######', numpy.stack([numpy.identity(4)]))
+
+    def test_render_resolution(self) -> None:
+        """!
+        @brief Tests that the render resolution can be read and restored as one tuple.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context:
+            mock.cameras.keys.return_value = ['Camera']
+            render = mock_context.scene.render
+            render.resolution_x, render.resolution_y, render.resolution_percentage = 1920, 1080, 50
+            interface = BlenderInterface()
+            self.assertTupleEqual(interface.render_resolution, (1920, 1080, 50),
+                                  msg='Resolution not read.')
+            interface.render_resolution = (256, 256, 100)
+            self.assertTupleEqual((render.resolution_x, render.resolution_y,
+                                   render.resolution_percentage), (256, 256, 100),
+                                  msg='Resolution not set.')
+
+    def test_generate_image(self) -> None:
+        """!
+        @brief Tests that generate_image places the camera once and renders to the given path.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context, \
+                patch(target='bpy.ops') as mock_ops, \
+                patch(target='mathutils.Matrix') as mock_matrix, \
+                patch(target='mathutils.Euler') as mock_euler:
+            mock.cameras = MagicMock()
+            mock.cameras.keys = MagicMock()
+            mock.cameras.keys.return_value = ['Camera']
+            interface = BlenderInterface()
+            camera_pose = numpy.identity(4)
+            interface.generate_image('/output/image.png', camera_pose)
+            mock_matrix.assert_called_once_with(camera_pose.tolist())
+            placement = mock_matrix.return_value.__matmul__.return_value
+            camera = mock.objects.__getitem__.return_value
+            mock.objects.__getitem__.assert_called_with('Camera')
+            self.assertEqual(camera.location, placement.to_translation.return_value,
+                             msg='Camera location not set.')
+            self.assertEqual(camera.rotation_euler, placement.to_euler.return_value,
+                             msg='Camera rotation not set.')
+            placement.to_euler.assert_called_once_with('XYZ')
+            # The adjustment is only built once, no matter how many images are rendered.
+            interface.generate_image('/output/image.png', camera_pose)
+            mock_euler.assert_called_once()
+            self.assertEqual(mock_context.scene.render.filepath, '/output/image.png',
+                             msg='Render path not set.')
+            self.assertEqual(mock_context.scene.camera, camera,
+                             msg='Camera not made the active camera.')
+            mock_ops.render.render.assert_called_with(write_still=True)
+            self.assertEqual(mock_ops.render.render.call_count, 2, msg='Wrong render count.')
+
     def test_generate_image_relative_path_error(self) -> None:
         """!
         @brief Tests that the generate_image function raises an exception if the image path is not
@@ -77,5 +346,118 @@ class TestBlenderInterface(unittest.TestCase):
                     'relative_path/image.png', numpy.identity(4))
 
 
+class TestCreateOrthographicCamera(unittest.TestCase):
+    """!
+    Tests the create_orthographic_camera function.
+    """
+
+    def test_create_and_update(self) -> None:
+        """!
+        @brief Tests that a missing camera is added to the scene, and an existing one reused.
+        @return None
+        """
+        with patch(target='bpy.data') as mock, patch(target='bpy.context') as mock_context:
+            mock.objects.keys.return_value = []
+            create_orthographic_camera('Mosaic', 2.0)
+            mock.cameras.new.assert_called_once_with('Mosaic')
+            camera = mock.objects.new.return_value
+            mock_context.scene.collection.objects.link.assert_called_once_with(camera)
+            self.assertEqual(camera.data.type, 'ORTHO', msg='Camera not orthographic.')
+            self.assertEqual(camera.data.ortho_scale, 2.0, msg='Scale not set.')
+            mock.objects.keys.return_value = ['Mosaic']
+            create_orthographic_camera('Mosaic', 3.0)
+            mock.objects.new.assert_called_once()
+            self.assertEqual(mock.objects.__getitem__.return_value.data.ortho_scale, 3.0,
+                             msg='Existing camera not updated.')
+
+    def test_remove(self) -> None:
+        """!
+        @brief Tests that the camera object and its data are deleted, and a missing one ignored.
+        @return None
+        """
+        with patch(target='bpy.data') as mock:
+            mock.objects.keys.return_value = ['Mosaic']
+            mock.cameras.keys.return_value = ['Mosaic']
+            remove_orthographic_camera('Mosaic')
+            mock.objects.remove.assert_called_once_with(mock.objects.__getitem__.return_value,
+                                                        do_unlink=True)
+            mock.cameras.remove.assert_called_once_with(mock.cameras.__getitem__.return_value)
+            mock.objects.keys.return_value = []
+            mock.cameras.keys.return_value = []
+            remove_orthographic_camera('Mosaic')
+            mock.objects.remove.assert_called_once()
+            mock.cameras.remove.assert_called_once()
+
+
+class TestWarmUpRenderer(unittest.TestCase):
+    """!
+    Tests the warm_up_renderer function.
+    """
+
+    def test_warm_up(self) -> None:
+        """!
+        @brief Tests that one unsaved image is rendered, unless there is no camera to render from.
+        @return None
+        """
+        with patch(target='bpy.context') as mock_context, patch(target='bpy.ops') as mock_ops:
+            warm_up_renderer()
+            mock_ops.render.render.assert_called_once_with(write_still=False)
+            mock_ops.render.render.reset_mock()
+            mock_context.scene.camera = None
+            warm_up_renderer()
+            mock_ops.render.render.assert_not_called()
+
+
+class TestSceneState(unittest.TestCase):
+    """!
+    Tests the save_scene_state and restore_scene_state functions.
+    """
+
+    def test_restore(self) -> None:
+        """!
+        @brief Tests that changed settings, devices, and image files are put back, that settings
+        this version of Blender lacks are skipped, and that unchanged settings are left alone.
+        @return None
+        """
+        # A version of Blender without a per frame time limit.
+        cycles = SimpleNamespace(samples=64, use_denoising=False, device='CPU')
+        scene = SimpleNamespace(cycles=cycles, render=SimpleNamespace(
+            use_motion_blur=False, image_settings=SimpleNamespace(color_depth='8',
+                                                                  compression=15)))
+        device = SimpleNamespace(type='CUDA', name='GPU 0', use=False)
+        preferences = SimpleNamespace(compute_device_type='NONE', devices=[device])
+        context = SimpleNamespace(scene=scene, preferences=SimpleNamespace(
+            addons={'cycles': SimpleNamespace(preferences=preferences)}))
+        texture = SimpleNamespace(name='texture', filepath='//texture.jpg')
+        unchanged = SimpleNamespace(name='unchanged', filepath='//unchanged.jpg')
+        with patch(target='bpy.context', new=context), \
+                patch(target='bpy.data', new=SimpleNamespace(images=[texture, unchanged])):
+            state = save_scene_state()
+            self.assertNotIn('cycles.time_limit', state['scene'], msg='Missing setting saved.')
+            cycles.samples = 512
+            cycles.use_denoising = True
+            cycles.device = 'GPU'
+            scene.render.use_motion_blur = True
+            scene.render.image_settings.color_depth = '16'
+            preferences.compute_device_type = 'CUDA'
+            device.use = True
+            texture.filepath = '/cache/texture.png'
+            restore_scene_state(state)
+        self.assertEqual(cycles.samples, 64, msg='Samples not restored.')
+        self.assertFalse(cycles.use_denoising, msg='Denoising not restored.')
+        self.assertEqual(cycles.device, 'CPU', msg='Device not restored.')
+        self.assertFalse(scene.render.use_motion_blur, msg='Motion blur not restored.')
+        self.assertEqual(scene.render.image_settings.color_depth, '8',
+                         msg='Color depth not restored.')
+        self.assertEqual(scene.render.image_settings.compression, 15,
+                         msg='Unchanged setting changed.')
+        self.assertEqual(preferences.compute_device_type, 'NONE',
+                         msg='Compute device type not restored.')
+        self.assertFalse(device.use, msg='Device use not restored.')
+        self.assertEqual(texture.filepath, '//texture.jpg', msg='Texture not restored.')
+        self.assertEqual(unchanged.filepath, '//unchanged.jpg', msg='Unchanged texture changed.')
+        self.assertFalse(hasattr(cycles, 'time_limit'), msg='Missing setting added.')
+
+
 if __name__ == '__main__':  # pragma: no cover
     unittest.main()
@@ -1,11 +1,31 @@
 """!
 @brief This module tests the configuration_loader module.
 """
+import datetime
 import json
+import os
+import tempfile
 import unittest
 from typing import Dict
 from unittest.mock import mock_open, patch
-from ground_texture_sim.configuration_loader import _load_config, _load_trajectory, _parse_args
+import numpy
+from ground_texture_sim.configuration_loader import _check_range, _expand_sweep, _load_config, \
+    _load_trajectory, _parse_args, collection_date_file, pin_collection_date, \
+    replace_parameter_file
+
+
+class _LaterDate(datetime.date):
+    """!
+    @brief A date whose today is a few days after the sequence was first collected.
+    """
+
+    @classmethod
+    def today(cls) -> '_LaterDate':
+        """!
+        @brief Get a fixed later date.
+        @return The date.
+        """
+        return cls(2026, 10, 17)
 
 
 class TestLoadConfig(unittest.TestCase):
@@ -38,6 +58,77 @@ class TestLoadConfig(unittest.TestCase):
             result['camera']['roll'] = 0.0
             result['camera']['pitch'] = 1.5708
             result['camera']['yaw'] = 0.0
+            result['sequence']['date'] = None
+            result['execution'] = {
+                'workers': 1,
+                'resume': False,
+                'pipeline': False,
+                'queue_size': 8,
+                'batch_size': 1,
+                'timing': False,
+                'start_index': None,
+                'end_index': None
+            }
+            result['lists'] = {
+                'flush_interval': 100,
+                'pose_records': False
+            }
+            result['image'] = {
+                'format': 'PNG',
+                'color_depth': None,
+                'compression': None
+            }
+            result['device'] = {
+                'type': None,
+                'indices': None
+            }
+            result['render'] = {
+                'noise_threshold': None,
+                'min_samples': None,
+                'max_samples': None,
+                'time_limit': None,
+                'denoise': None,
+                'backend': 'blender'
+            }
+            result['deduplicate'] = {
+                'pixel_tolerance': None,
+                'yaw_tolerance': 0.001,
+                'method': 'link'
+            }
+            result['mosaic'] = {
+                'x_min': None,
+                'y_min': None,
+                'x_max': None,
+                'y_max': None,
+                'tile_size': 1024,
+                'compress': True
+            }
+            result['dry_run'] = {
+                'cell_size': None,
+                'min_overlap': 0.3
+            }
+            result['motion_blur'] = {
+                'shutter': None,
+                'rolling_shutter': None
+            }
+            result['pyramid'] = {
+                'factors': []
+            }
+            result['shards'] = {
+                'images_per_shard': None
+            }
+            result['status'] = {
+                'interval': None,
+                'prometheus': False
+            }
+            result['textures'] = {
+                'cache': None,
+                'max_size': None
+            }
+            result['preview'] = {
+                'ground': 'Ground',
+                'texture': None
+            }
         return result
 
     def _dict_to_string(self, input_dict: Dict) -> str:
@@ -48,6 +139,364 @@ class TestLoadConfig(unittest.TestCase):
         """
         return json.dumps(input_dict, indent=4)
 
+    def test_deduplicate_settings(self) -> None:
+        """!
+        @brief Test the loader validates the deduplication tolerances and method.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['deduplicate'] = {'pixel_tolerance': 1, 'method': 'copy'}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertDictEqual(result['deduplicate'], {
+                'pixel_tolerance': 1.0, 'yaw_tolerance': 0.001, 'method': 'copy'})
+        bad_settings = [
+            ({'pixel_tolerance': 'blah'}, TypeError),
+            ({'pixel_tolerance': 0}, ValueError),
+            ({'yaw_tolerance': None}, TypeError),
+            ({'yaw_tolerance': -1}, ValueError),
+            ({'method': 'move'}, ValueError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict['deduplicate'] = bad_setting
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_dry_run_settings(self) -> None:
+        """!
+        @brief Test the loader validates the dry run cell size and minimum overlap.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['dry_run'] = {'cell_size': 1}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertDictEqual(result['dry_run'], {'cell_size': 1.0, 'min_overlap': 0.3})
+        bad_settings = [
+            ({'cell_size': 'blah'}, TypeError),
+            ({'cell_size': 0}, ValueError),
+            ({'min_overlap': None}, TypeError),
+            ({'min_overlap': 1.5}, ValueError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict['dry_run'] = bad_setting
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_device_settings(self) -> None:
+        """!
+        @brief Test the loader validates the device type and indices.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['device'] = {'type': 'OPTIX', 'indices': [1, 0]}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertListEqual(result['device']['indices'], [1, 0])
+        bad_settings = [
+            ({'type': 'GPU', 'indices': None}, ValueError),
+            ({'type': 'CPU', 'indices': [0]}, ValueError),
+            ({'type': None, 'indices': [0]}, ValueError),
+            ({'type': 'CUDA', 'indices': [0, 0]}, ValueError),
+            ({'type': 'CUDA', 'indices': []}, TypeError),
+            ({'type': 'CUDA', 'indices': [-1]}, TypeError),
+            ({'type': 'CUDA', 'indices': 0}, TypeError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict['device'] = bad_setting
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_flush_interval_is_positive_number(self) -> None:
+        """!
+        @brief Test the loader verifies the list flush interval is a positive integer.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['lists']['flush_interval'] = 'blah'
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(TypeError, _load_config, 'config.json')
+        input_dict['lists']['flush_interval'] = 0
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(ValueError, _load_config, 'config.json')
+
+    def test_pose_records_is_bool(self) -> None:
+        """!
+        @brief Test the loader verifies the pose records setting is true or false.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['lists']['pose_records'] = 'yes'
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(TypeError, _load_config, 'config.json')
+
+    def test_image_settings(self) -> None:
+        """!
+        @brief Test the loader validates the image format, color depth, and compression.
+        @return None
+        """
+        # Valid settings are kept, with the depth normalized to a string like Blender uses.
+        input_dict = self._create_correct_config(True)
+        input_dict['image'] = {'format': 'TIFF', 'color_depth': 16, 'compression': None}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertEqual(result['image']['color_depth'], '16')
+        # Each bad setting is rejected.
+        bad_settings = [
+            {'format': 'JPEG', 'color_depth': None, 'compression': None},
+            {'format': 'WEBP', 'color_depth': '16', 'compression': None},
+            {'format': 'OPEN_EXR', 'color_depth': None, 'compression': 5},
+            {'format': 'PNG', 'color_depth': None, 'compression': 10}
+        ]
+        for bad_setting in bad_settings:
+            input_dict['image'] = bad_setting
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(ValueError, _load_config, 'config.json')
+        input_dict['image'] = {'format': 'PNG', 'color_depth': None, 'compression': 'blah'}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(TypeError, _load_config, 'config.json')
+
+    def test_mosaic_settings(self) -> None:
+        """!
+        @brief Test the loader validates the mosaic area, tile size, and compression.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['mosaic'].update({'x_min': -1, 'y_min': -2, 'x_max': 1, 'y_max': 2})
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertEqual(result['mosaic']['x_min'], -1.0)
+            self.assertIsInstance(result['mosaic']['x_min'], float)
+        bad_settings = [
+            ({'x_min': 0.0}, TypeError),
+            ({'x_max': -2.0}, ValueError),
+            ({'y_max': -2.0}, ValueError),
+            ({'tile_size': 'blah'}, TypeError),
+            ({'tile_size': 100}, ValueError),
+            ({'tile_size': 0}, ValueError),
+            ({'compress': 1}, TypeError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict = self._create_correct_config(True)
+            if 'x_min' not in bad_setting:
+                input_dict['mosaic'].update({'x_min': -1, 'y_min': -2, 'x_max': 1, 'y_max': 2})
+            input_dict['mosaic'].update(bad_setting)
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_motion_blur_settings(self) -> None:
+        """!
+        @brief Test the loader validates the shutter, and rejects settings it can't work with.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['motion_blur'] = {'shutter': '0.5', 'rolling_shutter': 0}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertDictEqual(result['motion_blur'], {'shutter': 0.5, 'rolling_shutter': 0.0})
+        bad_settings = [
+            ({'shutter': 'blah'}, {}, TypeError),
+            ({'shutter': 0}, {}, ValueError),
+            ({'shutter': 1.5}, {}, ValueError),
+            ({'rolling_shutter': 0.5}, {}, ValueError),
+            ({'shutter': 0.5, 'rolling_shutter': 2}, {}, ValueError),
+            ({'shutter': 0.5}, {'execution': {'batch_size': 4}}, ValueError),
+            ({'shutter': 0.5}, {'deduplicate': {'pixel_tolerance': 1}}, ValueError)
+        ]
+        for bad_setting, other_settings, error in bad_settings:
+            input_dict = self._create_correct_config(True)
+            input_dict['motion_blur'] = bad_setting
+            for key, value in other_settings.items():
+                input_dict[key].update(value)
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_pyramid_settings(self) -> None:
+        """!
+        @brief Test the loader validates the pyramid factors and requires PNG images.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['pyramid'] = {'factors': [2, 4]}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertListEqual(result['pyramid']['factors'], [2, 4])
+        bad_settings = [
+            ({'factors': 2}, {}, TypeError),
+            ({'factors': [2.0]}, {}, TypeError),
+            ({'factors': [1]}, {}, ValueError),
+            ({'factors': [2, 2]}, {}, ValueError),
+            ({'factors': [2]}, {'image': {'format': 'TIFF'}}, ValueError)
+        ]
+        for bad_setting, other_settings, error in bad_settings:
+            input_dict = self._create_correct_config(True)
+            input_dict['pyramid'] = bad_setting
+            for key, value in other_settings.items():
+                input_dict[key].update(value)
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_shard_settings(self) -> None:
+        """!
+        @brief Test the loader validates the shard size and rejects resuming into shards.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['shards'] = {'images_per_shard': 1000}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertEqual(result['shards']['images_per_shard'], 1000)
+        bad_settings = [
+            ({'images_per_shard': '1000'}, {}, TypeError),
+            ({'images_per_shard': 0}, {}, ValueError),
+            ({'images_per_shard': 1000}, {'execution': {'resume': True}}, ValueError)
+        ]
+        for bad_setting, other_settings, error in bad_settings:
+            input_dict = self._create_correct_config(True)
+            input_dict['shards'] = bad_setting
+            for key, value in other_settings.items():
+                input_dict[key].update(value)
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_status_settings(self) -> None:
+        """!
+        @brief Test the loader validates the status interval and Prometheus switch.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['status'] = {'interval': 10, 'prometheus': True}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertDictEqual(result['status'], {'interval': 10.0, 'prometheus': True})
+            self.assertIsInstance(result['status']['interval'], float)
+        bad_settings = [
+            ({'interval': 'often'}, TypeError),
+            ({'interval': 0}, ValueError),
+            ({'interval': 10, 'prometheus': 'yes'}, TypeError),
+            ({'prometheus': True}, ValueError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict['status'] = bad_setting
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_texture_settings(self) -> None:
+        """!
+        @brief Test the loader validates the texture cache and its maximum size.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['textures'] = {'cache': '/cache/textures', 'max_size': 4096}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertDictEqual(result['textures'], {'cache': '/cache/textures',
+                                                      'max_size': 4096})
+        bad_settings = [
+            ({'cache': 3}, TypeError),
+            ({'cache': '/cache/textures', 'max_size': '4096'}, TypeError),
+            ({'cache': '/cache/textures', 'max_size': 0}, ValueError),
+            ({'max_size': 4096}, ValueError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict['textures'] = bad_setting
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_preview_settings(self) -> None:
+        """!
+        @brief Test the loader validates the backend and preview settings, and rejects previews of
+        images they can't make.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['render'] = {'backend': 'preview'}
+        input_dict['preview'] = {'texture': '/textures/floor.png'}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertEqual(result['render']['backend'], 'preview')
+            self.assertDictEqual(result['preview'], {'ground': 'Ground',
+                                                     'texture': '/textures/floor.png'})
+        bad_settings = [
+            ({'render': {'backend': 'eevee'}}, ValueError),
+            ({'preview': {'ground': 3}}, TypeError),
+            ({'preview': {'texture': True}}, TypeError),
+            ({'render': {'backend': 'preview'}, 'image': {'format': 'TIFF'}}, ValueError),
+            ({'render': {'backend': 'preview'}, 'pyramid': {'factors': [2]}}, ValueError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict = self._create_correct_config(True)
+            for key, value in bad_setting.items():
+                input_dict[key].update(value)
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_reject_sweep(self) -> None:
+        """!
+        @brief Test the loader rejects a sweep, which only the sweep runner can expand.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['sweep'] = {'camera/z': [0.2, 0.3]}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(ValueError, _load_config, 'config.json')
+
+    def test_multiple_cameras(self) -> None:
+        """!
+        @brief Test that a list of cameras is filled in per camera and that names must be unique.
+        @return None
+        """
+        input_dict = self._create_correct_config(False)
+        input_dict['camera'] = [{'name': 'Left', 'y': 0.1}, {'name': 'Right', 'y': -0.1}]
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+        self.assertListEqual([camera['name'] for camera in result['camera']], ['Left', 'Right'],
+                             msg='Camera order not kept.')
+        self.assertListEqual([camera['y'] for camera in result['camera']], [0.1, -0.1],
+                             msg='Camera values not kept.')
+        self.assertEqual(result['camera'][1]['pitch'], 1.5708,
+                         msg='Optional camera values not filled in.')
+        input_dict['camera'] = [{'name': 'Left'}, {'name': 'Left'}]
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(ValueError, _load_config, 'config.json')
+        input_dict['camera'] = []
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(TypeError, _load_config, 'config.json')
+        input_dict['camera'] = [{'name': 'Left'}, {'y': 0.1}]
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(KeyError, _load_config, 'config.json')
+
     def test_missing_camera_elements(self) -> None:
         """!
         @brief Test that the camera name must be included in the user provided JSON.
@@ -139,6 +588,8 @@ class TestLoadConfig(unittest.TestCase):
         # Test if no optional values are provided.
         input_dict = self._create_correct_config(False)
         expected_results = self._create_correct_config(True)
+        # A single camera is returned as a list of one.
+        expected_results['camera'] = [expected_results['camera']]
         input_string = self._dict_to_string(input_dict)
         with patch(target='builtins.open', new=mock_open(read_data=input_string)):
             result = _load_config('config.json')
@@ -146,13 +597,103 @@ class TestLoadConfig(unittest.TestCase):
                                  msg='Optional values not filled in.')
         # Test if only some options are provided
         input_dict['camera']['x'] = 5.0
-        expected_results['camera']['x'] = 5.0
+        expected_results['camera'][0]['x'] = 5.0
         input_string = self._dict_to_string(input_dict)
         with patch(target='builtins.open', new=mock_open(read_data=input_string)):
             result = _load_config('config.json')
             self.assertDictEqual(d1=result, d2=expected_results,
                                  msg='Optional values not filled in.')
 
+    def test_batch_size_is_positive_number(self) -> None:
+        """!
+        @brief Test the loader verifies the animation batch size is a positive integer.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['execution']['batch_size'] = 'blah'
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(TypeError, _load_config, 'config.json')
+        input_dict['execution']['batch_size'] = 0
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(ValueError, _load_config, 'config.json')
+
+    def test_queue_size_is_positive_number(self) -> None:
+        """!
+        @brief Test the loader verifies the pipeline queue size is a positive integer.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['execution']['queue_size'] = 'blah'
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(TypeError, _load_config, 'config.json')
+        input_dict['execution']['queue_size'] = 0
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(ValueError, _load_config, 'config.json')
+
+    def test_range_is_index(self) -> None:
+        """!
+        @brief Test the loader verifies the trajectory range indices are non-negative integers.
+        @return None
+        """
+        for key in ['start_index', 'end_index']:
+            input_dict = self._create_correct_config(True)
+            input_dict['execution'][key] = 'blah'
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(TypeError, _load_config, 'config.json')
+            input_dict['execution'][key] = -1
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(ValueError, _load_config, 'config.json')
+            input_dict['execution'][key] = '5'
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                result = _load_config('config.json')
+                self.assertEqual(result['execution'][key], 5)
+
+    def test_render_settings(self) -> None:
+        """!
+        @brief Test the loader validates the render quality settings.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['render'] = {'noise_threshold': '0.01', 'min_samples': 0, 'max_samples': 256,
+                                'time_limit': 2, 'denoise': True}
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertEqual(result['render']['noise_threshold'], 0.01)
+            self.assertIsInstance(result['render']['time_limit'], float)
+        bad_settings = [
+            ({'noise_threshold': 0}, ValueError),
+            ({'time_limit': -1.0}, ValueError),
+            ({'max_samples': 0}, ValueError),
+            ({'min_samples': -1}, ValueError),
+            ({'max_samples': 'blah'}, TypeError),
+            ({'denoise': 'yes'}, TypeError)
+        ]
+        for bad_setting, error in bad_settings:
+            input_dict['render'] = bad_setting
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+    def test_resume_is_bool(self) -> None:
+        """!
+        @brief Test the loader rejects resume, pipeline, and timing values that are not booleans.
+        @return None
+        """
+        for key in ['resume', 'pipeline', 'timing']:
+            input_dict = self._create_correct_config(True)
+            input_dict['execution'][key] = 'yes'
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(TypeError, _load_config, 'config.json')
+
     def test_sequence_number_is_number(self) -> None:
         """!
         @brief Test the loader verifies the sequence number is an actual number.
@@ -185,9 +726,30 @@ class TestLoadConfig(unittest.TestCase):
         input_string = self._dict_to_string(input_dict)
         with patch(target='builtins.open', new=mock_open(read_data=input_string)):
             result = _load_config('config.json')
+            input_dict['camera'] = [input_dict['camera']]
             self.assertDictEqual(d1=result, d2=input_dict,
                                  msg='Unable to read JSON into Dict')
 
+    def test_workers_is_positive_number(self) -> None:
+        """!
+        @brief Test the loader verifies the worker count is a positive integer.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['execution']['workers'] = 'blah'
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(TypeError, _load_config, 'config.json')
+        input_dict['execution']['workers'] = 0
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            self.assertRaises(ValueError, _load_config, 'config.json')
+        input_dict['execution']['workers'] = '4'
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertEqual(result['execution']['workers'], 4)
+
     def test_texture_number_is_number(self) -> None:
         """!
         @brief Test the loader verifies the sequence number is an actual number.
@@ -211,12 +773,105 @@ class TestLoadConfig(unittest.TestCase):
             result = _load_config('config.json')
             self.assertEqual(result['sequence']['texture_number'], 2)
 
+    def test_sequence_date(self) -> None:
+        """!
+        @brief Test the loader accepts a YYYY-MM-DD collection date, padding it, and rejects
+        others.
+        @return None
+        """
+        input_dict = self._create_correct_config(True)
+        input_dict['sequence']['date'] = '2026-1-5'
+        input_string = self._dict_to_string(input_dict)
+        with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+            result = _load_config('config.json')
+            self.assertEqual(result['sequence']['date'], '2026-01-05', msg='Date not padded.')
+        for bad_date, error in [('2026-13-01', ValueError), ('10/14/2026', ValueError),
+                                (20261014, TypeError)]:
+            input_dict['sequence']['date'] = bad_date
+            input_string = self._dict_to_string(input_dict)
+            with patch(target='builtins.open', new=mock_open(read_data=input_string)):
+                self.assertRaises(error, _load_config, 'config.json')
+
+
+class TestPinCollectionDate(unittest.TestCase):
+    """!
+    @brief This class tests the pin_collection_date function.
+    """
+
+    def test_pinned(self) -> None:
+        """!
+        @brief Test that the first run records today, and later runs on later days read it back.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            output = os.path.join(temp_dir, 'output')
+            first_date = pin_collection_date(output, 'regular', 3)
+            self.assertEqual(first_date, datetime.date.today().isoformat(),
+                             msg='First run not given today.')
+            with patch(target='datetime.date', new=_LaterDate):
+                self.assertEqual(pin_collection_date(output, 'regular', 3), first_date,
+                                 msg='Later run not given the first date.')
+                self.assertEqual(pin_collection_date(output, 'regular', 4), '2026-10-17',
+                                 msg='Another sequence given the first date.')
+            with open(file=os.path.join(output, collection_date_file('regular', 3)), mode='r',
+                      encoding='utf-8') as date_file:
+                self.assertEqual(date_file.read(), first_date + '\n', msg='Date not recorded.')
+
 
 class TestLoadTrajectory(unittest.TestCase):
     """!
     @brief This class tests the read_poses function.
     """
 
+    def test_binary_files(self) -> None:
+        """!
+        @brief This method verifies that .npy and raw .bin files are memory-mapped as Nx3 arrays.
+        @return None
+        """
+        expected_results = numpy.array([[0.0, 0.0, 0.0], [1.0, 2.0, 3.0]])
+        with tempfile.TemporaryDirectory() as directory:
+            npy_path = os.path.join(directory, 'trajectory.npy')
+            numpy.save(npy_path, expected_results)
+            bin_path = os.path.join(directory, 'trajectory.bin')
+            expected_results.astype('<f8').tofile(bin_path)
+            for file_path in [npy_path, bin_path]:
+                results = _load_trajectory(file_path)
+                self.assertIsInstance(results, numpy.memmap, msg='Poses not memory-mapped.')
+                numpy.testing.assert_array_equal(results, expected_results)
+                del results
+            empty_path = os.path.join(directory, 'empty.bin')
+            with open(file=empty_path, mode='wb'):
+                pass
+            self.assertEqual(len(_load_trajectory(empty_path)), 0, msg='Empty file not empty.')
+
+    def test_generated(self) -> None:
+        """!
+        @brief This method verifies that a generator description is expanded without reading a file.
+        @return None
+        """
+        generator = {'type': 'lawnmower', 'x_min': 0.0, 'y_min': 0.0, 'x_max': 1.0, 'y_max': 1.0,
+                     'stride': 0.5, 'lane_spacing': 1.0}
+        with patch(target='builtins.open') as mock:
+            results = _load_trajectory(generator)
+            mock.assert_not_called()
+        self.assertEqual(len(results), 6, msg='Generated trajectory wrong length.')
+        self.assertListEqual(results[3], [1.0, 1.0, numpy.pi], msg='Generated pose wrong.')
+
+    def test_binary_files_wrong_shape(self) -> None:
+        """!
+        @brief This method verifies that binary files which are not Nx3 floats are rejected.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as directory:
+            file_path = os.path.join(directory, 'trajectory.npy')
+            numpy.save(file_path, numpy.zeros((2, 2)))
+            self.assertRaises(RuntimeError, _load_trajectory, file_path)
+            numpy.save(file_path, numpy.zeros((2, 3), dtype=int))
+            self.assertRaises(RuntimeError, _load_trajectory, file_path)
+            file_path = os.path.join(directory, 'trajectory.bin')
+            numpy.zeros(4).tofile(file_path)
+            self.assertRaises(RuntimeError, _load_trajectory, file_path)
+
     def test_empty_file(self) -> None:
         """!
         @brief This method verifies that the function returns an empty list if the file is empty.
@@ -287,6 +942,81 @@ class TestLoadTrajectory(unittest.TestCase):
                                  msg='Poses not successfully read from file.')
 
 
+class TestCheckRange(unittest.TestCase):
+    """!
+    @brief This class tests the check_range function.
+    """
+
+    def test_invalid_ranges(self) -> None:
+        """!
+        @brief Test that empty ranges and ranges past the end of the trajectory are rejected.
+        @return None
+        """
+        for start_index, end_index in [(5, 5), (6, 5), (0, 11), (10, None)]:
+            with self.assertRaises(ValueError, msg=F'[{start_index}, {end_index}) not rejected.'):
+                _check_range({'start_index': start_index, 'end_index': end_index}, 10)
+
+    def test_valid_ranges(self) -> None:
+        """!
+        @brief Test that no range, or a range within the trajectory, is accepted.
+        @return None
+        """
+        for start_index, end_index in [(None, None), (0, 10), (None, 4), (9, None), (3, 7)]:
+            _check_range({'start_index': start_index, 'end_index': end_index}, 10)
+
+
+class TestExpandSweep(unittest.TestCase):
+    """!
+    @brief This class tests the expand_sweep function.
+    """
+
+    def test_variants(self) -> None:
+        """!
+        @brief Test that every combination is a variant with its own output, set in every camera.
+        @return None
+        """
+        configs = {
+            'output': 'out',
+            'camera': [{'name': 'Left'}, {'name': 'Right'}],
+            'sequence': {'texture_number': 1},
+            'sweep': {'camera/z': [0.2, 0.3], 'sequence/texture_number': [1, 2, 3],
+                      'render/max_samples': [64]}
+        }
+        result = _expand_sweep(configs)
+        self.assertEqual(len(result), 6, msg='Wrong variant count.')
+        overrides, variant = result[4]
+        self.assertDictEqual(overrides, {'camera/z': 0.3, 'sequence/texture_number': 2,
+                                         'render/max_samples': 64}, msg='Wrong combination order.')
+        self.assertListEqual([camera['z'] for camera in variant['camera']], [0.3, 0.3],
+                             msg='Camera value not set in every camera.')
+        self.assertEqual(variant['sequence']['texture_number'], 2, msg='Value not set.')
+        self.assertEqual(variant['render']['max_samples'], 64, msg='Missing section not created.')
+        self.assertEqual(variant['output'], os.path.join('out', 'sweep_004'), msg='Wrong output.')
+        self.assertNotIn('sweep', variant, msg='Sweep left in the variant.')
+        self.assertNotIn('z', configs['camera'][0], msg='Base configuration changed.')
+
+    def test_reject_bad_sweep(self) -> None:
+        """!
+        @brief Test that sweeps that are not objects of non-empty lists, or empty paths, are
+        rejected.
+        @return None
+        """
+        bad_sweeps = [([0.2], TypeError), ({}, TypeError), ({'camera/z': 0.2}, TypeError),
+                      ({'camera/z': []}, TypeError), ({'/': [1]}, KeyError)]
+        for bad_sweep, error in bad_sweeps:
+            with self.assertRaises(error, msg=F'{bad_sweep} not rejected.'):
+                _expand_sweep({'output': 'out', 'sweep': bad_sweep})
+
+    def test_replace_parameter_file(self) -> None:
+        """!
+        @brief Test that only the configuration file is swapped on the command line.
+        @return None
+        """
+        args = ['blender', '-b', '--', '--workers', '2', 'config.json', '--end', '5']
+        expected_args = ['blender', '-b', '--', '--workers', '2', 'variant.json', '--end', '5']
+        self.assertListEqual(replace_parameter_file(args, 'variant.json'), expected_args)
+
+
 class TestParseArgs(unittest.TestCase):
     """!
     @brief This class tests the parse_args function.
@@ -318,6 +1048,16 @@ class TestParseArgs(unittest.TestCase):
                 '-b', '--', 'config.json', 'other_config.json']
         self.assertRaises(SystemExit, _parse_args, args)
 
+    def test_with_job_directory(self) -> None:
+        """!
+        @brief Test that a job directory may be given instead of a JSON file.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', '--serve', 'jobs']
+        result = _parse_args(args)
+        self.assertEqual(result.serve, 'jobs', msg='Job directory not parsed.')
+        self.assertIsNone(result.parameter_file, msg='JSON file set when not provided.')
+
     def test_with_filename(self) -> None:
         """!
         @brief Test that the argument for the JSON is correctly parsed.
@@ -326,8 +1066,86 @@ class TestParseArgs(unittest.TestCase):
         args = ['blender', '--python',
                 'generate_data.py', '-b', '--', 'config.json']
         result = _parse_args(args)
-        self.assertEqual(result, 'config.json',
+        self.assertEqual(result.parameter_file, 'config.json',
+                         msg='Unable to successfully extract JSON file.')
+        self.assertIsNone(result.start, msg='Start index set when not provided.')
+        self.assertIsNone(result.end, msg='End index set when not provided.')
+        self.assertIsNone(result.workers, msg='Worker count set when not provided.')
+        self.assertFalse(result.merge, msg='Merge set when not provided.')
+        self.assertIsNone(result.serve, msg='Job directory set when not provided.')
+
+    def test_with_merge(self) -> None:
+        """!
+        @brief Test that the merge flag and worker override are correctly parsed.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', 'config.json', '--merge',
+                '--workers', '3']
+        result = _parse_args(args)
+        self.assertTrue(result.merge, msg='Merge flag not parsed.')
+        self.assertIsNone(result.device_index, msg='Device index set when not provided.')
+        self.assertEqual(result.workers, 3, msg='Worker count not parsed.')
+        self.assertFalse(result.mosaic, msg='Mosaic set when not provided.')
+        self.assertFalse(result.dry_run, msg='Dry run set when not provided.')
+
+    def test_with_mosaic(self) -> None:
+        """!
+        @brief Test that the mosaic flag is correctly parsed.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', 'config.json', '--mosaic']
+        self.assertTrue(_parse_args(args).mosaic, msg='Mosaic flag not parsed.')
+
+    def test_with_dry_run(self) -> None:
+        """!
+        @brief Test that the dry run flag is correctly parsed.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', 'config.json', '--dry-run']
+        self.assertTrue(_parse_args(args).dry_run, msg='Dry run flag not parsed.')
+
+    def test_with_plan(self) -> None:
+        """!
+        @brief Test that the plan flag is correctly parsed.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', 'config.json']
+        self.assertFalse(_parse_args(args).plan, msg='Plan set when not provided.')
+        self.assertTrue(_parse_args(args + ['--plan']).plan, msg='Plan flag not parsed.')
+
+    def test_with_date(self) -> None:
+        """!
+        @brief Test that the collection date is correctly parsed.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', 'config.json']
+        self.assertIsNone(_parse_args(args).date, msg='Date set when not provided.')
+        self.assertEqual(_parse_args(args + ['--date', '2026-10-14']).date, '2026-10-14',
+                         msg='Date not parsed.')
+
+    def test_with_preview(self) -> None:
+        """!
+        @brief Test that the preview flag is correctly parsed.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', 'config.json']
+        self.assertFalse(_parse_args(args).preview, msg='Preview set when not provided.')
+        self.assertTrue(_parse_args(args + ['--preview']).preview, msg='Preview flag not parsed.')
+
+    def test_with_range(self) -> None:
+        """!
+        @brief Test that the optional trajectory range is correctly parsed.
+        @return None
+        """
+        args = ['blender', '--python', 'generate_data.py', '-b', '--', 'config.json', '--start',
+                '10', '--end', '20']
+        result = _parse_args(args)
+        self.assertEqual(result.parameter_file, 'config.json',
                          msg='Unable to successfully extract JSON file.')
+        self.assertEqual(result.start, 10, msg='Start index not parsed.')
+        self.assertEqual(result.end, 20, msg='End index not parsed.')
+        args += ['--device-index', '2']
+        self.assertEqual(_parse_args(args).device_index, 2, msg='Device index not parsed.')
 
 
 if __name__ == '__main__':  # pragma: no cover
@@ -0,0 +1,96 @@
+"""!
+@brief This module tests the coverage module.
+"""
+import unittest
+import numpy
+from ground_texture_sim.coverage import CoverageAnalyzer
+from ground_texture_sim.transforms import Transformer, create_transform_matrix
+
+
+class TestCoverageAnalyzer(unittest.TestCase):
+    """!
+    @brief Tests the CoverageAnalyzer class.
+    """
+
+    def setUp(self) -> None:
+        """!
+        @brief Create a transformer for a camera facing straight down, seeing 0.32 by 0.24 meters.
+        @return None
+        """
+        camera_matrix = numpy.array([
+            [1000.0, 0.0, 320.0],
+            [0.0, 1000.0, 240.0],
+            [0.0, 0.0, 1.0]
+        ])
+        ## The transformer of the downward facing camera.
+        self._transformer = Transformer(
+            create_transform_matrix(0.0, 0.0, 0.5, 0.0, numpy.pi / 2.0, 0.0), camera_matrix)
+
+    def test_footprint(self) -> None:
+        """!
+        @brief Test that the footprint and default cell size follow the image on the floor.
+        @return None
+        """
+        analyzer = CoverageAnalyzer(self._transformer, (640, 480), (0.0, 1.0), (0.0, 1.0))
+        self.assertTrue(numpy.allclose(analyzer.footprint, (0.32, 0.24)), msg='Wrong footprint.')
+        self.assertAlmostEqual(analyzer.cell_size, 0.03, msg='Wrong default cell size.')
+        self.assertEqual(analyzer.raster.shape, (47, 47), msg='Raster does not cover the reach.')
+
+    def test_overlap(self) -> None:
+        """!
+        @brief Test that overlap carries across chunks and follows both translation and rotation.
+        @return None
+        """
+        analyzer = CoverageAnalyzer(self._transformer, (640, 480), (0.0, 0.24), (0.0, 0.0))
+        # Each step moves half the footprint's height, which runs along the robot's X.
+        analyzer.add_poses([[0.0, 0.0, 0.0]])
+        analyzer.add_poses([[0.12, 0.0, 0.0], [0.24, 0.0, 0.0], [0.24, 0.0, numpy.pi]])
+        summary = analyzer.summary(0.6)
+        self.assertEqual(summary['poses'], 4, msg='Wrong pose count.')
+        self.assertAlmostEqual(summary['overlap']['min'], 0.5, msg='Translation overlap wrong.')
+        self.assertAlmostEqual(summary['overlap']['p50'], 0.5, msg='Median overlap wrong.')
+        self.assertAlmostEqual(summary['overlap']['mean'], 2.0 / 3.0,
+                               msg='Turning in place should overlap completely.')
+        self.assertEqual(summary['overlap']['below_minimum'], 2,
+                         msg='Frames below the minimum not counted.')
+
+    def test_coverage(self) -> None:
+        """!
+        @brief Test that the raster counts each frame that saw a cell once.
+        @return None
+        """
+        analyzer = CoverageAnalyzer(self._transformer, (640, 480), (0.0, 0.24), (0.0, 0.0), 0.01)
+        analyzer.add_poses(numpy.array([[0.0, 0.0, 0.0], [0.12, 0.0, 0.0], [0.24, 0.0, 0.0]]))
+        coverage = analyzer.summary(0.3)['coverage']
+        # The three frames cover 0.32 meters wide by 0.48 meters long.
+        self.assertAlmostEqual(coverage['covered_area'], 0.32 * 0.48, delta=0.02,
+                               msg='Wrong covered area.')
+        self.assertAlmostEqual(coverage['mean_observations'], 1.5, delta=0.1,
+                               msg='Wrong observations per cell.')
+        self.assertLessEqual(analyzer.raster.max(), 3, msg='A frame counted a cell twice.')
+        self.assertEqual(analyzer.raster[0, 0], 0, msg='Cell outside every frame counted.')
+
+    def test_empty(self) -> None:
+        """!
+        @brief Test that a summary without any pairs of frames has no overlap statistics.
+        @return None
+        """
+        summary = CoverageAnalyzer(self._transformer, (640, 480), (0.0, 0.0),
+                                   (0.0, 0.0)).summary(0.3)
+        self.assertEqual(summary['poses'], 0, msg='Wrong pose count.')
+        self.assertIsNone(summary['overlap']['mean'], msg='Overlap reported without frames.')
+        self.assertEqual(summary['coverage']['covered_area'], 0.0, msg='Coverage without frames.')
+
+    def test_reject_bad_raster(self) -> None:
+        """!
+        @brief Test that a bad cell size or a raster that is too large raise exceptions.
+        @return None
+        """
+        with self.assertRaises(ValueError, msg='Zero cell size accepted.'):
+            CoverageAnalyzer(self._transformer, (640, 480), (0.0, 1.0), (0.0, 1.0), 0.0)
+        with self.assertRaises(ValueError, msg='Huge raster accepted.'):
+            CoverageAnalyzer(self._transformer, (640, 480), (0.0, 1000.0), (0.0, 1000.0), 0.001)
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
@@ -2,10 +2,43 @@
 @brief This module provides tests for the data_writer module.
 """
 import datetime
+import json
+import os
+import tempfile
 import unittest
 from unittest.mock import mock_open, patch
 import numpy
-from ground_texture_sim.data_writer import DataWriter
+from ground_texture_sim import transforms
+from ground_texture_sim.configuration_loader import pin_collection_date
+from ground_texture_sim.data_writer import DataWriter, read_pose_records
+
+
+class _FirstDay(datetime.date):
+    """!
+    @brief A date whose today is the day a sequence was first collected.
+    """
+
+    @classmethod
+    def today(cls) -> '_FirstDay':
+        """!
+        @brief Get a fixed date.
+        @return The date.
+        """
+        return cls(2026, 10, 14)
+
+
+class _NextDay(datetime.date):
+    """!
+    @brief A date whose today is the day after a sequence was first collected.
+    """
+
+    @classmethod
+    def today(cls) -> '_NextDay':
+        """!
+        @brief Get a fixed later date.
+        @return The date.
+        """
+        return cls(2026, 10, 15)
 
 
 class TestDataWriter(unittest.TestCase):
@@ -13,6 +46,70 @@ class TestDataWriter(unittest.TestCase):
     @brief Tests the DataWriter class.
     """
 
+    def test_checkpoint(self) -> None:
+        """!
+        @brief Test that finished images are recorded per range, read back together, and cleared.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            self.assertSetEqual(writer.read_checkpoint(), set(),
+                                msg='Missing manifest is not empty.')
+            writer.record_checkpoint(0, 0, 10)
+            writer.record_checkpoint(5, 0, 10)
+            writer.record_checkpoint(12, 10, 20)
+            self.assertTrue(os.path.isfile(os.path.join(
+                output_folder, writer._namer.checkpoint_file(10, 20))),
+                msg='Range not given its own manifest.')
+            # Simulate a crash partway through writing an entry.
+            checkpoint_path = os.path.join(output_folder, writer._namer.checkpoint_file(0, 10))
+            with open(file=checkpoint_path, mode='a', encoding='utf-8') as checkpoint_file:
+                checkpoint_file.write('1')
+            self.assertSetEqual(writer.read_checkpoint(), {0, 5, 1, 12},
+                                msg='Finished images not read back.')
+            writer.clear_checkpoint()
+            self.assertSetEqual(writer.read_checkpoint(), set(),
+                                msg='Manifest not cleared.')
+
+    def test_checkpoint_after_midnight(self) -> None:
+        """!
+        @brief Test that a run resumed on a later day finds the checkpoint of the first day.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as output_folder:
+            with patch(target='datetime.date', new=_FirstDay):
+                first_date = pin_collection_date(output_folder, 'regular', 3)
+                writer = DataWriter(output_folder, 'regular', 3, 1, 'c55',
+                                    collection_date=datetime.date.fromisoformat(first_date))
+                writer.record_checkpoint(7, 0, 10)
+            with patch(target='datetime.date', new=_NextDay):
+                later_date = pin_collection_date(output_folder, 'regular', 3)
+                resumed = DataWriter(output_folder, 'regular', 3, 1, 'c55',
+                                     collection_date=datetime.date.fromisoformat(later_date))
+                self.assertEqual(later_date, '2026-10-14', msg='Resumed run given a new date.')
+                self.assertSetEqual(resumed.read_checkpoint(), {7},
+                                    msg='Checkpoint lost after midnight.')
+                self.assertEqual(resumed._namer.create_image_path(7),
+                                 writer._namer.create_image_path(7),
+                                 msg='Images renamed after midnight.')
+
+    def test_image_is_complete(self) -> None:
+        """!
+        @brief Test that only fully written images are considered complete.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            self.assertFalse(writer.image_is_complete(0), msg='Missing image is complete.')
+            image_path = writer._namer.create_image_path(0, absolute=True)
+            os.makedirs(os.path.dirname(image_path))
+            with open(file=image_path, mode='wb') as image_file:
+                image_file.write(b'\x89PNG\r\n\x1a\n')
+            self.assertFalse(writer.image_is_complete(0), msg='Truncated image is complete.')
+            with open(file=image_path, mode='ab') as image_file:
+                image_file.write(b'\x00\x00\x00\x00IEND\xaeB`\x82')
+            self.assertTrue(writer.image_is_complete(0), msg='Full image is not complete.')
+
     def test_list_writing(self) -> None:
         """!
         @brief Test that the list files are well formed and written to the correct spot.
@@ -69,6 +166,81 @@ class TestDataWriter(unittest.TestCase):
                 mock_output().write.assert_any_call(expected_pixels_strings[0])
                 mock_output().write.assert_any_call(expected_pixels_strings[1])
 
+    def test_list_streaming(self) -> None:
+        """!
+        @brief Test that streaming entries produces the same files as writing them all at once.
+        @return None
+        """
+        robot_poses = [[0.0, 0.0, 0.0], [1.0, 2.0, numpy.pi / 2.0], [-0.2, 0.0, -2.62567e-18]]
+        pixel_poses = [[0.0, 0.0, 0.0], [5.0, 4.0, numpy.pi / 2.0], [-3.0, 1.0, 0.0]]
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55', flush_interval=2)
+            writer.write_lists(robot_poses, pixel_poses)
+            file_names = [writer._namer.test_file, writer._namer.meters_txt_file,
+                          writer._namer.txt_file]
+            expected_contents = []
+            for file_name in file_names:
+                with open(file=os.path.join(output_folder, file_name), mode='r',
+                          encoding='utf-8') as list_file:
+                    expected_contents.append(list_file.read())
+            robot_transforms = transforms.create_planar_transform_matrices(robot_poses)
+            pixel_transforms = transforms.create_planar_transform_matrices(pixel_poses)
+            writer.open_lists()
+            for i in range(2):
+                writer.append_list_entry(i, robot_poses[i], pixel_poses[i], robot_transforms[i],
+                                         pixel_transforms[i])
+            # After hitting the flush interval, the entries should already be on disk.
+            with open(file=os.path.join(output_folder, file_names[0]), mode='r',
+                      encoding='utf-8') as list_file:
+                self.assertEqual(len(list_file.readlines()), 2, msg='Entries not flushed.')
+            writer.append_list_entry(2, robot_poses[2], pixel_poses[2], robot_transforms[2],
+                                     pixel_transforms[2])
+            writer.close_lists()
+            for file_name, expected_content in zip(file_names, expected_contents):
+                with open(file=os.path.join(output_folder, file_name), mode='r',
+                          encoding='utf-8') as list_file:
+                    self.assertEqual(list_file.read(), expected_content,
+                                     msg=F'Streamed {file_name} differs from write_lists.')
+            with self.assertRaises(RuntimeError, msg='Appending to closed lists not rejected.'):
+                writer.append_list_entry(3, robot_poses[0], pixel_poses[0], robot_transforms[0],
+                                         pixel_transforms[0])
+
+    def test_pose_records(self) -> None:
+        """!
+        @brief Test that the pose records hold the exact poses, whether streamed or not.
+
+        Yaws outside (-π, π] must not be wrapped.
+
+        @return None
+        """
+        robot_poses = [[0.1234567891, 0.0, 0.0], [1.0, 2.0, 4.0], [-0.2, 0.0, -3.5]]
+        pixel_poses = [[0.0, 0.0, 0.0], [5.0, 4.0, 2.0 * numpy.pi], [-3.0, 1.0, -7.0]]
+        expected_records = numpy.column_stack((range(3), robot_poses, pixel_poses))
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55', pose_records=True)
+            file_path = os.path.join(output_folder, writer._namer.pose_records_file)
+            writer.write_lists(robot_poses, pixel_poses)
+            numpy.testing.assert_array_equal(read_pose_records(file_path), expected_records)
+            robot_transforms = transforms.create_planar_transform_matrices(robot_poses)
+            pixel_transforms = transforms.create_planar_transform_matrices(pixel_poses)
+            writer.open_lists()
+            self.assertEqual(read_pose_records(file_path).shape, (0, 7),
+                             msg='Opening the lists did not replace the records.')
+            for i in range(3):
+                writer.append_list_entry(i, robot_poses[i], pixel_poses[i], robot_transforms[i],
+                                         pixel_transforms[i])
+            writer.close_lists()
+            numpy.testing.assert_array_equal(read_pose_records(file_path), expected_records)
+            with open(file=file_path, mode='ab') as records_file:
+                records_file.write(b'\x00' * 8)
+            with self.assertRaises(RuntimeError, msg='Partial record not rejected.'):
+                read_pose_records(file_path)
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            writer.write_lists(robot_poses, pixel_poses)
+            self.assertFalse(os.path.exists(os.path.join(
+                output_folder, writer._namer.pose_records_file)), msg='Records written unasked.')
+
     def test_list_writing_mismatched_sizes(self) -> None:
         """!
         @brief Ensure an exception is raised if there is not an even number of images, ground, and
@@ -90,6 +262,36 @@ class TestDataWriter(unittest.TestCase):
             with self.assertRaises(ValueError, msg='Different list sizes raises nothing.'):
                 writer.write_lists(meters_input_1, pixels_input_2)
 
+    def test_partial_poses_merge(self) -> None:
+        """!
+        @brief Test that partial results from several workers merge back into trajectory order.
+        @return None
+        """
+        first_poses = [[1.0, 2.0, 0.5], [3.0, 4.0, -0.5]]
+        second_poses = [[5.0, 6.0, 0.25]]
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            # Write out of order to make sure the index range is what places them.
+            writer.write_partial_poses(2, second_poses)
+            writer.write_partial_poses(0, first_poses)
+            result = writer.read_partial_poses(3)
+            self.assertListEqual(result, first_poses + second_poses,
+                                 msg='Partial results not merged in order.')
+            writer.remove_partial_poses()
+            self.assertEqual(len(os.listdir(os.path.join(output_folder, 'partial_results'))), 0,
+                             msg='Partial results not removed.')
+
+    def test_partial_poses_missing(self) -> None:
+        """!
+        @brief Test that merging raises an exception if a worker's results are missing.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            writer.write_partial_poses(0, [[1.0, 2.0, 0.5]])
+            with self.assertRaises(RuntimeError, msg='Missing partial results not detected.'):
+                writer.read_partial_poses(2)
+
     def test_prepare_directory_exist(self) -> None:
         """!
         @brief Ensure that prepare_directory works even if the directory already exists.
@@ -126,6 +328,25 @@ class TestDataWriter(unittest.TestCase):
             _ = DataWriter('/opt', 'regular', 3, 1, 'c55')
             mock_make.assert_called_once_with('/opt/camera_properties')
 
+    def test_reuse_image(self) -> None:
+        """!
+        @brief Test that reused images are linked or copied, replacing anything already there.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            source_path = writer._namer.create_image_path(0, absolute=True)
+            os.makedirs(os.path.dirname(source_path))
+            with open(file=source_path, mode='wb') as image_file:
+                image_file.write(b'image')
+            for index, link in [(1, True), (2, False), (1, False)]:
+                writer.reuse_image(0, index, link)
+                image_path = writer._namer.create_image_path(index, absolute=True)
+                with open(file=image_path, mode='rb') as image_file:
+                    self.assertEqual(image_file.read(), b'image', msg='Image not reused.')
+                self.assertEqual(os.path.samefile(source_path, image_path), link,
+                                 msg='Image linked when it should be copied, or vice versa.')
+
     def test_write_camera_intrinsic_matrix(self) -> None:
         """!
         @brief Tests that the camera intrinsic matrix is correctly written to file.
@@ -188,6 +409,52 @@ class TestDataWriter(unittest.TestCase):
                     file=expected_file_path, mode='w', encoding='utf-8')
                 mock_output().write.assert_called_once_with(expected_output)
 
+    def test_write_coverage(self) -> None:
+        """!
+        @brief Test that the coverage report is saved as JSON and the raster as a Numpy file.
+        @return None
+        """
+        report = {'poses': 3, 'overlap': {'mean': 0.5}}
+        raster = numpy.arange(6, dtype=numpy.uint32).reshape((2, 3))
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            writer.write_coverage_report(report)
+            writer.write_coverage_raster(raster)
+            file_path = os.path.join(output_folder, writer._namer.coverage_report_file)
+            with open(file=file_path, mode='r', encoding='utf-8') as file:
+                self.assertDictEqual(json.load(file), report, msg='Coverage report not saved.')
+            saved_raster = numpy.load(os.path.join(output_folder,
+                                                   writer._namer.coverage_raster_file))
+            self.assertTrue(numpy.array_equal(saved_raster, raster),
+                            msg='Coverage raster not saved.')
+
+    def test_write_mosaic_metadata(self) -> None:
+        """!
+        @brief Test that the mosaic metadata is saved as JSON in the output folder.
+        @return None
+        """
+        metadata = {'pixel_origin': [-10, 4], 'width': 300, 'height': 200, 'tile_size': 256}
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            writer.write_mosaic_metadata(metadata)
+            file_path = os.path.join(output_folder, writer._namer.mosaic_metadata_file)
+            with open(file=file_path, mode='r', encoding='utf-8') as file:
+                self.assertDictEqual(json.load(file), metadata, msg='Mosaic metadata not saved.')
+
+    def test_write_render_settings(self) -> None:
+        """!
+        @brief Test that the render settings are saved as JSON in the output folder.
+        @return None
+        """
+        render_settings = {'engine': 'CYCLES', 'samples': 128, 'use_denoising': True}
+        with tempfile.TemporaryDirectory() as output_folder:
+            writer = DataWriter(output_folder, 'regular', 3, 1, 'c55')
+            writer.write_render_settings(render_settings)
+            file_path = os.path.join(output_folder, writer._namer.render_settings_file)
+            with open(file=file_path, mode='r', encoding='utf-8') as file:
+                self.assertDictEqual(json.load(file), render_settings,
+                                     msg='Render settings not saved.')
+
     def test_write_camera_pose_wrong_size(self) -> None:
         """!
         @brief Test that the method raises an exception unless a 4x matrix is provided.
@@ -0,0 +1,44 @@
+"""!
+@brief This module tests the deduplication module.
+"""
+import unittest
+import numpy
+from ground_texture_sim.deduplication import find_duplicates
+
+
+class TestFindDuplicates(unittest.TestCase):
+    """!
+    @brief Tests the find_duplicates function.
+    """
+
+    def test_groups(self) -> None:
+        """!
+        @brief Test that near poses share an image, even across grid cells, but far ones do not.
+        @return None
+        """
+        pixel_poses = numpy.array([
+            [0.0, 0.0, 0.0],
+            [0.4, 0.0, 0.0],
+            [5.0, 5.0, 0.0],
+            [0.0, 0.0, 0.5],
+            [-0.3, 0.2, 0.005],
+            [5.9, 5.0, 0.0],
+            [0.0, 0.0, 2.0 * numpy.pi]
+        ])
+        result = find_duplicates([pixel_poses], 1.0, 0.01)
+        numpy.testing.assert_array_equal(result, [0, 0, 2, 3, 0, 2, 0])
+
+    def test_every_camera_must_match(self) -> None:
+        """!
+        @brief Test that poses only share images if they are within tolerance for every camera.
+        @return None
+        """
+        first_camera = numpy.array([[0.0, 0.0, 0.0], [0.5, 0.0, 0.0]])
+        second_camera = numpy.array([[10.0, 0.0, 0.0], [12.0, 0.0, 0.0]])
+        numpy.testing.assert_array_equal(find_duplicates([first_camera], 1.0, 0.01), [0, 0])
+        numpy.testing.assert_array_equal(
+            find_duplicates([first_camera, second_camera], 1.0, 0.01), [0, 1])
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
@@ -0,0 +1,263 @@
+"""!
+@brief This module tests the image_pipeline module.
+"""
+import os
+import struct
+import tempfile
+import unittest
+import zlib
+import numpy
+from ground_texture_sim.image_pipeline import BackgroundWriter, downsample_image, encode_png, \
+    read_tiff, recompress_png, write_pyramid
+
+
+def _create_png(pixel_rows: bytes, compression_level: int) -> bytes:
+    """!
+    @brief Build a small 8 bit grayscale PNG, split across two IDAT chunks.
+    @param pixel_rows The filtered scanlines, i.e. each row prefixed by its filter byte.
+    @param compression_level The zlib level to compress the scanlines with.
+    @return The bytes of the PNG file.
+    """
+    def chunk(chunk_type: bytes, chunk_data: bytes) -> bytes:
+        crc = zlib.crc32(chunk_type + chunk_data) & 0xffffffff
+        return struct.pack('>I', len(chunk_data)) + chunk_type + chunk_data + \
+            struct.pack('>I', crc)
+    header = struct.pack('>IIBBBBB', 2, 2, 8, 0, 0, 0, 0)
+    image_data = zlib.compress(pixel_rows, compression_level)
+    middle = len(image_data) // 2
+    return b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', header) + chunk(b'IDAT', image_data[:middle]) + \
+        chunk(b'IDAT', image_data[middle:]) + chunk(b'IEND', b'')
+
+
+def _create_tiff(pixels: numpy.ndarray, byte_order: str, orientation: int) -> bytes:
+    """!
+    @brief Build an uncompressed TIFF, with its pixels in two strips after a single directory.
+    @param pixels An HxWxC Numpy array of 8 or 16 bit unsigned integer pixels, top row first.
+    @param byte_order The struct byte order, '<' or '>'.
+    @param orientation The TIFF orientation. If 4, the rows are stored bottom first.
+    @return The bytes of the TIFF file.
+    """
+    height, width, channels = pixels.shape
+    stored = pixels[::-1] if orientation == 4 else pixels
+    image_data = numpy.ascontiguousarray(
+        stored, dtype=F'{byte_order}u{pixels.dtype.itemsize}').tobytes()
+    middle = (height // 2) * len(image_data) // height
+    # Short values and single longs fit in an entry; the rest go after the directory.
+    entries = [(256, 3, [width]), (257, 3, [height]), (258, 3, [pixels.dtype.itemsize * 8]),
+               (259, 3, [1]), (273, 4, [0, 0]), (274, 3, [orientation]), (277, 3, [channels]),
+               (279, 4, [middle, len(image_data) - middle]), (284, 3, [1])]
+    directory_size = 2 + 12 * len(entries) + 4
+    extra_offset = 8 + directory_size
+    data_offset = extra_offset + 16
+    entries[4] = (273, 4, [data_offset, data_offset + middle])
+    directory = struct.pack(byte_order + 'H', len(entries))
+    extra = b''
+    for tag, field_type, values in entries:
+        value_format = 'H' if field_type == 3 else 'I'
+        if len(values) == 1 and field_type == 3:
+            value = struct.pack(byte_order + 'HH', values[0], 0)
+        elif len(values) == 1:
+            value = struct.pack(byte_order + 'I', values[0])
+        else:
+            value = struct.pack(byte_order + 'I', extra_offset + len(extra))
+            extra += struct.pack(F'{byte_order}{len(values)}{value_format}', *values)
+        directory += struct.pack(byte_order + 'HHI', tag, field_type, len(values)) + value
+    directory += struct.pack(byte_order + 'I', 0)
+    header = (b'II' if byte_order == '<' else b'MM') + struct.pack(byte_order + 'HI', 42, 8)
+    return header + directory + extra.ljust(16, b'\x00') + image_data
+
+
+def _decode_png(data: bytes) -> numpy.ndarray:
+    """!
+    @brief Decode a PNG written by encode_png, undoing the filter of each row.
+    @param data The bytes of the PNG file.
+    @return An HxWxC Numpy array of the pixels.
+    """
+    position = 8
+    image_data = b''
+    while position < len(data):
+        length, chunk_type = struct.unpack('>I4s', data[position:position + 8])
+        if chunk_type == b'IHDR':
+            width, height, bits, color_type = struct.unpack(
+                '>IIBB', data[position + 8:position + 18])
+        elif chunk_type == b'IDAT':
+            image_data += data[position + 8:position + 8 + length]
+        position += length + 12
+    channels = {0: 1, 4: 2, 2: 3, 6: 4}[color_type]
+    pixel_size = channels * bits // 8
+    filtered = numpy.frombuffer(zlib.decompress(image_data), dtype=numpy.uint8).reshape(
+        (height, width * pixel_size + 1))
+    rows = numpy.zeros((height, width * pixel_size), dtype=numpy.int32)
+    for row in range(height):
+        for column in range(width * pixel_size):
+            left = int(rows[row, column - pixel_size]) if column >= pixel_size else 0
+            up = int(rows[row - 1, column]) if row > 0 else 0
+            up_left = int(rows[row - 1, column - pixel_size]) \
+                if row > 0 and column >= pixel_size else 0
+            estimate = left + up - up_left
+            distances = [abs(estimate - left), abs(estimate - up), abs(estimate - up_left)]
+            prediction = [left, up, up_left][distances.index(min(distances))]
+            rows[row, column] = (int(filtered[row, column + 1]) + prediction) % 256
+    return rows.astype(numpy.uint8).view(F'>u{bits // 8}').reshape((height, width, channels))
+
+
+class TestPyramid(unittest.TestCase):
+    """!
+    @brief Tests the functions that write image pyramids.
+    """
+
+    def test_read_tiff(self) -> None:
+        """!
+        @brief Test that both byte orders, both bit depths, and bottom first rows are read.
+        @return None
+        """
+        pixels = numpy.arange(4 * 6 * 3).reshape((4, 6, 3))
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, 'image.tif')
+            for byte_order, dtype, orientation in [('<', numpy.uint8, 1), ('>', numpy.uint16, 4)]:
+                expected = (pixels * (257 if dtype == numpy.uint16 else 1)).astype(dtype)
+                with open(file=path, mode='wb') as tiff_file:
+                    tiff_file.write(_create_tiff(expected, byte_order, orientation))
+                numpy.testing.assert_array_equal(read_tiff(path), expected)
+            with open(file=path, mode='wb') as tiff_file:
+                tiff_file.write(b'not a tiff')
+            with self.assertRaises(ValueError, msg='Non TIFF data not rejected.'):
+                read_tiff(path)
+
+    def test_encode_png(self) -> None:
+        """!
+        @brief Test that the filtered PNG decodes back to the same pixels.
+        @return None
+        """
+        random = numpy.random.default_rng(3)
+        for channels, dtype in [(1, numpy.uint8), (3, numpy.uint8), (4, numpy.uint16)]:
+            pixels = random.integers(0, numpy.iinfo(dtype).max, (5, 7, channels), endpoint=True,
+                                     dtype=dtype)
+            data = encode_png(pixels, 6)
+            self.assertTrue(data.startswith(b'\x89PNG\r\n\x1a\n'), msg='PNG signature missing.')
+            numpy.testing.assert_array_equal(_decode_png(data), pixels)
+
+    def test_downsample_image(self) -> None:
+        """!
+        @brief Test that each block of pixels becomes its rounded mean.
+        @return None
+        """
+        pixels = numpy.array([[[0], [1], [10], [20]], [[2], [2], [30], [40]]], dtype=numpy.uint8)
+        result = downsample_image(pixels, 2)
+        self.assertEqual(result.dtype, numpy.uint8, msg='Pixel type changed.')
+        numpy.testing.assert_array_equal(result[..., 0], [[1, 25]])
+        with self.assertRaises(ValueError, msg='Uneven size not rejected.'):
+            downsample_image(pixels, 3)
+
+    def test_write_pyramid(self) -> None:
+        """!
+        @brief Test that every level is written at its size and the staged image is removed.
+        @return None
+        """
+        pixels = numpy.arange(4 * 8 * 3, dtype=numpy.uint8).reshape((4, 8, 3))
+        with tempfile.TemporaryDirectory() as directory:
+            source_path = os.path.join(directory, 'image.tif')
+            with open(file=source_path, mode='wb') as tiff_file:
+                tiff_file.write(_create_tiff(pixels, '<', 1))
+            destinations = [(os.path.join(directory, F'level_{factor}.png'), factor)
+                            for factor in [4, 2, 1]]
+            write_pyramid(source_path, destinations, 9)
+            self.assertFalse(os.path.exists(source_path), msg='Staged image not removed.')
+            for path, factor in destinations:
+                with open(file=path, mode='rb') as png_file:
+                    level = _decode_png(png_file.read())
+                numpy.testing.assert_array_equal(level, downsample_image(pixels, factor)
+                                                 if factor > 1 else pixels)
+            self.assertListEqual(sorted(os.listdir(directory)),
+                                 ['level_1.png', 'level_2.png', 'level_4.png'],
+                                 msg='Temporary files left behind.')
+
+
+class TestRecompressPNG(unittest.TestCase):
+    """!
+    @brief Tests the recompress_png function.
+    """
+
+    def test_pixels_unchanged(self) -> None:
+        """!
+        @brief Test that recompressing keeps the pixels, replaces the source, and stays valid.
+        @return None
+        """
+        pixel_rows = b'\x00\x10\x20\x00\x30\x40'
+        with tempfile.TemporaryDirectory() as directory:
+            source_path = os.path.join(directory, 'source.png')
+            destination_path = os.path.join(directory, 'destination.png')
+            with open(file=source_path, mode='wb') as source_file:
+                source_file.write(_create_png(pixel_rows, 0))
+            recompress_png(source_path, destination_path, 9)
+            self.assertFalse(os.path.exists(source_path), msg='Source image not removed.')
+            with open(file=destination_path, mode='rb') as destination_file:
+                data = destination_file.read()
+        self.assertTrue(data.startswith(b'\x89PNG\r\n\x1a\n'), msg='PNG signature missing.')
+        self.assertTrue(data.endswith(b'\x00\x00\x00\x00IEND\xaeB`\x82'), msg='IEND missing.')
+        # Walk the chunks to check each CRC and pull out the pixels.
+        position = 8
+        image_data = b''
+        idat_count = 0
+        while position < len(data):
+            length, chunk_type = struct.unpack('>I4s', data[position:position + 8])
+            chunk_data = data[position + 8:position + 8 + length]
+            crc = struct.unpack('>I', data[position + 8 + length:position + 12 + length])[0]
+            self.assertEqual(crc, zlib.crc32(chunk_type + chunk_data) & 0xffffffff,
+                             msg=F'{chunk_type} chunk CRC is wrong.')
+            if chunk_type == b'IDAT':
+                image_data += chunk_data
+                idat_count += 1
+            position += length + 12
+        self.assertEqual(idat_count, 1, msg='IDAT chunks not merged.')
+        self.assertEqual(zlib.decompress(image_data), pixel_rows, msg='Pixels changed.')
+
+    def test_reject_not_png(self) -> None:
+        """!
+        @brief Test that files which are not PNGs raise an exception.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as directory:
+            source_path = os.path.join(directory, 'source.png')
+            with open(file=source_path, mode='wb') as source_file:
+                source_file.write(b'not a png')
+            with self.assertRaises(ValueError, msg='Non PNG data not rejected.'):
+                recompress_png(source_path, os.path.join(directory, 'destination.png'), 9)
+
+
+class TestBackgroundWriter(unittest.TestCase):
+    """!
+    @brief Tests the BackgroundWriter class.
+    """
+
+    def test_jobs_run_in_order(self) -> None:
+        """!
+        @brief Test that every job runs, in the order submitted, before close returns.
+        @return None
+        """
+        results = []
+        writer = BackgroundWriter(queue_size=2)
+        for i in range(10):
+            writer.submit(results.append, i)
+        writer.close()
+        self.assertListEqual(results, list(range(10)), msg='Jobs not run in order.')
+
+    def test_error_raised(self) -> None:
+        """!
+        @brief Test that a failed job's exception reaches the caller and later jobs are skipped.
+        @return None
+        """
+        results = []
+
+        def fail() -> None:
+            raise OSError('Disk full')
+        writer = BackgroundWriter()
+        writer.submit(fail)
+        writer.submit(results.append, 1)
+        with self.assertRaises(OSError, msg='Job exception not raised on close.'):
+            writer.close()
+        self.assertListEqual(results, [], msg='Jobs after a failure still ran.')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
@@ -0,0 +1,107 @@
+"""!
+@brief This module tests the job_plan module.
+"""
+import json
+import os
+import tempfile
+import unittest
+import numpy
+from ground_texture_sim.job_plan import PLAN_FILE, JobPlan
+from ground_texture_sim.transforms import Transformer, create_transform_matrix
+
+
+class TestJobPlan(unittest.TestCase):
+    """!
+    @brief Tests the JobPlan class.
+    """
+
+    def setUp(self) -> None:
+        """!
+        @brief Create a trajectory and the transformers of two cameras facing straight down.
+        @return None
+        """
+        camera_matrix = numpy.array([
+            [1000.0, 0.0, 320.0],
+            [0.0, 1000.0, 240.0],
+            [0.0, 0.0, 1.0]
+        ])
+        ## The name and transformer of each camera.
+        self._cameras = [
+            ('Front', Transformer(
+                create_transform_matrix(0.1, 0.0, 0.5, 0.0, numpy.pi / 2.0, 0.0), camera_matrix)),
+            ('Back', Transformer(
+                create_transform_matrix(-0.1, 0.0, 0.5, 0.0, numpy.pi / 2.0, 0.0), camera_matrix))
+        ]
+        ## The planar X, Y, and yaw of each pose of the trajectory.
+        self._trajectory = numpy.column_stack((
+            numpy.linspace(0.0, 10.0, 5000), numpy.linspace(0.0, -2.0, 5000),
+            numpy.linspace(-3.0, 3.0, 5000)))
+
+    def test_poses(self) -> None:
+        """!
+        @brief Test that the plan holds the range's robot and pixel poses, saved in its folder.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            folder = os.path.join(temp_dir, 'plan')
+            plan = JobPlan(folder, self._trajectory, self._cameras, 100, 4500)
+            self.assertEqual(len(plan), 4400, msg='Wrong plan length.')
+            self.assertTrue(numpy.allclose(plan.robot_poses, self._trajectory[100:4500]),
+                            msg='Wrong robot poses.')
+            for (name, transformer), pixel_poses in zip(self._cameras, plan.pixel_poses):
+                self.assertTrue(numpy.allclose(pixel_poses, transformer.project_image_corners(
+                    self._trajectory[100:4500])), msg=F'Wrong pixel poses for {name}.')
+            with open(file=os.path.join(folder, PLAN_FILE), mode='r',
+                      encoding='utf-8') as plan_file:
+                description = json.load(plan_file)
+            self.assertEqual(description['start_index'], 100, msg='Wrong start saved.')
+            self.assertEqual(description['end_index'], 4500, msg='Wrong end saved.')
+            self.assertListEqual(description['cameras'], ['Front', 'Back'],
+                                 msg='Wrong cameras saved.')
+            saved_poses = numpy.load(os.path.join(folder, description['files']['Back']),
+                                     mmap_mode='r')
+            self.assertTrue(numpy.allclose(saved_poses, plan.pixel_poses[1]),
+                            msg='Pixel poses not saved.')
+            self.assertIsNone(description['required_bytes'], msg='Unchecked plan has a size.')
+            del saved_poses
+            del plan
+
+    def test_validate(self) -> None:
+        """!
+        @brief Test that validating creates the output folders and compares the size against the
+        free space.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            plan = JobPlan(os.path.join(temp_dir, 'plan'), self._trajectory, self._cameras, 0, 10)
+            image_path = os.path.join(temp_dir, 'output', 'regular', 'image_i0000009.png')
+            self.assertTrue(plan.validate(temp_dir, [image_path], 1), msg='One byte did not fit.')
+            self.assertTrue(os.path.isdir(os.path.dirname(image_path)),
+                            msg='Output folder not created.')
+            self.assertGreater(plan.free_bytes, 0, msg='Free space not found.')
+            self.assertFalse(plan.validate(temp_dir, [image_path], plan.free_bytes * 1000),
+                             msg='Too many bytes fit.')
+            with open(file=os.path.join(plan.folder, PLAN_FILE), mode='r',
+                      encoding='utf-8') as plan_file:
+                description = json.load(plan_file)
+            self.assertEqual(description['required_bytes'], plan.free_bytes * 1000,
+                             msg='Checked size not saved.')
+            with self.assertRaises(RuntimeError, msg='Overlong file name accepted.'):
+                plan.validate(temp_dir, [os.path.join(temp_dir, 'i' * 1000 + '.png')], 1)
+            del plan
+
+    def test_empty(self) -> None:
+        """!
+        @brief Test that an empty range can be planned and validated.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            plan = JobPlan(os.path.join(temp_dir, 'plan'), self._trajectory, self._cameras, 7, 7)
+            self.assertEqual(len(plan), 0, msg='Empty plan has poses.')
+            self.assertTupleEqual(plan.pixel_poses[0].shape, (0, 3),
+                                  msg='Wrong empty pixel poses.')
+            self.assertTrue(plan.validate(temp_dir, [], 0), msg='Nothing did not fit.')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
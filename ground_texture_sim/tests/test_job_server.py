@@ -0,0 +1,188 @@
+"""!
+@brief This module tests the job_server module.
+"""
+import json
+import os
+import tempfile
+import unittest
+from types import SimpleNamespace
+from unittest.mock import call, patch
+import bpy
+from ground_texture_sim.job_server import JobServer
+
+
+class _FakeSimulator():
+    """!
+    @brief A stand in for the simulator, which records the scene settings each job starts with,
+    then changes them as its job's configuration asks.
+    """
+
+    ## The samples, color depth, compute devices, and texture file each job started with.
+    seen_settings = []
+
+    def __init__(self, args: list) -> None:
+        """!
+        @brief Read the job's configuration, and record the settings it starts with.
+        @param args The command line arguments, ending in the job's configuration JSON.
+        """
+        with open(file=args[-1], mode='r', encoding='utf-8') as job_file:
+            ## The settings the job changes.
+            self._settings = json.load(job_file)
+        scene = bpy.context.scene
+        preferences = bpy.context.preferences.addons['cycles'].preferences
+        _FakeSimulator.seen_settings.append({
+            'samples': scene.cycles.samples,
+            'color_depth': scene.render.image_settings.color_depth,
+            'compute_device_type': preferences.compute_device_type,
+            'device_use': preferences.devices[0].use,
+            'texture': bpy.data.images[0].filepath
+        })
+
+    def run(self) -> None:
+        """!
+        @brief Change the scene's settings, as configuring and caching textures does, then fail if
+        the job's configuration asks.
+        @return None
+        @exception RuntimeError raised if the job is meant to fail.
+        """
+        scene = bpy.context.scene
+        if 'samples' in self._settings:
+            scene.cycles.samples = self._settings['samples']
+            scene.render.image_settings.color_depth = '16'
+            preferences = bpy.context.preferences.addons['cycles'].preferences
+            preferences.compute_device_type = 'CUDA'
+            preferences.devices[0].use = True
+            bpy.data.images[0].filepath = '/cache/texture.png'
+        if self._settings.get('fail', False):
+            raise RuntimeError('Render failed')
+
+
+class TestJobServer(unittest.TestCase):
+    """!
+    @brief Tests the JobServer class.
+    """
+
+    def setUp(self) -> None:
+        """!
+        @brief Create a job directory to serve.
+        @return None
+        """
+        ## The temporary folder that holds the job directory.
+        self._temporary_directory = tempfile.TemporaryDirectory()
+        ## The job directory to serve.
+        self._job_directory = os.path.join(self._temporary_directory.name, 'jobs')
+        ## The class under test.
+        self._server = JobServer(self._job_directory)
+        ## A scene as loaded from a .blend file, with only the settings the tests check.
+        self._scene = SimpleNamespace(
+            cycles=SimpleNamespace(samples=64),
+            render=SimpleNamespace(image_settings=SimpleNamespace(color_depth='8')))
+        ## The Cycles preferences, with one GPU that is not used.
+        self._preferences = SimpleNamespace(
+            compute_device_type='NONE', devices=[SimpleNamespace(type='CUDA', name='GPU 0',
+                                                                 use=False)])
+        ## The scene's one texture image.
+        self._image = SimpleNamespace(name='texture', filepath='//textures/texture.jpg')
+        context = SimpleNamespace(
+            scene=self._scene,
+            preferences=SimpleNamespace(addons={
+                'cycles': SimpleNamespace(preferences=self._preferences)}))
+        ## Stands in for Blender's context while each test runs.
+        self._context_patch = patch(target='bpy.context', new=context)
+        ## Stands in for Blender's data while each test runs.
+        self._data_patch = patch(target='bpy.data', new=SimpleNamespace(images=[self._image]))
+        self._context_patch.start()
+        self._data_patch.start()
+
+    def tearDown(self) -> None:
+        """!
+        @brief Remove the job directory and stop standing in for Blender.
+        @return None
+        """
+        self._data_patch.stop()
+        self._context_patch.stop()
+        self._temporary_directory.cleanup()
+
+    def _add_job(self, name: str, settings: dict = None) -> str:
+        """!
+        @brief Place a job in the job directory.
+        @param name The file name of the job.
+        @param settings The contents of the job's JSON. If None, it is empty.
+        @return The path of the job.
+        """
+        job_path = os.path.join(self._job_directory, name)
+        with open(file=job_path, mode='w', encoding='utf-8') as job_file:
+            json.dump(settings or {}, fp=job_file)
+        return job_path
+
+    def test_failed_job(self) -> None:
+        """!
+        @brief Test that a failed job is marked as such, with a log, and does not stop later jobs.
+        @return None
+        """
+        first_job = self._add_job('a.json')
+        second_job = self._add_job('b.json')
+        with patch(target='ground_texture_sim.job_server.GroundTextureSim') as mock_simulator:
+            mock_simulator.return_value.run.side_effect = [RuntimeError('Render failed'), None]
+            self.assertEqual(self._server.run_pending_jobs(), 2, msg='Wrong job count.')
+        self.assertTrue(os.path.exists(first_job + '.failed'), msg='Failed job not marked.')
+        with open(file=first_job + '.log', mode='r', encoding='utf-8') as log_file:
+            self.assertIn('Render failed', log_file.read(), msg='Error not logged.')
+        self.assertTrue(os.path.exists(second_job + '.done'), msg='Later job not run.')
+
+    def test_jobs_run_in_order(self) -> None:
+        """!
+        @brief Test that every waiting job is claimed, run in name order, and marked done.
+        @return None
+        """
+        second_job = self._add_job('b.json')
+        first_job = self._add_job('a.json')
+        self._add_job('notes.txt')
+        with patch(target='ground_texture_sim.job_server.GroundTextureSim') as mock_simulator:
+            self.assertEqual(self._server.run_pending_jobs(), 2, msg='Wrong job count.')
+            self.assertEqual(self._server.run_pending_jobs(), 0, msg='Finished jobs run again.')
+        mock_simulator.assert_has_calls([
+            call(['--', first_job + '.running']), call().run(),
+            call(['--', second_job + '.running']), call().run()
+        ])
+        for job_path in [first_job, second_job]:
+            self.assertFalse(os.path.exists(job_path), msg='Job not claimed.')
+            self.assertTrue(os.path.exists(job_path + '.done'), msg='Job not marked done.')
+
+    def test_settings_restored(self) -> None:
+        """!
+        @brief Test that a job's changes to the scene, devices, and textures are put back, so the
+        next job starts from the settings of the .blend file, even after a failure.
+        @return None
+        """
+        self._add_job('a.json', {'samples': 512})
+        failed_job = self._add_job('b.json', {'samples': 256, 'fail': True})
+        self._add_job('c.json')
+        _FakeSimulator.seen_settings = []
+        with patch(target='ground_texture_sim.job_server.GroundTextureSim', new=_FakeSimulator):
+            self.assertEqual(self._server.run_pending_jobs(), 3, msg='Wrong job count.')
+        self.assertTrue(os.path.exists(failed_job + '.failed'), msg='Failed job not marked.')
+        blend_settings = {'samples': 64, 'color_depth': '8', 'compute_device_type': 'NONE',
+                          'device_use': False, 'texture': '//textures/texture.jpg'}
+        self.assertEqual(len(_FakeSimulator.seen_settings), 3, msg='Wrong job count.')
+        for job_settings in _FakeSimulator.seen_settings:
+            self.assertDictEqual(job_settings, blend_settings,
+                                 msg='Job did not start from the settings of the .blend file.')
+        self.assertEqual(self._image.filepath, '//textures/texture.jpg',
+                         msg='Cached texture left in place after the last job.')
+
+    def test_stop_file(self) -> None:
+        """!
+        @brief Test that no jobs start once the stop file exists.
+        @return None
+        """
+        job_path = self._add_job('a.json')
+        self._add_job('stop')
+        with patch(target='ground_texture_sim.job_server.GroundTextureSim') as mock_simulator:
+            self.assertEqual(self._server.run_pending_jobs(), 0, msg='Job run after stopping.')
+        mock_simulator.assert_not_called()
+        self.assertTrue(os.path.exists(job_path), msg='Job claimed after stopping.')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
@@ -0,0 +1,225 @@
+"""!
+@brief This module tests the mosaic module.
+"""
+import os
+import struct
+import tempfile
+import unittest
+import zlib
+import numpy
+from ground_texture_sim.mosaic import MosaicPlanner, TiledTiffWriter, read_bmp
+from ground_texture_sim.transforms import Transformer, create_transform_matrix
+
+
+def _create_bmp(pixels: numpy.ndarray, top_down: bool) -> bytes:
+    """!
+    @brief Build a 24 bit BMP, padding each row to a multiple of 4 bytes.
+    @param pixels An HxWx3 array of 8 bit RGB values, top row first.
+    @param top_down If true, store the rows top down with a negative height, else bottom up.
+    @return The bytes of the BMP file.
+    """
+    height, width, _ = pixels.shape
+    row_size = (width * 3 + 3) // 4 * 4
+    rows = pixels if top_down else pixels[::-1]
+    data = b''.join(row[:, ::-1].tobytes().ljust(row_size, b'\x00') for row in rows)
+    info_header = struct.pack('<IiiHHIIiiII', 40, width, -height if top_down else height, 1, 24,
+                              0, len(data), 0, 0, 0, 0)
+    file_header = b'BM' + struct.pack('<IHHI', 54 + len(data), 0, 0, 54)
+    return file_header + info_header + data
+
+
+def _read_tiff(data: bytes) -> tuple:
+    """!
+    @brief Read back the tags and tiles of a BigTIFF written by TiledTiffWriter.
+    @param data The bytes of the file.
+    @return A dictionary of tag values keyed by tag, and the list of raw tile data.
+    """
+    directory_offset = struct.unpack_from('<Q', data, 8)[0]
+    entry_count = struct.unpack_from('<Q', data, directory_offset)[0]
+    sizes = {3: ('H', 2), 4: ('I', 4), 16: ('Q', 8)}
+    tags = {}
+    for entry in range(entry_count):
+        position = directory_offset + 8 + entry * 20
+        tag, field_type, count = struct.unpack_from('<HHQ', data, position)
+        value_format, size = sizes[field_type]
+        value_position = position + 12
+        if count * size > 8:
+            value_position = struct.unpack_from('<Q', data, value_position)[0]
+        tags[tag] = list(struct.unpack_from(F'<{count}{value_format}', data, value_position))
+    tiles = [data[offset:offset + count] for offset, count in zip(tags[324], tags[325])]
+    return tags, tiles
+
+
+class TestReadBMP(unittest.TestCase):
+    """!
+    @brief Tests the read_bmp function.
+    """
+
+    def test_row_orders(self) -> None:
+        """!
+        @brief Test that both row orders are read top row first, as RGB, without row padding.
+        @return None
+        """
+        pixels = numpy.arange(2 * 3 * 3, dtype=numpy.uint8).reshape((2, 3, 3))
+        with tempfile.TemporaryDirectory() as directory:
+            file_path = os.path.join(directory, 'tile.bmp')
+            for top_down in [False, True]:
+                with open(file=file_path, mode='wb') as bmp_file:
+                    bmp_file.write(_create_bmp(pixels, top_down))
+                self.assertTrue(numpy.array_equal(read_bmp(file_path), pixels),
+                                msg=F'Pixels wrong when top down is {top_down}.')
+
+    def test_reject_not_bmp(self) -> None:
+        """!
+        @brief Test that files which are not BMPs raise an exception.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as directory:
+            file_path = os.path.join(directory, 'tile.bmp')
+            with open(file=file_path, mode='wb') as bmp_file:
+                bmp_file.write(b'not a bmp' * 10)
+            with self.assertRaises(ValueError, msg='Non BMP data not rejected.'):
+                read_bmp(file_path)
+
+
+class TestTiledTiffWriter(unittest.TestCase):
+    """!
+    @brief Tests the TiledTiffWriter class.
+    """
+
+    def test_tiles_written(self) -> None:
+        """!
+        @brief Test that tiles written out of order are all found, padded, and described.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as directory:
+            file_path = os.path.join(directory, 'mosaic.tif')
+            writer = TiledTiffWriter(file_path, 40, 20, 16, compress=True)
+            self.assertEqual((writer.tiles_across, writer.tiles_down), (3, 2),
+                             msg='Wrong tile grid.')
+            for index in reversed(range(6)):
+                row, column = index // 3, index % 3
+                height = 16 if row == 0 else 4
+                width = 16 if column < 2 else 8
+                writer.write_tile(row, column, numpy.full((height, width, 3), index + 1,
+                                                          dtype=numpy.uint8))
+            writer.close()
+            with open(file=file_path, mode='rb') as tiff_file:
+                data = tiff_file.read()
+        self.assertEqual(data[0:4], b'II+\x00', msg='Not a little endian BigTIFF.')
+        tags, tiles = _read_tiff(data)
+        self.assertListEqual(tags[256], [40], msg='Wrong width.')
+        self.assertListEqual(tags[257], [20], msg='Wrong height.')
+        self.assertListEqual(tags[259], [8], msg='Not Deflate compressed.')
+        self.assertListEqual(tags[322], [16], msg='Wrong tile width.')
+        self.assertEqual(len(tiles), 6, msg='Wrong tile count.')
+        last_tile = numpy.frombuffer(zlib.decompress(tiles[5]), dtype=numpy.uint8).reshape(
+            (16, 16, 3))
+        self.assertTrue(numpy.all(last_tile[0:4, 0:8] == 6), msg='Tile pixels wrong.')
+        self.assertTrue(numpy.all(last_tile[4:, :] == 0), msg='Tile not padded.')
+        self.assertTrue(numpy.all(last_tile[:, 8:] == 0), msg='Tile not padded.')
+
+    def test_missing_tile(self) -> None:
+        """!
+        @brief Test that closing before every tile is written raises an exception.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as directory:
+            writer = TiledTiffWriter(os.path.join(directory, 'mosaic.tif'), 32, 16, 16, False)
+            writer.write_tile(0, 0, numpy.zeros((16, 16, 3), dtype=numpy.uint8))
+            with self.assertRaises(RuntimeError, msg='Missing tile not reported.'):
+                writer.close()
+
+    def test_reject_bad_tiles(self) -> None:
+        """!
+        @brief Test that bad tile sizes, positions, and shapes raise exceptions.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as directory:
+            file_path = os.path.join(directory, 'mosaic.tif')
+            with self.assertRaises(ValueError, msg='Tile size not a multiple of 16 accepted.'):
+                TiledTiffWriter(file_path, 32, 32, 20)
+            writer = TiledTiffWriter(file_path, 32, 32, 16)
+            with self.assertRaises(ValueError, msg='Tile outside the image accepted.'):
+                writer.write_tile(2, 0, numpy.zeros((16, 16, 3), dtype=numpy.uint8))
+            with self.assertRaises(ValueError, msg='Tile larger than the tile size accepted.'):
+                writer.write_tile(0, 0, numpy.zeros((17, 16, 3), dtype=numpy.uint8))
+            for index in range(4):
+                writer.write_tile(index // 2, index % 2, numpy.zeros((16, 16, 3), numpy.uint8))
+            writer.close()
+
+
+class TestMosaicPlanner(unittest.TestCase):
+    """!
+    @brief Tests the MosaicPlanner class.
+    """
+
+    def setUp(self) -> None:
+        """!
+        @brief Create a transformer for a camera facing straight down, with square pixels.
+        @return None
+        """
+        camera_matrix = numpy.array([
+            [1000.0, 0.0, 320.0],
+            [0.0, 1000.0, 240.0],
+            [0.0, 0.0, 1.0]
+        ])
+        ## The transformer of the downward facing camera.
+        self._transformer = Transformer(
+            create_transform_matrix(0.0, 0.0, 0.5, 0.0, numpy.pi / 2.0, 0.0), camera_matrix)
+
+    def test_layout(self) -> None:
+        """!
+        @brief Test that the mosaic covers the area, at the global image's scale.
+        @return None
+        """
+        planner = MosaicPlanner(self._transformer, (-1.0, 1.0), (-0.5, 0.5), 256)
+        self.assertAlmostEqual(planner.meters_per_pixel, 0.0005, msg='Wrong scale.')
+        # The global image's X follows the world's -Y, and its Y follows the world's -X.
+        self.assertEqual((planner.width, planner.height), (2000, 4000), msg='Wrong size.')
+        self.assertEqual((planner.tiles_across, planner.tiles_down), (8, 16),
+                         msg='Wrong tile grid.')
+        self.assertEqual(planner.tile_count, 128, msg='Wrong tile count.')
+        self.assertAlmostEqual(planner.orthographic_scale, 0.128, msg='Wrong tile width.')
+        self.assertTupleEqual(planner.tile_shape(127), (160, 208), msg='Edge tile not clipped.')
+        self.assertTupleEqual(planner.pixel_origin, (-680, -1760),
+                              msg='Mosaic origin is not the area corner in the global image.')
+        self.assertListEqual(planner.metadata()['pixel_origin'], list(planner.pixel_origin),
+                             msg='Metadata origin wrong.')
+
+    def test_tile_camera_pose(self) -> None:
+        """!
+        @brief Test that each tile's camera sees the center of its tile, with the image axes of the
+        global image.
+        @return None
+        """
+        planner = MosaicPlanner(self._transformer, (-1.0, 1.0), (-0.5, 0.5), 256)
+        index = 21
+        row, column = planner.tile_position(index)
+        pose = planner.tile_camera_pose(index)
+        center = self._transformer.project_ground_points(pose[numpy.newaxis, 0:2, 3])[0]
+        expected_center = [planner.pixel_origin[0] + (column + 0.5) * 256,
+                           planner.pixel_origin[1] + (row + 0.5) * 256]
+        self.assertTrue(numpy.allclose(center, expected_center), msg='Camera not over its tile.')
+        self.assertAlmostEqual(pose[2, 3], 0.5, msg='Camera not at the configured height.')
+        # The camera looks along its X axis, which must point straight down.
+        self.assertTrue(numpy.allclose(pose[0:3, 0], [0.0, 0.0, -1.0], atol=1e-4),
+                        msg='Camera not facing down.')
+        image_pose = pose @ self._transformer.image_2_camera
+        step = self._transformer.project_ground_points(
+            (pose[0:2, 3] + image_pose[0:2, 0] * planner.meters_per_pixel)[numpy.newaxis])[0]
+        self.assertTrue(numpy.allclose(step - center, [1.0, 0.0]),
+                        msg='Image X axis does not follow the global image.')
+
+    def test_reject_tilted_camera(self) -> None:
+        """!
+        @brief Test that a camera that is not facing straight down is rejected.
+        @return None
+        """
+        self._transformer.camera_pose = create_transform_matrix(0.0, 0.0, 0.5, 0.0, 1.0, 0.0)
+        with self.assertRaises(ValueError, msg='Tilted camera not rejected.'):
+            MosaicPlanner(self._transformer, (-1.0, 1.0), (-0.5, 0.5), 256)
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
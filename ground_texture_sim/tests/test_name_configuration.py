@@ -2,6 +2,8 @@
 @brief This module tests the name_configuration module
 """
 import datetime
+import fnmatch
+import os
 import unittest
 from ground_texture_sim.name_configuration import NameConfigurator
 
@@ -24,6 +26,17 @@ class TestNameConfigurator(unittest.TestCase):
         ## The current date formatted as expected for image names.
         self._date_file = current_date.strftime("%Y-%m-%d")
 
+    def test_checkpoint_file_correct(self) -> None:
+        """!
+        @brief Test that the checkpoint manifests are named correctly.
+        @return None
+        """
+        expected_path = F'regular_{self._date_folder}_i0000005_i0000010.checkpoint'
+        self.assertEqual(self._namer.checkpoint_file(5, 10), expected_path,
+                         msg='Checkpoint file not named correctly.')
+        self.assertTrue(fnmatch.fnmatch(expected_path, self._namer.checkpoint_file_pattern),
+                        msg='Checkpoint pattern does not match the file name.')
+
     def test_create_image_path_absolute(self) -> None:
         """!
         @brief Ensure that create_image_path returns an absolute file path when specified.
@@ -35,6 +48,31 @@ class TestNameConfigurator(unittest.TestCase):
         self.assertEqual(image_path, expected_path,
                          msg='image_path is not absolute.')
 
+    def test_collection_date(self) -> None:
+        """!
+        @brief Ensure that a given collection date names everything, whatever day it is now.
+        @return None
+        """
+        namer = NameConfigurator('/blah/output', 'regular', 3, 2, 'c01',
+                                 collection_date=datetime.date(2026, 10, 14))
+        self.assertEqual(namer.create_image_path(5), 'regular/261014/seq0003/'
+                         'HDG2_t002_regular_2026-10-14_s0003_c01_i0000005.png',
+                         msg='Image not named by the collection date.')
+        self.assertEqual(namer.txt_file, 'regular_261014.txt',
+                         msg='Lists not named by the collection date.')
+
+    def test_create_image_path_extension(self) -> None:
+        """!
+        @brief Ensure that create_image_path uses the configured image extension.
+        @return None
+        """
+        namer = NameConfigurator('/blah/output', 'regular', 3, 2, 'c01', 'exr')
+        image_path = namer.create_image_path(5, absolute=False)
+        expected_path = F'regular/{self._date_folder}/seq0003/' \
+            F'HDG2_t002_regular_{self._date_file}_s0003_c01_i0000005.exr'
+        self.assertEqual(image_path, expected_path,
+                         msg='image_path does not use the extension.')
+
     def test_create_image_path_relative(self) -> None:
         """!
         @brief Ensure that create_image_path returns a relative file path when specified.
@@ -55,6 +93,100 @@ class TestNameConfigurator(unittest.TestCase):
         self.assertEqual(self._namer.meters_txt_file, expected_path,
                          msg='_meters.txt file not named correctly.')
 
+    def test_partial_file_correct(self) -> None:
+        """!
+        @brief Test that partial result files are named by their index range and match the pattern.
+        @return None
+        """
+        expected_path = F'partial_results/regular_{self._date_folder}_i0000010_i0000020.npy'
+        self.assertEqual(self._namer.partial_file(10, 20), expected_path,
+                         msg='Partial result file not named correctly.')
+        self.assertTrue(fnmatch.fnmatch(expected_path, self._namer.partial_file_pattern),
+                        msg='Partial result pattern does not match the file name.')
+
+    def test_pose_records_file_correct(self) -> None:
+        """!
+        @brief Test that the pose records file is named after the lists.
+        @return None
+        """
+        self.assertEqual(self._namer.pose_records_file, F'regular_{self._date_folder}_poses.bin',
+                         msg='Pose records file not named correctly.')
+
+    def test_shard_files_correct(self) -> None:
+        """!
+        @brief Test that shards and their indices are named by range and match the pattern.
+        @return None
+        """
+        self.assertEqual(self._namer.shard_file(10, 2),
+                         F'shards/regular_{self._date_folder}_i0000010_s00002.tar',
+                         msg='Shard not named correctly.')
+        self.assertEqual(self._namer.shard_index_file, F'regular_{self._date_folder}_shards.txt',
+                         msg='Shard index not named correctly.')
+        part_path = self._namer.shard_index_part_file(10)
+        self.assertEqual(part_path, F'shards/regular_{self._date_folder}_i0000010.idx',
+                         msg='Range shard index not named correctly.')
+        self.assertTrue(fnmatch.fnmatch(part_path, self._namer.shard_index_part_pattern),
+                        msg='Range shard index pattern does not match the file name.')
+
+    def test_render_settings_file_correct(self) -> None:
+        """!
+        @brief Test that the render settings file is named correctly.
+        @return None
+        """
+        self.assertEqual(self._namer.render_settings_file,
+                         F'regular_{self._date_folder}_render_settings.json',
+                         msg='Render settings file not named correctly.')
+
+    def test_mosaic_files_correct(self) -> None:
+        """!
+        @brief Test that the mosaic, its metadata, and its tiles are named correctly.
+        @return None
+        """
+        base_name = F'regular_{self._date_folder}'
+        self.assertEqual(self._namer.mosaic_file, F'{base_name}_mosaic.tif',
+                         msg='Mosaic file not named correctly.')
+        self.assertEqual(self._namer.mosaic_metadata_file, F'{base_name}_mosaic.json',
+                         msg='Mosaic metadata file not named correctly.')
+        self.assertEqual(self._namer.mosaic_tile_file(12),
+                         os.path.join('mosaic_tiles', F'{base_name}_t0000012.bmp'),
+                         msg='Mosaic tile not named correctly.')
+
+    def test_coverage_files_correct(self) -> None:
+        """!
+        @brief Test that the dry run's report and raster are named correctly.
+        @return None
+        """
+        base_name = F'regular_{self._date_folder}'
+        self.assertEqual(self._namer.coverage_report_file, F'{base_name}_coverage.json',
+                         msg='Coverage report not named correctly.')
+        self.assertEqual(self._namer.coverage_raster_file, F'{base_name}_coverage.npy',
+                         msg='Coverage raster not named correctly.')
+
+    def test_separate_lists(self) -> None:
+        """!
+        @brief Test that separate lists add the camera name to per camera files, but not others.
+        @return None
+        """
+        namer = NameConfigurator('/blah/output', 'regular', 3, 2, 'c01', separate_lists=True)
+        base_name = F'regular_{self._date_folder}'
+        self.assertEqual(namer.test_file, F'{base_name}_c01.test', msg='.test file not separate.')
+        self.assertEqual(namer.txt_file, F'{base_name}_c01.txt', msg='.txt file not separate.')
+        self.assertEqual(namer.meters_txt_file, F'{base_name}_c01_meters.txt',
+                         msg='_meters.txt file not separate.')
+        self.assertEqual(namer.checkpoint_file(0, 5),
+                         F'{base_name}_c01_i0000000_i0000005.checkpoint',
+                         msg='Checkpoint file not separate.')
+        self.assertFalse(fnmatch.fnmatch(self._namer.checkpoint_file(0, 5),
+                                         namer.checkpoint_file_pattern),
+                         msg='Checkpoint pattern matches another camera.')
+        self.assertTrue(fnmatch.fnmatch(namer.partial_file(0, 5), namer.partial_file_pattern),
+                        msg='Partial result pattern does not match the file name.')
+        self.assertFalse(fnmatch.fnmatch(self._namer.partial_file(0, 5),
+                                         namer.partial_file_pattern),
+                         msg='Partial result pattern matches another camera.')
+        self.assertEqual(namer.timing_file(), F'{base_name}_timing.json',
+                         msg='Timing report should cover every camera.')
+
     def test_test_file_correct(self) -> None:
         """!
         @brief Test that the .test file is named correctly.
@@ -64,6 +196,39 @@ class TestNameConfigurator(unittest.TestCase):
         self.assertEqual(self._namer.test_file, expected_path,
                          msg='.test file not named correctly.')
 
+    def test_timing_file_correct(self) -> None:
+        """!
+        @brief Test that timing reports are named correctly, with the range for workers.
+        @return None
+        """
+        self.assertEqual(self._namer.timing_file(), F'regular_{self._date_folder}_timing.json',
+                         msg='Timing report not named correctly.')
+        self.assertEqual(self._namer.timing_file(10, 20),
+                         F'regular_{self._date_folder}_timing_i0000010_i0000020.json',
+                         msg='Worker timing report not named correctly.')
+
+    def test_plan_folder_correct(self) -> None:
+        """!
+        @brief Test that plan folders are named correctly, with the range for workers.
+        @return None
+        """
+        self.assertEqual(self._namer.plan_folder(), os.path.join(
+            'plan', F'regular_{self._date_folder}'), msg='Plan folder not named correctly.')
+        self.assertEqual(self._namer.plan_folder(10, 20), os.path.join(
+            'plan', F'regular_{self._date_folder}_i0000010_i0000020'),
+            msg='Worker plan folder not named correctly.')
+
+    def test_status_file_correct(self) -> None:
+        """!
+        @brief Test that status files are named correctly, with the range for workers.
+        @return None
+        """
+        self.assertEqual(self._namer.status_file(), F'regular_{self._date_folder}_status.json',
+                         msg='Status file not named correctly.')
+        self.assertEqual(self._namer.status_file(10, 20),
+                         F'regular_{self._date_folder}_status_i0000010_i0000020.json',
+                         msg='Worker status file not named correctly.')
+
     def test_txt_file_correct(self) -> None:
         """!
         @brief Test that the .txt file is named correctly.
@@ -0,0 +1,154 @@
+"""!
+This module tests the preview_interface module.
+"""
+import unittest
+from unittest.mock import MagicMock, PropertyMock, patch
+import numpy
+from ground_texture_sim.preview_interface import PreviewInterface
+from ground_texture_sim.transforms import Transformer, create_transform_matrix
+
+
+class _FakePixels():
+    """!
+    @brief Pixels of a fake Blender image, which copy themselves into a buffer like Blender's do.
+    """
+
+    def __init__(self, pixels: numpy.ndarray) -> None:
+        """!
+        @brief Hold the pixels.
+        @param pixels The pixels, bottom row first, in any shape.
+        """
+        ## The pixels, bottom row first.
+        self._pixels = pixels
+
+    def foreach_get(self, buffer: numpy.ndarray) -> None:
+        """!
+        @brief Copy every pixel into the buffer.
+        @param buffer A flat buffer the size of every channel of every pixel.
+        @return None
+        """
+        buffer[:] = self._pixels.ravel()
+
+
+class TestPreviewInterface(unittest.TestCase):
+    """!
+    Tests the PreviewInterface class.
+    """
+
+    def setUp(self) -> None:
+        """!
+        @brief Create a 2x2 RGBA texture, whose texels are each a different color.
+        @return None
+        """
+        ## The texture, bottom row first, as Blender stores it.
+        self._texture = numpy.array([
+            [[0.0, 0.2, 0.4, 1.0], [0.6, 0.8, 1.0, 1.0]],
+            [[1.0, 0.0, 0.0, 1.0], [0.0, 0.0, 1.0, 1.0]]
+        ], dtype=numpy.float32)
+
+    def _create_data(self) -> MagicMock:
+        """!
+        @brief Create fake Blender data with a camera and a 2 meter square ground, centered on the
+        origin, whose material has a diffuse texture and a roughness texture.
+        @return The fake data.
+        """
+        data = MagicMock()
+        data.cameras.keys.return_value = ['Camera']
+        ground = MagicMock()
+        ground.bound_box = [(x, y, z) for x in [-1.0, 1.0] for y in [-1.0, 1.0] for z in [0.0, 0.1]]
+        ground.matrix_world = numpy.identity(4).tolist()
+        roughness = MagicMock(type='TEX_IMAGE', label='')
+        roughness.name = 'Roughness'
+        roughness.image.name = 'floor_rough.png'
+        diffuse = MagicMock(type='TEX_IMAGE', label='Color')
+        diffuse.name = 'Image Texture'
+        diffuse.image.name = 'floor_diffuse.png'
+        diffuse.image.size = (2, 2)
+        diffuse.image.channels = 4
+        diffuse.image.pixels = _FakePixels(self._texture)
+        ground.active_material.node_tree.nodes = [roughness, diffuse]
+        data.objects.keys.return_value = ['Camera', 'Ground']
+        data.objects.__getitem__.return_value = ground
+        return data
+
+    def test_preview_image(self) -> None:
+        """!
+        @brief Test that each pixel takes the color of the texel it sees, and that previews after
+        the first reuse the loaded texture.
+        @return None
+        """
+        # Each pixel's ray lands on the center of a texel, so nothing is blended.
+        camera_matrix = numpy.array([[1.0, 0.0, 1.0], [0.0, 1.0, 1.0], [0.0, 0.0, 1.0]])
+        camera_pose = create_transform_matrix(0.0, 0.0, 1.0, 0.0, numpy.pi / 2.0, 0.0)
+        floor_points = Transformer(camera_pose, camera_matrix).project_pixels_to_robot(
+            [[0.5, 0.5], [1.5, 0.5], [0.5, 1.5], [1.5, 1.5]])
+        data = self._create_data()
+        with patch(target='bpy.data', new=data), patch(target='bpy.context') as context, \
+                patch.object(PreviewInterface, 'camera_intrinsic_matrix',
+                             new_callable=PropertyMock, return_value=camera_matrix), \
+                patch.object(PreviewInterface, 'render_resolution', new_callable=PropertyMock,
+                             return_value=(2, 2, 100)):
+            context.scene.render.image_settings.color_depth = '8'
+            interface = PreviewInterface()
+            with self.assertRaises(RuntimeError, msg='Preview without a pose accepted.'):
+                interface.preview_image()
+            interface.place_camera(camera_pose)
+            pixels = interface.preview_image()
+            self.assertTupleEqual(pixels.shape, (2, 2, 3), msg='Wrong image shape.')
+            self.assertEqual(pixels.dtype, numpy.uint8, msg='Wrong pixel type.')
+            for pixel, point in zip(pixels.reshape((-1, 3)), floor_points):
+                texel = self._texture[int(point[1] > 0.0), int(point[0] > 0.0), 0:3]
+                numpy.testing.assert_array_equal(pixel, numpy.rint(texel * 255.0))
+            # Looking at the floor from far enough to the side misses it entirely.
+            interface.place_camera(create_transform_matrix(5.0, 0.0, 1.0, 0.0, numpy.pi / 2.0,
+                                                           0.0))
+            self.assertEqual(interface.preview_image().max(), 0, msg='Missed floor not black.')
+            # Looking at the horizon never reaches the floor either.
+            interface.place_camera(create_transform_matrix(0.0, 0.0, 1.0, 0.0, 0.0, 0.0))
+            self.assertEqual(interface.preview_image().max(), 0, msg='Horizon not black.')
+            data.images.load.assert_not_called()
+
+    def test_find_texture(self) -> None:
+        """!
+        @brief Test that the diffuse texture is found among the ground's material nodes, and that
+        an exception is raised if there is none.
+        @return None
+        """
+        data = self._create_data()
+        ground = data.objects['Ground']
+        with patch(target='bpy.data', new=data):
+            interface = PreviewInterface()
+            nodes = ground.active_material.node_tree.nodes
+            self.assertIs(interface._find_ground_texture(ground), nodes[1].image,
+                          msg='Diffuse texture not found by image name.')
+            ground.active_material.node_tree.nodes = [nodes[0]]
+            self.assertIs(interface._find_ground_texture(ground), nodes[0].image,
+                          msg='Only texture not used.')
+            ground.active_material.node_tree.nodes = []
+            with self.assertRaises(RuntimeError, msg='Missing texture not reported.'):
+                interface._find_ground_texture(ground)
+
+    def test_render_animation(self) -> None:
+        """!
+        @brief Test that each frame is previewed to a numbered PNG, and that relative paths are
+        rejected.
+        @return None
+        """
+        with patch(target='bpy.data', new=self._create_data()), \
+                patch.object(PreviewInterface, 'render_image') as render_image:
+            interface = PreviewInterface()
+            poses = numpy.stack([numpy.identity(4)] * 2)
+            frame_paths = interface.render_animation('/tmp/frames/Camera_####', poses)
+            self.assertListEqual(frame_paths, ['/tmp/frames/Camera_0001.png',
+                                               '/tmp/frames/Camera_0002.png'],
+                                 msg='Wrong frame paths.')
+            render_image.assert_called_with('/tmp/frames/Camera_0002.png')
+            with self.assertRaises(ValueError, msg='Relative frame path accepted.'):
+                interface.render_animation('frames/Camera_####', poses)
+        with patch(target='bpy.data', new=self._create_data()):
+            with self.assertRaises(ValueError, msg='Relative image path accepted.'):
+                PreviewInterface().render_image('frames/Camera_0001.png')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
@@ -0,0 +1,67 @@
+"""!
+@brief This module tests the shard_writer module.
+"""
+import os
+import tarfile
+import tempfile
+import unittest
+from ground_texture_sim.name_configuration import NameConfigurator
+from ground_texture_sim.shard_writer import ShardWriter, read_shard_index, write_shard_index
+
+
+class TestShardWriter(unittest.TestCase):
+    """!
+    @brief Tests the ShardWriter class and the shard index functions.
+    """
+
+    def test_shards(self) -> None:
+        """!
+        @brief Test that images are packed, their offsets point at their bytes, and ranges join.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as output_folder:
+            namer = NameConfigurator(output_folder, 'regular', 3, 1, 'c55')
+            contents = {i: bytes([i]) * (100 + 700 * i) for i in range(5)}
+            # Two ranges, as two workers would render, with the first skipping image 2 by reuse.
+            for start_index, indices in [(0, [0, 1, 2]), (3, [3, 4])]:
+                writer = ShardWriter(output_folder, namer, start_index, 2, True)
+                for i in indices:
+                    if i == 2:
+                        writer.reuse(1, 2)
+                        continue
+                    image_path = os.path.join(output_folder, F'staged_{i}.png')
+                    with open(file=image_path, mode='wb') as image_file:
+                        image_file.write(contents[i])
+                    writer.add(i, image_path)
+                    self.assertFalse(os.path.exists(image_path), msg='Packed image not removed.')
+                writer.close()
+            write_shard_index(output_folder, namer)
+            index = read_shard_index(os.path.join(output_folder, namer.shard_index_file))
+            self.assertListEqual(sorted(index.keys()), list(range(5)), msg='Images missing.')
+            self.assertListEqual(sorted({entry[1] for entry in index.values()}), [
+                namer.shard_file(0, 0), namer.shard_file(3, 0)], msg='Wrong shards.')
+            for i, (image_path, shard_name, offset, size) in index.items():
+                self.assertEqual(image_path, namer.create_image_path(i), msg='Wrong image path.')
+                with open(file=os.path.join(output_folder, shard_name), mode='rb') as shard_file:
+                    shard_file.seek(offset)
+                    data = shard_file.read(size)
+                self.assertEqual(data, contents[1 if i == 2 else i], msg=F'Image {i} bytes wrong.')
+            with tarfile.open(os.path.join(output_folder, namer.shard_file(0, 0))) as shard:
+                self.assertListEqual(shard.getnames(), [namer.create_image_path(0),
+                                                        namer.create_image_path(1)],
+                                     msg='Members not named by image path.')
+
+    def test_reuse_unknown(self) -> None:
+        """!
+        @brief Test that reusing an image that was not packed raises an exception.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as output_folder:
+            namer = NameConfigurator(output_folder, 'regular', 3, 1, 'c55')
+            writer = ShardWriter(output_folder, namer, 0, 2)
+            with self.assertRaises(RuntimeError, msg='Untracked reuse not rejected.'):
+                writer.reuse(0, 1)
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
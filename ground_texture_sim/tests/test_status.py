@@ -0,0 +1,169 @@
+"""!
+@brief This module tests the status module.
+"""
+import os
+import tempfile
+import time
+import unittest
+from ground_texture_sim.status import LATENCY_BUCKETS, StatusReporter, format_prometheus, \
+    read_status
+from ground_texture_sim.timing import StageTimer
+
+
+class TestStatusReporter(unittest.TestCase):
+    """!
+    @brief Tests the StatusReporter class.
+    """
+
+    def test_disabled(self) -> None:
+        """!
+        @brief Test that a reporter without an interval writes nothing.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            file_path = os.path.join(temp_dir, 'status.json')
+            with StatusReporter(file_path, 10, prometheus=True) as status:
+                status.update(5)
+            self.assertListEqual(os.listdir(temp_dir), [], msg='Disabled reporter wrote files.')
+
+    def test_status(self) -> None:
+        """!
+        @brief Test that the status holds the progress, assignment, and stage latencies, and is
+        marked finished at the end.
+        @return None
+        """
+        timer = StageTimer(bucket_bounds=LATENCY_BUCKETS)
+        timer.record('render', 0.2)
+        timer.record('render', 2.0)
+        with tempfile.TemporaryDirectory() as temp_dir:
+            file_path = os.path.join(temp_dir, 'output', 'status.json')
+            with StatusReporter(file_path, 10, 60.0, timer, True,
+                                {'device_type': 'CUDA', 'device_indices': [1]},
+                                {'start': '0'}) as status:
+                status.update(4)
+                status.write()
+                running = read_status(file_path)
+            finished = read_status(file_path)
+            with open(file=os.path.join(temp_dir, 'output', 'status.prom'), mode='r',
+                      encoding='utf-8') as prometheus_file:
+                prometheus_text = prometheus_file.read()
+        self.assertEqual(running['state'], 'running', msg='Running status not written.')
+        self.assertEqual(running['frames']['done'], 4, msg='Wrong frames done.')
+        self.assertEqual(running['frames']['total'], 10, msg='Wrong frame total.')
+        self.assertEqual(running['assignment']['device_indices'], [1], msg='Wrong assignment.')
+        self.assertEqual(running['stages']['render']['count'], 2, msg='Wrong stage count.')
+        self.assertEqual(running['stages']['render']['buckets'][LATENCY_BUCKETS.index(0.5)], 1,
+                         msg='Wrong bucket count.')
+        self.assertEqual(finished['state'], 'finished', msg='Final status not written.')
+        self.assertEqual(finished['errors'], 0, msg='Errors counted without any.')
+        self.assertIn('ground_texture_sim_frames_done{start="0"} 4', prometheus_text,
+                      msg='Prometheus status not written.')
+
+    def test_failed(self) -> None:
+        """!
+        @brief Test that an exception leaving the block marks the run failed and counts an error.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            file_path = os.path.join(temp_dir, 'status.json')
+            with self.assertRaises(RuntimeError, msg='Exception swallowed.'):
+                with StatusReporter(file_path, 10, 60.0):
+                    raise RuntimeError('Render failed')
+            status = read_status(file_path)
+        self.assertEqual(status['state'], 'failed', msg='Failure not recorded.')
+        self.assertEqual(status['errors'], 1, msg='Failure not counted.')
+
+    def test_background(self) -> None:
+        """!
+        @brief Test that the status is rewritten in the background between updates.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            file_path = os.path.join(temp_dir, 'status.json')
+            with StatusReporter(file_path, 10, 0.01) as status:
+                status.update(7)
+                deadline = time.perf_counter() + 5.0
+                done = 0
+                while done != 7 and time.perf_counter() < deadline:
+                    time.sleep(0.01)
+                    done = read_status(file_path)['frames']['done']
+            self.assertEqual(done, 7, msg='Status not rewritten in the background.')
+            self.assertListEqual(os.listdir(temp_dir), ['status.json'],
+                                 msg='Temporary file left behind.')
+
+    def test_workers(self) -> None:
+        """!
+        @brief Test that the progress, errors, and stages of workers are added to the status, and
+        that a worker that crashed counts as failed.
+        @return None
+        """
+        worker_timer = StageTimer(bucket_bounds=LATENCY_BUCKETS)
+        worker_timer.record('render', 1.0)
+        timer = StageTimer(bucket_bounds=LATENCY_BUCKETS)
+        timer.record('render', 3.0)
+        with tempfile.TemporaryDirectory() as temp_dir:
+            worker_path = os.path.join(temp_dir, 'status_i0000000_i0000005.json')
+            missing_path = os.path.join(temp_dir, 'status_i0000005_i0000010.json')
+            with StatusReporter(worker_path, 5, 60.0, worker_timer) as worker_status:
+                worker_status.update(5)
+            status = StatusReporter(os.path.join(temp_dir, 'status.json'), 10, 60.0, timer)
+            status.set_workers([
+                {'range': [0, 5], 'device_index': 0, 'pid': 10, 'status_file': worker_path},
+                {'range': [5, 10], 'device_index': 1, 'pid': 11, 'status_file': missing_path}
+            ])
+            snapshot = status.snapshot()
+            self.assertEqual(snapshot['frames']['done'], 5, msg='Worker progress not added.')
+            self.assertEqual(snapshot['errors'], 0, msg='Running worker counted as an error.')
+            self.assertEqual(snapshot['stages']['render']['count'], 2,
+                             msg='Worker stages not added.')
+            self.assertAlmostEqual(snapshot['stages']['render']['sum'], 4.0,
+                                   msg='Worker stage durations not added.')
+            workers = snapshot['assignment']['workers']
+            self.assertEqual(workers[0]['state'], 'finished', msg='Wrong worker state.')
+            self.assertEqual(workers[1]['state'], 'starting', msg='Wrong waiting worker state.')
+            status.finish_worker(1, 1)
+            snapshot = status.snapshot()
+            self.assertEqual(snapshot['assignment']['workers'][1]['state'], 'failed',
+                             msg='Crashed worker not failed.')
+            self.assertEqual(snapshot['errors'], 1, msg='Crashed worker not counted.')
+
+
+class TestFormatPrometheus(unittest.TestCase):
+    """!
+    @brief Tests the format_prometheus function.
+    """
+
+    def test_format(self) -> None:
+        """!
+        @brief Test that gauges, the error counter, and histograms are formatted, with escaped
+        labels.
+        @return None
+        """
+        status = {
+            'state': 'running',
+            'updated': 100.0,
+            'frames': {'done': 3, 'total': 9, 'per_second': 1.5},
+            'errors': 2,
+            'assignment': {'workers': []},
+            'stages': {'render': {'count': 3, 'sum': 4.5,
+                                  'buckets': [0] * (len(LATENCY_BUCKETS) - 1) + [3]}}
+        }
+        lines = format_prometheus(status, {'output': 'C:\\data "a"'}).splitlines()
+        labels = 'output="C:\\\\data \\"a\\""'
+        self.assertIn(F'ground_texture_sim_frames_done{{{labels}}} 3', lines,
+                      msg='Frames done missing.')
+        self.assertIn(F'ground_texture_sim_running{{{labels}}} 1', lines, msg='Running missing.')
+        self.assertIn('# TYPE ground_texture_sim_errors_total counter', lines,
+                      msg='Error counter type missing.')
+        self.assertIn(F'ground_texture_sim_errors_total{{{labels}}} 2', lines,
+                      msg='Error count missing.')
+        self.assertIn(F'ground_texture_sim_stage_seconds_bucket{{{labels},stage="render",'
+                      F'le="300.0"}} 3', lines, msg='Last bucket missing.')
+        self.assertIn(F'ground_texture_sim_stage_seconds_bucket{{{labels},stage="render",'
+                      F'le="+Inf"}} 3', lines, msg='Infinite bucket missing.')
+        self.assertIn(F'ground_texture_sim_stage_seconds_sum{{{labels},stage="render"}} 4.5',
+                      lines, msg='Stage sum missing.')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
@@ -0,0 +1,87 @@
+"""!
+@brief This module tests the sweep_runner module.
+"""
+import json
+import os
+import tempfile
+import unittest
+from unittest.mock import call, patch
+from ground_texture_sim.sweep_runner import SweepRunner
+
+
+class TestSweepRunner(unittest.TestCase):
+    """!
+    @brief Tests the SweepRunner class.
+    """
+
+    def setUp(self) -> None:
+        """!
+        @brief Create a folder to write configurations and outputs to.
+        @return None
+        """
+        ## The temporary folder holding the configuration and output.
+        self._temporary_directory = tempfile.TemporaryDirectory()
+        ## The configuration file to run.
+        self._config_path = os.path.join(self._temporary_directory.name, 'config.json')
+
+    def tearDown(self) -> None:
+        """!
+        @brief Remove the temporary folder.
+        @return None
+        """
+        self._temporary_directory.cleanup()
+
+    def _write_config(self, configs: dict) -> None:
+        """!
+        @brief Write the configuration file to run.
+        @param configs The configuration to write.
+        @return None
+        """
+        with open(file=self._config_path, mode='w', encoding='utf-8') as config_file:
+            json.dump(configs, config_file)
+
+    def test_without_sweep(self) -> None:
+        """!
+        @brief Test that a configuration without a sweep runs once, as given.
+        @return None
+        """
+        self._write_config({'output': 'out'})
+        args = ['blender', '--', self._config_path]
+        with patch(target='ground_texture_sim.sweep_runner.GroundTextureSim') as mock_simulator:
+            SweepRunner(args).run()
+        mock_simulator.assert_called_once_with(args)
+
+    def test_variants(self) -> None:
+        """!
+        @brief Test that each variant is saved, listed in the manifest, and run in this process,
+        with the scene settings put back after each.
+        @return None
+        """
+        output = os.path.join(self._temporary_directory.name, 'out')
+        self._write_config({'output': output, 'camera': {'name': 'Camera'},
+                            'sweep': {'camera/z': [0.2, 0.3]}})
+        with patch(target='ground_texture_sim.sweep_runner.GroundTextureSim') as mock_simulator, \
+                patch(target='ground_texture_sim.sweep_runner.save_scene_state') as mock_save, \
+                patch(target='ground_texture_sim.sweep_runner.restore_scene_state') as mock_restore:
+            SweepRunner(['blender', '--', self._config_path, '--workers', '2']).run()
+        mock_restore.assert_has_calls([call(mock_save.return_value)] * 2)
+        self.assertEqual(mock_restore.call_count, 2, msg='Settings not restored after a variant.')
+        variant_paths = [os.path.join(output, 'sweep_000.json'),
+                         os.path.join(output, 'sweep_001.json')]
+        mock_simulator.assert_has_calls([
+            call(['blender', '--', variant_paths[0], '--workers', '2']), call().run(),
+            call(['blender', '--', variant_paths[1], '--workers', '2']), call().run()])
+        with open(file=variant_paths[1], mode='r', encoding='utf-8') as variant_file:
+            variant = json.load(variant_file)
+        self.assertEqual(variant['camera']['z'], 0.3, msg='Variant value not saved.')
+        self.assertEqual(variant['output'], os.path.join(output, 'sweep_001'),
+                         msg='Variant output not its own folder.')
+        with open(file=os.path.join(output, 'sweep.json'), mode='r',
+                  encoding='utf-8') as manifest_file:
+            manifest = json.load(manifest_file)
+        self.assertListEqual([entry['overrides'] for entry in manifest],
+                             [{'camera/z': 0.2}, {'camera/z': 0.3}], msg='Wrong manifest.')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
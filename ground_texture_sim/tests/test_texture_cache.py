@@ -0,0 +1,160 @@
+"""!
+@brief This module tests the texture_cache module.
+"""
+import os
+import tempfile
+import unittest
+from unittest.mock import MagicMock, patch
+from ground_texture_sim.texture_cache import cache_textures, hash_texture, mip_level_size
+
+
+def _blender_abspath(file_path: str, library=None) -> str:
+    """!
+    @brief Stand in for Blender's bpy.path.abspath, for paths that are already absolute.
+    @param file_path The path to make absolute.
+    @param library The library the path is relative to. Unused.
+    @return The path, unchanged.
+    """
+    return file_path
+
+
+class _FakeImage():
+    """!
+    @brief A fake Blender image, which saves its size and format as its contents.
+    """
+
+    def __init__(self, file_path: str, size: tuple, is_float: bool = False,
+                 source: str = 'FILE') -> None:
+        """!
+        @brief Create the image.
+        @param file_path The file the image was loaded from.
+        @param size The width and height of the image.
+        @param is_float If true, the image holds float pixels.
+        @param source Where the image comes from, as in Blender.
+        """
+        ## The file the image was loaded from.
+        self.filepath = file_path
+        ## The file the image is saved to.
+        self.filepath_raw = file_path
+        ## The width and height of the image.
+        self.size = size
+        ## If true, the image holds float pixels.
+        self.is_float = is_float
+        ## Where the image comes from.
+        self.source = source
+        ## The format the image is saved as.
+        self.file_format = 'JPEG'
+        ## The image's packed data, which it never has.
+        self.packed_file = None
+        ## The library the image is linked from, which it never is.
+        self.library = None
+        ## How many things use the image.
+        self.users = 1
+        ## How many times the image was saved.
+        self.save_count = 0
+
+    def scale(self, width: int, height: int) -> None:
+        """!
+        @brief Resize the image.
+        @param width The new width.
+        @param height The new height.
+        @return None
+        """
+        self.size = (width, height)
+
+    def save(self) -> None:
+        """!
+        @brief Save the image's size and format to its raw file path.
+        @return None
+        """
+        with open(file=self.filepath_raw, mode='w', encoding='utf-8') as image_file:
+            image_file.write(F'{self.file_format} {self.size[0]}x{self.size[1]}')
+        self.save_count += 1
+
+
+class TestTextureCache(unittest.TestCase):
+    """!
+    @brief Tests the texture cache functions.
+    """
+
+    def test_mip_level_size(self) -> None:
+        """!
+        @brief Test that textures are halved until they fit, and are left alone without a limit.
+        @return None
+        """
+        self.assertTupleEqual(mip_level_size(8192, 4096, 2048), (2048, 1024))
+        self.assertTupleEqual(mip_level_size(8192, 4096, 3000), (2048, 1024))
+        self.assertTupleEqual(mip_level_size(1000, 3, 1), (1, 1))
+        self.assertTupleEqual(mip_level_size(8192, 4096), (8192, 4096))
+
+    def test_hash_texture(self) -> None:
+        """!
+        @brief Test that the key follows the file's contents and the maximum size.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            first_path = os.path.join(temp_dir, 'first.jpg')
+            second_path = os.path.join(temp_dir, 'second.jpg')
+            for file_path, contents in [(first_path, b'bricks'), (second_path, b'bricks')]:
+                with open(file=file_path, mode='wb') as texture_file:
+                    texture_file.write(contents)
+            self.assertEqual(hash_texture(first_path), hash_texture(second_path),
+                             msg='Same contents keyed differently.')
+            self.assertNotEqual(hash_texture(first_path), hash_texture(first_path, 1024),
+                                msg='Maximum size not part of the key.')
+            with open(file=second_path, mode='wb') as texture_file:
+                texture_file.write(b'tiles')
+            self.assertNotEqual(hash_texture(first_path), hash_texture(second_path),
+                                msg='Different contents keyed the same.')
+
+    def test_cache_textures(self) -> None:
+        """!
+        @brief Test that textures are converted once, in the right format and size, and that
+        generated and already cached images are left alone.
+        @return None
+        """
+        with tempfile.TemporaryDirectory() as temp_dir:
+            cache_folder = os.path.join(temp_dir, 'cache')
+            diffuse_path = os.path.join(temp_dir, 'diffuse.jpg')
+            normal_path = os.path.join(temp_dir, 'normal.exr')
+            for file_path in [diffuse_path, normal_path]:
+                with open(file=file_path, mode='wb') as texture_file:
+                    texture_file.write(file_path.encode())
+            diffuse = _FakeImage(diffuse_path, (8192, 8192))
+            normal = _FakeImage(normal_path, (4096, 4096), True)
+            generated = _FakeImage('', (16, 16), source='GENERATED')
+            with patch(target='bpy.data', new=MagicMock(images=[diffuse, normal, generated])), \
+                    patch(target='bpy.path', new=MagicMock(), create=True) as blender_path:
+                blender_path.abspath.side_effect = _blender_abspath
+                self.assertEqual(cache_textures(cache_folder, 4096), 2, msg='Wrong cached count.')
+                self.assertEqual(diffuse.filepath, os.path.join(
+                    cache_folder, F'{hash_texture(diffuse_path, 4096)}.png'),
+                    msg='Diffuse texture not pointed at its copy.')
+                self.assertEqual(normal.filepath, os.path.join(
+                    cache_folder, F'{hash_texture(normal_path, 4096)}.exr'),
+                    msg='Normal map not pointed at its copy.')
+                self.assertEqual(generated.filepath, '', msg='Generated image repointed.')
+                with open(file=diffuse.filepath, mode='r', encoding='utf-8') as cached_file:
+                    self.assertEqual(cached_file.read(), 'PNG 4096x4096',
+                                     msg='Diffuse texture not shrunk to fit.')
+                with open(file=normal.filepath, mode='r', encoding='utf-8') as cached_file:
+                    self.assertEqual(cached_file.read(), 'OPEN_EXR 4096x4096',
+                                     msg='Normal map not kept at full size.')
+                self.assertListEqual(sorted(os.listdir(cache_folder)), sorted(
+                    [os.path.basename(diffuse.filepath), os.path.basename(normal.filepath)]),
+                    msg='Temporary copies left behind.')
+                # Running again, as the next job in the same process does, converts nothing.
+                self.assertEqual(cache_textures(cache_folder, 4096), 2, msg='Wrong cached count.')
+                # Another process starts from the originals, but finds their copies.
+                diffuse_again = _FakeImage(diffuse_path, (8192, 8192))
+                with patch(target='bpy.data', new=MagicMock(images=[diffuse_again])):
+                    cache_textures(cache_folder, 4096)
+                self.assertEqual(diffuse_again.filepath, diffuse.filepath,
+                                 msg='Copy not found.')
+                self.assertEqual(diffuse_again.save_count, 0, msg='Cached texture converted.')
+                self.assertEqual(diffuse.save_count + normal.save_count, 2,
+                                 msg='Texture converted twice.')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
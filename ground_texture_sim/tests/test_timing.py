@@ -0,0 +1,136 @@
+"""!
+@brief This module tests the timing module.
+"""
+import json
+import os
+import tempfile
+import unittest
+from ground_texture_sim.timing import StageTimer, format_progress
+
+
+class TestStageTimer(unittest.TestCase):
+    """!
+    @brief Tests the StageTimer class.
+    """
+
+    def test_disabled(self) -> None:
+        """!
+        @brief Test that a disabled timer records nothing.
+        @return None
+        """
+        timer = StageTimer(enabled=False)
+        with timer.measure('render'):
+            pass
+        timer.record('render', 1.0)
+        self.assertDictEqual(timer.summary(), {}, msg='Disabled timer recorded durations.')
+
+    def test_measure(self) -> None:
+        """!
+        @brief Test that measuring a block records one duration, even if the block raises.
+        @return None
+        """
+        timer = StageTimer()
+        with timer.measure('render'):
+            pass
+        with self.assertRaises(RuntimeError):
+            with timer.measure('render'):
+                raise RuntimeError('Render failed')
+        summary = timer.summary()
+        self.assertEqual(summary['render']['count'], 2, msg='Measured durations not recorded.')
+        self.assertGreaterEqual(summary['render']['min'], 0.0, msg='Negative duration recorded.')
+
+    def test_summary(self) -> None:
+        """!
+        @brief Test the summary statistics of recorded durations.
+        @return None
+        """
+        timer = StageTimer()
+        for i in range(1, 101):
+            timer.record('render', float(i))
+        timer.record('lists', 0.5)
+        summary = timer.summary()
+        self.assertSetEqual(set(summary.keys()), {'render', 'lists'}, msg='Stages missing.')
+        render = summary['render']
+        self.assertEqual(render['count'], 100, msg='Wrong count.')
+        self.assertAlmostEqual(render['total'], 5050.0, msg='Wrong total.')
+        self.assertAlmostEqual(render['mean'], 50.5, msg='Wrong mean.')
+        self.assertAlmostEqual(render['min'], 1.0, msg='Wrong minimum.')
+        self.assertAlmostEqual(render['max'], 100.0, msg='Wrong maximum.')
+        self.assertAlmostEqual(render['p50'], 50.5, msg='Wrong median.')
+        self.assertAlmostEqual(render['p90'], 90.1, msg='Wrong 90th percentile.')
+        self.assertAlmostEqual(render['p99'], 99.01, msg='Wrong 99th percentile.')
+
+    def test_histograms(self) -> None:
+        """!
+        @brief Test that durations are counted into cumulative buckets, inclusive of each bound.
+        @return None
+        """
+        timer = StageTimer(bucket_bounds=[1.0, 2.0, 3.0])
+        for seconds in [0.5, 1.0, 1.5, 4.0]:
+            timer.record('render', seconds)
+        histograms = timer.histograms()
+        self.assertDictEqual(histograms, {'render': {'count': 4, 'sum': 7.0,
+                                                     'buckets': [2, 3, 3]}},
+                             msg='Wrong histogram.')
+        with self.assertRaises(RuntimeError, msg='Histograms without bounds.'):
+            StageTimer().histograms()
+
+    def test_without_durations(self) -> None:
+        """!
+        @brief Test that a timer not keeping durations still counts, totals, and buckets them, but
+        has no percentiles.
+        @return None
+        """
+        timer = StageTimer(keep_durations=False, bucket_bounds=[1.0])
+        for seconds in [0.5, 2.0, 1.5]:
+            timer.record('render', seconds)
+        self.assertDictEqual(timer.summary(), {'render': {
+            'count': 3, 'total': 4.0, 'mean': 4.0 / 3.0, 'min': 0.5, 'max': 2.0, 'p50': None,
+            'p90': None, 'p99': None}}, msg='Wrong summary without durations.')
+        self.assertListEqual(timer.histograms()['render']['buckets'], [1],
+                             msg='Wrong histogram without durations.')
+
+    def test_write_report(self) -> None:
+        """!
+        @brief Test that the report holds the image count, throughput, and stage summary.
+        @return None
+        """
+        timer = StageTimer()
+        timer.record('render', 2.0)
+        with tempfile.TemporaryDirectory() as directory:
+            file_path = os.path.join(directory, 'timing.json')
+            timer.write_report(file_path, 4)
+            with open(file=file_path, mode='r', encoding='utf-8') as file:
+                report = json.load(file)
+        self.assertEqual(report['images'], 4, msg='Wrong image count.')
+        self.assertGreater(report['wall_time'], 0.0, msg='Wall time not recorded.')
+        self.assertAlmostEqual(report['images_per_second'], 4 / report['wall_time'],
+                               msg='Wrong throughput.')
+        self.assertDictEqual(report['stages'], timer.summary(), msg='Wrong stage summary.')
+
+
+class TestFormatProgress(unittest.TestCase):
+    """!
+    @brief Tests the format_progress function.
+    """
+
+    def test_eta(self) -> None:
+        """!
+        @brief Test the throughput and time remaining in the message.
+        @return None
+        """
+        message = format_progress(10, 100, 5.0)
+        self.assertEqual(message, 'Finished image 10 of 100 (2.00 images/sec, ETA 0:00:45)',
+                         msg='Wrong progress message.')
+
+    def test_no_progress(self) -> None:
+        """!
+        @brief Test that no rate is shown before anything has finished.
+        @return None
+        """
+        self.assertEqual(format_progress(0, 100, 0.0), 'Finished image 0 of 100',
+                         msg='Wrong message before any progress.')
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
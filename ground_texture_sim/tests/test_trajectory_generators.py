@@ -0,0 +1,155 @@
+"""!
+@brief This module tests the trajectory_generators module.
+"""
+import unittest
+import numpy
+from ground_texture_sim.trajectory_generators import LawnmowerTrajectory, LoopTrajectory, \
+    RandomWalkTrajectory, SpiralTrajectory, create_trajectory
+
+
+class TestLawnmowerTrajectory(unittest.TestCase):
+    """!
+    @brief Tests the LawnmowerTrajectory class.
+    """
+
+    def test_poses(self) -> None:
+        """!
+        @brief Test that the lanes alternate direction and move up by the lane spacing.
+        @return None
+        """
+        trajectory = LawnmowerTrajectory((-1.0, 1.0), (0.0, 0.5), 1.0, 0.25)
+        expected_results = numpy.array([
+            [-1.0, 0.0, 0.0], [0.0, 0.0, 0.0], [1.0, 0.0, 0.0],
+            [1.0, 0.25, numpy.pi], [0.0, 0.25, numpy.pi], [-1.0, 0.25, numpy.pi],
+            [-1.0, 0.5, 0.0], [0.0, 0.5, 0.0], [1.0, 0.5, 0.0]
+        ])
+        self.assertEqual(len(trajectory), 9, msg='Wrong pose count.')
+        numpy.testing.assert_allclose(trajectory[:], expected_results)
+        numpy.testing.assert_allclose(trajectory[4:6], expected_results[4:6])
+        numpy.testing.assert_allclose(numpy.reshape(trajectory, (-1, 3)), expected_results)
+        self.assertListEqual(trajectory[-1], [1.0, 0.5, 0.0], msg='Negative index wrong.')
+        with self.assertRaises(IndexError, msg='Index past the end accepted.'):
+            _ = trajectory[9]
+
+
+class TestLoopTrajectory(unittest.TestCase):
+    """!
+    @brief Tests the LoopTrajectory class.
+    """
+
+    def test_poses(self) -> None:
+        """!
+        @brief Test that the loop goes counterclockwise around the edge, for every lap.
+        @return None
+        """
+        trajectory = LoopTrajectory((0.0, 2.0), (0.0, 1.0), 1.0, 2)
+        expected_lap = numpy.array([
+            [0.0, 0.0, 0.0], [1.0, 0.0, 0.0], [2.0, 0.0, numpy.pi / 2.0],
+            [2.0, 1.0, numpy.pi], [1.0, 1.0, numpy.pi], [0.0, 1.0, -numpy.pi / 2.0]
+        ])
+        self.assertEqual(len(trajectory), 12, msg='Wrong pose count.')
+        numpy.testing.assert_allclose(trajectory[:], numpy.concatenate((expected_lap,
+                                                                         expected_lap)))
+
+
+class TestSpiralTrajectory(unittest.TestCase):
+    """!
+    @brief Tests the SpiralTrajectory class.
+    """
+
+    def test_poses(self) -> None:
+        """!
+        @brief Test that poses are a stride apart and spiral out by the lane spacing each turn.
+        @return None
+        """
+        trajectory = SpiralTrajectory((-1.0, 1.0), (-1.0, 1.0), 0.01, 0.1)
+        poses = trajectory[:]
+        numpy.testing.assert_allclose(poses[0, 0:2], [0.0, 0.0], atol=1e-12)
+        radius = numpy.linalg.norm(poses[:, 0:2], axis=1)
+        self.assertLessEqual(radius.max(), 1.0, msg='Spiral leaves the area.')
+        self.assertGreater(radius.max(), 0.99, msg='Spiral stops short of the area.')
+        # Far from the center, the spiral is nearly straight between poses.
+        steps = numpy.linalg.norm(numpy.diff(poses[100:, 0:2], axis=0), axis=1)
+        numpy.testing.assert_allclose(steps, 0.01, rtol=1e-3)
+        # Each pose faces the next one.
+        direction = numpy.arctan2(poses[1001, 1] - poses[1000, 1], poses[1001, 0] - poses[1000, 0])
+        self.assertAlmostEqual(numpy.cos(direction - poses[1000, 2]), 1.0, places=3,
+                               msg='Pose does not face along the spiral.')
+
+
+class TestRandomWalkTrajectory(unittest.TestCase):
+    """!
+    @brief Tests the RandomWalkTrajectory class.
+    """
+
+    def test_poses(self) -> None:
+        """!
+        @brief Test that the walk stays in the area, takes strides, and is the same every time.
+        @return None
+        """
+        pose_count = 150000
+        trajectory = RandomWalkTrajectory((0.0, 1.0), (0.0, 2.0), 0.02, pose_count, 0.3, 7)
+        self.assertEqual(len(trajectory), pose_count, msg='Wrong pose count.')
+        # Ask for the end of the walk first, to check blocks do not rely on the order they are used.
+        tail = trajectory[pose_count - 10:]
+        poses = RandomWalkTrajectory((0.0, 1.0), (0.0, 2.0), 0.02, pose_count, 0.3, 7)[:]
+        numpy.testing.assert_allclose(poses[-10:], tail)
+        numpy.testing.assert_allclose(poses[0], [0.5, 1.0, 0.0])
+        self.assertTrue(numpy.all((poses[:, 0] >= 0.0) & (poses[:, 0] <= 1.0)),
+                        msg='Walk leaves the area in X.')
+        self.assertTrue(numpy.all((poses[:, 1] >= 0.0) & (poses[:, 1] <= 2.0)),
+                        msg='Walk leaves the area in Y.')
+        # Bouncing off an edge shortens a step, but never lengthens it.
+        steps = numpy.linalg.norm(numpy.diff(poses[:, 0:2], axis=0), axis=1)
+        self.assertTrue(numpy.all(steps <= 0.02 + 1e-9), msg='Step longer than the stride.')
+        self.assertGreater(numpy.median(steps), 0.0199, msg='Steps not a stride long.')
+        other_seed = RandomWalkTrajectory((0.0, 1.0), (0.0, 2.0), 0.02, pose_count, 0.3, 8)
+        self.assertFalse(numpy.allclose(other_seed[0:100], poses[0:100]),
+                         msg='Seed does not change the walk.')
+
+
+class TestCreateTrajectory(unittest.TestCase):
+    """!
+    @brief Tests the create_trajectory function.
+    """
+
+    def test_types(self) -> None:
+        """!
+        @brief Test that each type creates its generator, with defaults for optional values.
+        @return None
+        """
+        area = {'x_min': 0.0, 'y_min': 0.0, 'x_max': 1.0, 'y_max': 1.0, 'stride': 0.1}
+        expected_types = [
+            ({'type': 'lawnmower', 'lane_spacing': 0.2}, LawnmowerTrajectory),
+            ({'type': 'loop'}, LoopTrajectory),
+            ({'type': 'spiral', 'lane_spacing': 0.2}, SpiralTrajectory),
+            ({'type': 'random_walk', 'poses': 10}, RandomWalkTrajectory)
+        ]
+        for configs, expected_type in expected_types:
+            self.assertIsInstance(create_trajectory({**area, **configs}), expected_type,
+                                  msg=F'Wrong generator for {configs["type"]}.')
+        self.assertEqual(len(create_trajectory({**area, 'type': 'loop'})), 40,
+                         msg='Default laps not used.')
+
+    def test_reject_bad_settings(self) -> None:
+        """!
+        @brief Test that unknown types, missing values, and bad values raise exceptions.
+        @return None
+        """
+        area = {'x_min': 0.0, 'y_min': 0.0, 'x_max': 1.0, 'y_max': 1.0, 'stride': 0.1}
+        bad_settings = [
+            ({'type': 'zigzag'}, ValueError),
+            ({'type': 'lawnmower'}, KeyError),
+            ({'type': 'random_walk', 'poses': 'many'}, TypeError),
+            ({'type': 'random_walk', 'poses': 0}, ValueError),
+            ({'type': 'loop', 'stride': -0.1}, ValueError),
+            ({'type': 'loop', 'x_max': 0.0}, ValueError),
+            ({'type': 'random_walk', 'poses': 5, 'turn_deviation': -1.0}, ValueError)
+        ]
+        for bad_setting, error in bad_settings:
+            with self.assertRaises(error, msg=F'{bad_setting} not rejected.'):
+                create_trajectory({**area, **bad_setting})
+
+
+if __name__ == '__main__':  # pragma: no cover
+    unittest.main()
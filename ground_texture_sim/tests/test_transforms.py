@@ -37,6 +37,76 @@ class TestCreateTransformMatrix(unittest.TestCase):
         self.assertTrue(numpy.allclose(expected_result, result))
 
 
+class TestCreateTransformMatrices(unittest.TestCase):
+    """!
+    @brief Test that the create_transform_matrices function works.
+    """
+
+    def test_matches_single(self) -> None:
+        """!
+        @brief Test the batch result matches building each pose one at a time.
+        @return None
+        """
+        x = numpy.array([1.0, 0.0, -2.0])
+        y = numpy.array([2.0, 0.0, 0.5])
+        roll = numpy.array([numpy.pi, 0.0, 0.1])
+        pitch = numpy.array([numpy.pi / 2.0, 0.0, 1.5708])
+        yaw = numpy.array([-numpy.pi / 2.0, 0.0, 3.0])
+        # Z is shared by every pose to check broadcasting.
+        result = transforms.create_transform_matrices(x, y, 3.0, roll, pitch, yaw)
+        self.assertEqual(result.shape, (3, 4, 4), msg='Wrong output shape.')
+        for i in range(3):
+            expected = transforms.create_transform_matrix(
+                x[i], y[i], 3.0, roll[i], pitch[i], yaw[i])
+            self.assertTrue(numpy.allclose(expected, result[i]),
+                            msg='Batch matrix differs from the single version.')
+
+    def test_reject_mismatched(self) -> None:
+        """!
+        @brief Test the function rejects components of different lengths.
+        @return None
+        """
+        with self.assertRaises(ValueError, msg='Mismatched lengths not rejected.'):
+            transforms.create_transform_matrices(
+                numpy.zeros(2), numpy.zeros(3), 0.0, 0.0, 0.0, 0.0)
+
+
+class TestCreatePlanarTransformMatrices(unittest.TestCase):
+    """!
+    @brief Test that the create_planar_transform_matrices function works.
+    """
+
+    def test_matches_single(self) -> None:
+        """!
+        @brief Test the batch result exactly matches building each pose one at a time.
+        @return None
+        """
+        poses = numpy.array([
+            [0.0, 0.0, 0.0],
+            [1.0, 2.0, numpy.pi / 2.0],
+            [-0.2, 0.0, -2.62567e-18],
+            [0.5, -0.5, -3.1416]
+        ])
+        result = transforms.create_planar_transform_matrices(poses)
+        self.assertEqual(result.shape, (4, 4, 4), msg='Wrong output shape.')
+        for pose, matrix in zip(poses, result):
+            expected = transforms.create_transform_matrix(
+                pose[0], pose[1], 0.0, 0.0, 0.0, pose[2])
+            self.assertTrue(numpy.array_equal(expected, matrix),
+                            msg='Batch matrix differs from the single version.')
+            # Negative zeros print differently, so they must match too.
+            self.assertTrue(numpy.array_equal(numpy.signbit(expected), numpy.signbit(matrix)),
+                            msg='Batch matrix signs differ from the single version.')
+
+    def test_reject_size(self) -> None:
+        """!
+        @brief Test the function rejects arrays that are not Nx3.
+        @return None
+        """
+        with self.assertRaises(ValueError, msg='Wrong size poses not rejected.'):
+            transforms.create_planar_transform_matrices(numpy.zeros((2, 4)))
+
+
 class TestTransformer(unittest.TestCase):
     """!
     @brief Test the Transformer class works as expected.
@@ -247,3 +317,144 @@ class TestTransformer(unittest.TestCase):
         result = transformer.transform_camera_to_world(numpy.identity(4))
         self.assertTrue(numpy.allclose(result, other_matrix),
                         msg='Transform incorrect for identity.')
+
+    def test_project_image_corners_batch(self) -> None:
+        """!
+        @brief Test that the batch projection matches the single version for both input formats.
+        @return None
+        """
+        planar_poses = numpy.array([
+            [0.0, 0.0, 0.0],
+            [1.0, 2.0, numpy.pi / 2.0],
+            [1.0, 2.0, -numpy.pi / 2.0],
+            [-0.3, 0.7, 2.5]
+        ])
+        camera_pose = numpy.array([
+            [0.0, -1.0, 0.0, 0.0],
+            [0.0, 0.0, 1.0, 0.0],
+            [-1.0, 0.0, 0.0, 0.25],
+            [0.0, 0.0, 0.0, 1.0]
+        ])
+        camera_matrix = numpy.array([
+            [2666.666667, 0.000000, 960.000000],
+            [0.000000, 2250.000000, 540.000000],
+            [0.000000, 0.000000, 1.000000]
+        ])
+        transformer = transforms.Transformer(camera_pose, camera_matrix)
+        matrix_poses = transforms.create_planar_transform_matrices(planar_poses)
+        planar_result = transformer.project_image_corners(planar_poses)
+        matrix_result = transformer.project_image_corners(matrix_poses)
+        self.assertEqual(planar_result.shape, (4, 3), msg='Wrong output shape.')
+        self.assertTrue(numpy.array_equal(planar_result, matrix_result),
+                        msg='Input formats give different results.')
+        for robot_pose, batch_element in zip(matrix_poses, matrix_result):
+            single_element = transformer.project_image_corner(robot_pose)
+            self.assertTrue(numpy.allclose(single_element, batch_element),
+                            msg='Batch projection differs from the single version.')
+        with self.assertRaises(ValueError, msg='Wrong size poses not rejected.'):
+            transformer.project_image_corners(numpy.identity(4))
+
+    def test_project_ground_points(self) -> None:
+        """!
+        @brief Test that points on the floor are projected into the global image.
+        @return None
+        """
+        camera_pose = numpy.array([
+            [0.0, -1.0, 0.0, 0.0],
+            [0.0, 0.0, 1.0, 0.0],
+            [-1.0, 0.0, 0.0, 0.25],
+            [0.0, 0.0, 0.0, 1.0]
+        ])
+        camera_matrix = numpy.array([
+            [2666.666667, 0.000000, 960.000000],
+            [0.000000, 2250.000000, 540.000000],
+            [0.000000, 0.000000, 1.000000]
+        ])
+        transformer = transforms.Transformer(camera_pose, camera_matrix)
+        result = transformer.project_ground_points(numpy.array([[0.0, 0.0], [0.1, 0.0]]))
+        self.assertTrue(numpy.allclose(result, [[960.0, 540.0], [2026.6666668, 540.0]]),
+                        msg='Ground points not projected correctly.')
+        # The corner of the image at the origin must land on the global image's origin.
+        corner = transformer.project_ground_points(numpy.array([[-0.09, 0.06]]))
+        self.assertTrue(numpy.allclose(corner, [[0.0, 0.0]]), msg='Corner not at the origin.')
+
+    def test_project_pixels_round_trip(self) -> None:
+        """!
+        @brief Test that pixels are projected onto the floor and back to the same pixels.
+        @return None
+        """
+        camera_pose = numpy.array([
+            [0.0, -1.0, 0.0, 0.0],
+            [0.0, 0.0, 1.0, 0.0],
+            [-1.0, 0.0, 0.0, 0.25],
+            [0.0, 0.0, 0.0, 1.0]
+        ])
+        camera_matrix = numpy.array([
+            [2666.666667, 0.000000, 960.000000],
+            [0.000000, 2250.000000, 540.000000],
+            [0.000000, 0.000000, 1.000000]
+        ])
+        transformer = transforms.Transformer(camera_pose, camera_matrix)
+        pixels = numpy.array([[0.0, 0.0], [960.0, 540.0], [1920.0, 100.0]])
+        points = transformer.project_pixels_to_robot(pixels)
+        self.assertTrue(numpy.allclose(points[0], [-0.09, 0.06, 0.0, 1.0]),
+                        msg='Corner not projected onto the floor.')
+        self.assertTrue(numpy.allclose(points[1], [0.0, 0.0, 0.0, 1.0]),
+                        msg='Center not projected under the camera.')
+        self.assertTrue(numpy.allclose(transformer.project_robot_to_pixels(points), pixels),
+                        msg='Points not projected back to their pixels.')
+
+    def test_projection_follows_setters(self) -> None:
+        """!
+        @brief Test that changing the camera after construction updates the cached projection.
+        @return None
+        """
+        camera_pose = numpy.array([
+            [0.0, -1.0, 0.0, 0.0],
+            [0.0, 0.0, 1.0, 0.0],
+            [-1.0, 0.0, 0.0, 0.25],
+            [0.0, 0.0, 0.0, 1.0]
+        ])
+        camera_matrix = numpy.array([
+            [2666.666667, 0.000000, 960.000000],
+            [0.000000, 2250.000000, 540.000000],
+            [0.000000, 0.000000, 1.000000]
+        ])
+        robot_pose = numpy.array([
+            [0.0, -1.0, 0.0, 1.0],
+            [1.0, 0.0, 0.0, 2.0],
+            [0.0, 0.0, 1.0, 0.0],
+            [0.0, 0.0, 0.0, 1.0]
+        ])
+        expected_result = [10986.66666792, -16650.0000001, numpy.pi / 2.0]
+        transformer = transforms.Transformer(numpy.identity(4), numpy.identity(3))
+        transformer.camera_pose = camera_pose
+        transformer.camera_intrinsic_matrix = camera_matrix
+        result = transformer.project_image_corner(robot_pose)
+        for result_element, expected_element in zip(result, expected_result):
+            self.assertAlmostEqual(
+                result_element, expected_element, msg='Projection not updated by setters.')
+
+    def test_transform_cameras_to_world_batch(self) -> None:
+        """!
+        @brief Verify that the batch transform to world matches the single version.
+        @return None
+        """
+        camera_pose = numpy.array([
+            [0.0, 0.0, 1.0, 0.0],
+            [0.0, 1.0, 0.0, 0.0],
+            [-1.0, 0.0, 0.0, 0.25],
+            [0.0, 0.0, 0.0, 1.0]
+        ])
+        planar_poses = numpy.array([
+            [0.0, 0.0, 0.0],
+            [1.0, 2.0, numpy.pi]
+        ])
+        transformer = transforms.Transformer(camera_pose, numpy.identity(3))
+        result = transformer.transform_cameras_to_world(planar_poses)
+        self.assertEqual(result.shape, (2, 4, 4), msg='Wrong output shape.')
+        for robot_pose, batch_element in zip(
+                transforms.create_planar_transform_matrices(planar_poses), result):
+            self.assertTrue(numpy.allclose(transformer.transform_camera_to_world(robot_pose),
+                                           batch_element),
+                            msg='Batch transform differs from the single version.')
@@ -0,0 +1,114 @@
+"""!
+@brief This module provides a shared cache of converted texture images, so each job loads textures
+that are no larger than needed.
+"""
+import hashlib
+import os
+import tempfile
+from typing import Tuple
+import bpy
+
+## How many bytes of a texture to hash at once.
+_HASH_BLOCK_SIZE = 1 << 20
+
+
+def cache_textures(cache_folder: str, max_size: int = None) -> int:
+    """!
+    @brief Point every texture image of the scene at a converted copy in the cache folder, making
+    any copy that isn't there yet.
+
+    Each copy is keyed by a hash of the original file's contents and the maximum size, so editing a
+    texture or changing the size makes a new copy, and jobs on different machines sharing the cache
+    folder share the copies. Textures with 8 bits per channel are saved as PNG, while float
+    textures, such as normal or displacement maps, are saved as OpenEXR, so neither loses precision
+    beyond the resizing. Images that are packed into the blend file, generated, or unused are left
+    alone, as are images already pointing into the cache.
+
+    Blender only reads a texture's pixels when it is first rendered, so calling this before then
+    means the originals are never loaded, except to make a missing copy.
+
+    @param cache_folder The folder holding the converted copies. It is created if needed.
+    @param max_size If set, the most pixels along either side of a copy. Larger textures are halved
+    until they fit, like picking a level of a mipmap, which also cuts the memory they take.
+    @return How many images now point at a copy.
+    """
+    cache_folder = os.path.abspath(cache_folder)
+    os.makedirs(cache_folder, exist_ok=True)
+    cached_count = 0
+    for image in bpy.data.images:
+        if image.source != 'FILE' or image.packed_file is not None or image.users == 0:
+            continue
+        source_path = os.path.abspath(bpy.path.abspath(image.filepath, library=image.library))
+        if os.path.dirname(source_path) == cache_folder:
+            cached_count += 1
+            continue
+        if not os.path.isfile(source_path):
+            continue
+        extension = 'exr' if image.is_float else 'png'
+        cached_path = os.path.join(
+            cache_folder, F'{hash_texture(source_path, max_size)}.{extension}')
+        if not os.path.exists(cached_path):
+            _convert_image(image, cached_path, max_size)
+        image.filepath = cached_path
+        cached_count += 1
+    return cached_count
+
+
+def hash_texture(file_path: str, max_size: int = None) -> str:
+    """!
+    @brief Find the key of a texture's copy in the cache.
+    @param file_path The original texture file.
+    @param max_size The most pixels along either side of the copy, or None for the full size.
+    @return The hexadecimal SHA-256 hash of the file's contents and the maximum size.
+    """
+    digest = hashlib.sha256(F'max_size={max_size};'.encode())
+    with open(file=file_path, mode='rb') as texture_file:
+        block = texture_file.read(_HASH_BLOCK_SIZE)
+        while len(block) > 0:
+            digest.update(block)
+            block = texture_file.read(_HASH_BLOCK_SIZE)
+    return digest.hexdigest()
+
+
+def mip_level_size(width: int, height: int, max_size: int = None) -> Tuple[int, int]:
+    """!
+    @brief Find the size of the largest level of a texture's mipmap that fits a maximum size.
+    @param width The width of the full texture, in pixels.
+    @param height The height of the full texture, in pixels.
+    @param max_size The most pixels along either side, or None for the full size.
+    @return The width and height of the level, each at least 1.
+    """
+    if max_size is not None:
+        while max(width, height) > max_size and max(width, height) > 1:
+            width = max(width // 2, 1)
+            height = max(height // 2, 1)
+    return width, height
+
+
+def _convert_image(image: 'bpy.types.Image', cached_path: str, max_size: int) -> None:
+    """!
+    @brief Save a texture's copy to the cache.
+
+    The copy is written to a temporary file next to it and then renamed, so several processes can
+    fill the cache at once without ever reading a partial copy.
+
+    @param image The texture image in Blender, still pointing at its original file.
+    @param cached_path Where the copy goes.
+    @param max_size The most pixels along either side of the copy, or None for the full size.
+    @return None
+    """
+    width, height = image.size
+    level_size = mip_level_size(width, height, max_size)
+    if level_size != (width, height):
+        image.scale(*level_size)
+    file_descriptor, temporary_path = tempfile.mkstemp(
+        suffix=os.path.splitext(cached_path)[1], dir=os.path.dirname(cached_path))
+    os.close(file_descriptor)
+    try:
+        image.filepath_raw = temporary_path
+        image.file_format = 'OPEN_EXR' if image.is_float else 'PNG'
+        image.save()
+        os.replace(temporary_path, cached_path)
+    finally:
+        if os.path.exists(temporary_path):
+            os.remove(temporary_path)
@@ -0,0 +1,177 @@
+"""!
+@brief This module provides tools to measure how long each stage of data generation takes.
+"""
+import bisect
+import contextlib
+import datetime
+import itertools
+import json
+import threading
+import time
+from typing import Dict, Iterator, List
+import numpy
+
+
+class StageTimer:
+    """!
+    @brief A class to collect the duration of each stage every time it runs, then summarize them.
+
+    Each stage's count, total, minimum, maximum, and, if bucket bounds are given, histogram bucket
+    counts are kept up to date as durations are recorded, so they take the same memory and time
+    however many images are made. Only the percentiles of the summary need every duration, so those
+    are only kept if asked for.
+
+    Durations can be recorded from several threads at once, such as the render loop and the
+    background writer.
+    """
+
+    def __init__(self, enabled: bool = True, keep_durations: bool = True,
+                 bucket_bounds: List[float] = None) -> None:
+        """!
+        @brief Create the timer with no recorded durations.
+        @param enabled If false, nothing is recorded, so instrumentation can be left in place at no
+        real cost.
+        @param keep_durations If true, keep every duration for the percentiles of @ref summary.
+        @param bucket_bounds The upper bound of each bucket of @ref histograms, in seconds, in
+        increasing order. If None, no histograms are kept.
+        """
+        ## Whether durations are recorded at all.
+        self.enabled = enabled
+        ## Whether every duration is kept, for percentiles.
+        self._keep_durations = keep_durations
+        ## The upper bound of each histogram bucket, in seconds, or None.
+        self._bucket_bounds = list(bucket_bounds) if bucket_bounds is not None else None
+        ## The list of durations for each stage, in seconds, keyed by stage name, if kept.
+        self._durations = {}
+        ## The count, sum, minimum, maximum, and bucket counts of each stage, keyed by stage name.
+        ## Each bucket counts the durations above the previous bound and at most its own.
+        self._totals = {}
+        ## Guards the recorded durations when recording from several threads.
+        self._lock = threading.Lock()
+        ## The time the timer was created, used for the total wall time.
+        self._start_time = time.perf_counter()
+
+    @contextlib.contextmanager
+    def measure(self, stage: str) -> Iterator[None]:
+        """!
+        @brief Time a block of code and record it under the given stage, such as:
+        ```
+        with timer.measure('render'):
+            interface.render_image(path)
+        ```
+        @param stage The name of the stage.
+        @return A context manager that records the duration when its block exits.
+        """
+        if not self.enabled:
+            yield
+            return
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.record(stage, time.perf_counter() - start)
+
+    def record(self, stage: str, seconds: float) -> None:
+        """!
+        @brief Record a single duration of a stage.
+        @param stage The name of the stage.
+        @param seconds How long the stage took, in seconds.
+        @return None
+        """
+        if not self.enabled:
+            return
+        with self._lock:
+            totals = self._totals.get(stage)
+            if totals is None:
+                totals = {'count': 0, 'sum': 0.0, 'min': seconds, 'max': seconds,
+                          'buckets': [0] * len(self._bucket_bounds or [])}
+                self._totals[stage] = totals
+            totals['count'] += 1
+            totals['sum'] += seconds
+            totals['min'] = min(totals['min'], seconds)
+            totals['max'] = max(totals['max'], seconds)
+            if self._bucket_bounds is not None:
+                bucket = bisect.bisect_left(self._bucket_bounds, seconds)
+                # Durations above every bound only count towards the total.
+                if bucket < len(self._bucket_bounds):
+                    totals['buckets'][bucket] += 1
+            if self._keep_durations:
+                self._durations.setdefault(stage, []).append(seconds)
+
+    def summary(self) -> Dict[str, Dict[str, float]]:
+        """!
+        @brief Summarize the recorded durations of each stage.
+        @return A dictionary keyed by stage name. Each value holds the count, total, mean, minimum,
+        maximum, and 50th, 90th, and 99th percentile durations, all in seconds. The percentiles are
+        None unless durations are kept.
+        """
+        result = {}
+        with self._lock:
+            totals = {stage: dict(stage_totals) for stage, stage_totals in self._totals.items()}
+            durations = {stage: list(values) for stage, values in self._durations.items()}
+        for stage, stage_totals in totals.items():
+            result[stage] = {
+                'count': stage_totals['count'],
+                'total': stage_totals['sum'],
+                'mean': stage_totals['sum'] / stage_totals['count'],
+                'min': stage_totals['min'],
+                'max': stage_totals['max'],
+                'p50': None,
+                'p90': None,
+                'p99': None
+            }
+            if stage in durations:
+                values = numpy.array(durations[stage])
+                for percentile in [50, 90, 99]:
+                    result[stage][F'p{percentile}'] = float(numpy.percentile(values, percentile))
+        return result
+
+    def histograms(self) -> Dict[str, Dict]:
+        """!
+        @brief Get the recorded durations of each stage counted into cumulative buckets, as in a
+        Prometheus histogram.
+        @return A dictionary keyed by stage name. Each value holds the count and sum of the
+        durations, in seconds, and the list of how many durations were at most each bucket bound.
+        @exception RuntimeError raised if the timer was created without bucket bounds.
+        """
+        if self._bucket_bounds is None:
+            raise RuntimeError('This timer was created without histogram bucket bounds.')
+        with self._lock:
+            return {
+                stage: {'count': totals['count'], 'sum': totals['sum'],
+                        'buckets': list(itertools.accumulate(totals['buckets']))}
+                for stage, totals in self._totals.items()
+            }
+
+    def write_report(self, file_path: str, image_count: int) -> None:
+        """!
+        @brief Write the summary of every stage, plus overall throughput, to a JSON file.
+        @param file_path Where to write the report. The containing folder must exist.
+        @param image_count How many images were rendered, to compute the throughput.
+        @return None
+        """
+        wall_time = time.perf_counter() - self._start_time
+        report = {
+            'images': image_count,
+            'wall_time': wall_time,
+            'images_per_second': image_count / wall_time if wall_time > 0 else 0.0,
+            'stages': self.summary()
+        }
+        with open(file=file_path, mode='w', encoding='utf-8') as file:
+            json.dump(report, fp=file, indent=2)
+
+
+def format_progress(done: int, total: int, elapsed: float) -> str:
+    """!
+    @brief Create a progress message with the throughput so far and the estimated time remaining.
+    @param done How many images are finished.
+    @param total How many images there are in total.
+    @param elapsed How many seconds it took to finish the done images.
+    @return A single line message, without a newline.
+    """
+    message = F'Finished image {done} of {total}'
+    if done == 0 or elapsed <= 0:
+        return message
+    rate = done / elapsed
+    remaining = datetime.timedelta(seconds=round((total - done) / rate))
+    return F'{message} ({rate:0.2f} images/sec, ETA {remaining})'
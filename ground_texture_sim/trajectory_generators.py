@@ -0,0 +1,391 @@
+"""!
+@brief This module provides trajectories that are described by a few parameters in the configuration
+instead of being read from a file.
+
+Every trajectory computes its poses on demand, so even a trajectory of many millions of poses takes
+no time to create and no memory to hold. They act like a read only list of [x, y, theta] poses.
+Slicing one returns an Nx3 Numpy array.
+"""
+import math
+from typing import Dict, List, Tuple, Union
+import numpy
+
+## How many steps of a random walk are computed together. Each block only depends on the one
+## before it through a single position and heading.
+_BLOCK_SIZE = 65536
+
+
+class GeneratedTrajectory:
+    """!
+    @brief The base class of every trajectory generator.
+
+    Subclasses set the pose count and implement @ref _generate to compute the poses at any indices.
+    """
+
+    def __init__(self, pose_count: int) -> None:
+        """!
+        @brief Set how many poses the trajectory has.
+        @param pose_count The number of poses.
+        """
+        ## The number of poses in the trajectory.
+        self._pose_count = pose_count
+
+    def __array__(self, dtype: numpy.dtype = None, copy: bool = None) -> numpy.ndarray:
+        """!
+        @brief Compute every pose, so that Numpy functions can use the trajectory like an array.
+        @param dtype The type to return, or None for float.
+        @param copy Ignored, since the poses are always newly computed.
+        @return An Nx3 Numpy array of every pose.
+        """
+        del copy
+        return self[:].astype(dtype if dtype is not None else float)
+
+    def __getitem__(self, key: Union[int, slice]) -> Union[List[float], numpy.ndarray]:
+        """!
+        @brief Compute one or several poses.
+        @param key A single index, or a slice of indices.
+        @return For an index, the [x, y, theta] list of that pose. For a slice, an Nx3 Numpy array.
+        @exception IndexError raised if a single index is outside of the trajectory.
+        """
+        if isinstance(key, slice):
+            return self._generate(numpy.arange(*key.indices(self._pose_count)))
+        if key < 0:
+            key += self._pose_count
+        if key < 0 or key >= self._pose_count:
+            raise IndexError(F'Pose {key} is outside of the {self._pose_count} pose trajectory.')
+        return self._generate(numpy.array([key]))[0].tolist()
+
+    def __len__(self) -> int:
+        """!
+        @brief Get how many poses the trajectory has.
+        @return The pose count.
+        """
+        return self._pose_count
+
+    def _generate(self, indices: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Compute the poses at the given indices.
+        @param indices A 1D Numpy array of indices, each within the trajectory.
+        @return An Nx3 Numpy array of the X and Y in meters and the yaw in radians of each pose.
+        """
+        raise NotImplementedError  # pragma: no cover
+
+
+class LawnmowerTrajectory(GeneratedTrajectory):
+    """!
+    @brief Sweep back and forth along X, moving up in Y between each lane.
+    """
+
+    def __init__(self, x_limits: Tuple[float, float], y_limits: Tuple[float, float],
+                 stride: float, lane_spacing: float) -> None:
+        """!
+        @brief Fit as many lanes in the area as possible, starting from the lower left corner.
+        @param x_limits The smallest and largest X of the area, in meters.
+        @param y_limits The smallest and largest Y of the area, in meters.
+        @param stride The distance between poses along each lane, in meters.
+        @param lane_spacing The distance between lanes, in meters.
+        """
+        ## The smallest X and Y of the area.
+        self._origin = (x_limits[0], y_limits[0])
+        ## The distance between poses along each lane.
+        self._stride = stride
+        ## The distance between lanes.
+        self._lane_spacing = lane_spacing
+        ## How many poses are in each lane.
+        self._lane_length = _count_steps(x_limits[1] - x_limits[0], stride) + 1
+        lane_count = _count_steps(y_limits[1] - y_limits[0], lane_spacing) + 1
+        super().__init__(self._lane_length * lane_count)
+
+    def _generate(self, indices: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Compute the poses at the given indices.
+        @param indices A 1D Numpy array of indices, each within the trajectory.
+        @return An Nx3 Numpy array of the X and Y in meters and the yaw in radians of each pose.
+        """
+        lane, step = numpy.divmod(indices, self._lane_length)
+        forward = lane % 2 == 0
+        step = numpy.where(forward, step, self._lane_length - 1 - step)
+        return numpy.column_stack((
+            self._origin[0] + step * self._stride,
+            self._origin[1] + lane * self._lane_spacing,
+            numpy.where(forward, 0.0, numpy.pi)))
+
+
+class LoopTrajectory(GeneratedTrajectory):
+    """!
+    @brief Drive counterclockwise around the edge of the area, starting from the lower left corner.
+    """
+
+    def __init__(self, x_limits: Tuple[float, float], y_limits: Tuple[float, float],
+                 stride: float, laps: int) -> None:
+        """!
+        @brief Space poses evenly around the edge of the area.
+        @param x_limits The smallest and largest X of the area, in meters.
+        @param y_limits The smallest and largest Y of the area, in meters.
+        @param stride The distance between poses, in meters.
+        @param laps How many times to go around.
+        """
+        ## The smallest X and Y of the area.
+        self._origin = (x_limits[0], y_limits[0])
+        ## The width and height of the area.
+        self._size = (x_limits[1] - x_limits[0], y_limits[1] - y_limits[0])
+        ## The distance between poses.
+        self._stride = stride
+        ## How many poses are in each lap. The last one stops short of the first.
+        self._lap_length = max(_count_steps(2.0 * sum(self._size), stride), 1)
+        super().__init__(self._lap_length * laps)
+
+    def _generate(self, indices: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Compute the poses at the given indices.
+        @param indices A 1D Numpy array of indices, each within the trajectory.
+        @return An Nx3 Numpy array of the X and Y in meters and the yaw in radians of each pose.
+        """
+        distance = (indices % self._lap_length) * self._stride
+        width, height = self._size
+        # Find which edge each pose is on, and how far along that edge it is.
+        edge_starts = numpy.array([0.0, width, width + height, 2.0 * width + height])
+        edge = numpy.searchsorted(edge_starts, distance, side='right') - 1
+        along = distance - edge_starts[edge]
+        corner_x = numpy.array([0.0, width, width, 0.0])
+        corner_y = numpy.array([0.0, 0.0, height, height])
+        direction_x = numpy.array([1.0, 0.0, -1.0, 0.0])
+        direction_y = numpy.array([0.0, 1.0, 0.0, -1.0])
+        yaw = numpy.array([0.0, numpy.pi / 2.0, numpy.pi, -numpy.pi / 2.0])
+        return numpy.column_stack((
+            self._origin[0] + corner_x[edge] + direction_x[edge] * along,
+            self._origin[1] + corner_y[edge] + direction_y[edge] * along,
+            yaw[edge]))
+
+
+class SpiralTrajectory(GeneratedTrajectory):
+    """!
+    @brief Spiral counterclockwise out from the center of the area, until the spiral would leave it.
+
+    This is an Archimedean spiral, so each turn is the same distance outside the one before it.
+    """
+
+    def __init__(self, x_limits: Tuple[float, float], y_limits: Tuple[float, float],
+                 stride: float, lane_spacing: float) -> None:
+        """!
+        @brief Space poses evenly along the spiral.
+        @param x_limits The smallest and largest X of the area, in meters.
+        @param y_limits The smallest and largest Y of the area, in meters.
+        @param stride The distance between poses along the spiral, in meters.
+        @param lane_spacing The distance between each turn of the spiral, in meters.
+        """
+        ## The center of the spiral.
+        self._center = ((x_limits[0] + x_limits[1]) / 2.0, (y_limits[0] + y_limits[1]) / 2.0)
+        ## The distance between poses along the spiral.
+        self._stride = stride
+        ## How far the radius grows for each radian turned.
+        self._growth = lane_spacing / (2.0 * math.pi)
+        largest_radius = min(x_limits[1] - x_limits[0], y_limits[1] - y_limits[0]) / 2.0
+        largest_angle = largest_radius / self._growth
+        super().__init__(_count_steps(self._arc_length(largest_angle), stride) + 1)
+
+    def _arc_length(self, angle: Union[float, numpy.ndarray]) -> Union[float, numpy.ndarray]:
+        """!
+        @brief Find how far along the spiral each angle is.
+        @param angle How far the spiral has turned, in radians.
+        @return The length of the spiral up to that angle, in meters.
+        """
+        return self._growth / 2.0 * (angle * numpy.sqrt(1.0 + angle ** 2) + numpy.arcsinh(angle))
+
+    def _generate(self, indices: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Compute the poses at the given indices.
+        @param indices A 1D Numpy array of indices, each within the trajectory.
+        @return An Nx3 Numpy array of the X and Y in meters and the yaw in radians of each pose.
+        """
+        distance = indices * self._stride
+        # There is no closed form for the angle at a distance along the spiral, so refine the far
+        # from center approximation with Newton's method.
+        angle = numpy.sqrt(2.0 * distance / self._growth)
+        for _ in range(8):
+            angle -= (self._arc_length(angle) - distance) / (
+                self._growth * numpy.sqrt(1.0 + angle ** 2))
+            angle = numpy.maximum(angle, 0.0)
+        radius = self._growth * angle
+        cos_angle = numpy.cos(angle)
+        sin_angle = numpy.sin(angle)
+        return numpy.column_stack((
+            self._center[0] + radius * cos_angle,
+            self._center[1] + radius * sin_angle,
+            numpy.arctan2(sin_angle + angle * cos_angle, cos_angle - angle * sin_angle)))
+
+
+class RandomWalkTrajectory(GeneratedTrajectory):
+    """!
+    @brief Wander randomly around the area, starting from its center and bouncing off its edges.
+
+    Each pose is one stride from the last, with the heading changed by a random turn. The same seed
+    always gives the same walk, no matter which poses are computed or in what order, so every
+    worker agrees on it.
+    """
+
+    def __init__(self, x_limits: Tuple[float, float], y_limits: Tuple[float, float],
+                 stride: float, pose_count: int, turn_deviation: float, seed: int) -> None:
+        """!
+        @brief Set up the walk. No poses are computed until they are needed.
+        @param x_limits The smallest and largest X of the area, in meters.
+        @param y_limits The smallest and largest Y of the area, in meters.
+        @param stride The distance between poses, in meters.
+        @param pose_count How many poses to take.
+        @param turn_deviation The standard deviation of the turn between poses, in radians.
+        @param seed The seed of the random turns.
+        """
+        super().__init__(pose_count)
+        ## The smallest and largest X of the area.
+        self._x_limits = x_limits
+        ## The smallest and largest Y of the area.
+        self._y_limits = y_limits
+        ## The distance between poses.
+        self._stride = stride
+        ## The standard deviation of the turn between poses.
+        self._turn_deviation = turn_deviation
+        ## The seed of the random turns.
+        self._seed = seed
+        # The walk is computed as if there were no edges, then folded back into the area. So each
+        # block only needs the unfolded position and heading the block before it ended on.
+        ## The unfolded X, Y, and heading just before each block that has been reached so far.
+        self._block_states = [((x_limits[0] + x_limits[1]) / 2.0,
+                               (y_limits[0] + y_limits[1]) / 2.0, 0.0)]
+
+    def _generate(self, indices: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Compute the poses at the given indices.
+        @param indices A 1D Numpy array of indices, each within the trajectory.
+        @return An Nx3 Numpy array of the X and Y in meters and the yaw in radians of each pose.
+        """
+        result = numpy.zeros((indices.size, 3))
+        blocks = indices // _BLOCK_SIZE
+        for block in numpy.unique(blocks):
+            selected = blocks == block
+            result[selected] = self._walk_block(int(block))[indices[selected] % _BLOCK_SIZE]
+        return result
+
+    def _walk_block(self, block: int) -> numpy.ndarray:
+        """!
+        @brief Compute every pose of one block of the walk, folded back into the area.
+        @param block The number of the block.
+        @return A _BLOCK_SIZE x 3 Numpy array of the poses in the block.
+        """
+        # Walk every earlier block first, if needed, to find where this one starts.
+        while len(self._block_states) <= block:
+            self._block_states.append(self._walk_unfolded(len(self._block_states) - 1)[3])
+        x, y, heading, _ = self._walk_unfolded(block)
+        x, x_sign = _fold(x, self._x_limits)
+        y, y_sign = _fold(y, self._y_limits)
+        # Bouncing off an edge mirrors the heading across it.
+        return numpy.column_stack(
+            (x, y, numpy.arctan2(y_sign * numpy.sin(heading), x_sign * numpy.cos(heading))))
+
+    def _walk_unfolded(self, block: int) -> Tuple[numpy.ndarray, numpy.ndarray, numpy.ndarray,
+                                                  Tuple[float, float, float]]:
+        """!
+        @brief Compute one block of the walk as if the area had no edges.
+        @param block The number of the block. Its starting state must already be known.
+        @return The X, Y, and heading arrays of the block's poses, plus the final X, Y, and heading.
+        """
+        generator = numpy.random.default_rng([self._seed, block])
+        turns = generator.normal(0.0, self._turn_deviation, _BLOCK_SIZE)
+        steps = numpy.full(_BLOCK_SIZE, self._stride)
+        if block == 0:
+            # The first pose is the starting point itself.
+            turns[0] = 0.0
+            steps[0] = 0.0
+        start_x, start_y, start_heading = self._block_states[block]
+        heading = start_heading + numpy.cumsum(turns)
+        x = start_x + numpy.cumsum(steps * numpy.cos(heading))
+        y = start_y + numpy.cumsum(steps * numpy.sin(heading))
+        return x, y, heading, (float(x[-1]), float(y[-1]), float(heading[-1]))
+
+
+def create_trajectory(configs: Dict) -> GeneratedTrajectory:
+    """!
+    @brief Create a trajectory generator from its section of the configuration.
+
+    Every type needs the area to cover, as x_min, y_min, x_max, and y_max, and the stride between
+    poses, all in meters. The "lawnmower" and "spiral" types also need the lane_spacing between
+    neighboring lanes or turns. The "loop" type may set how many laps to take. The "random_walk"
+    type needs the number of poses and may set the turn_deviation, in radians, and the seed.
+
+    @param configs The trajectory section of the configuration.
+    @return The trajectory.
+    @exception KeyError raised if a required value is missing.
+    @exception TypeError raised if a value is the wrong type.
+    @exception ValueError raised if the type is unknown or a value is out of range.
+    """
+    required_keys = {
+        'lawnmower': ['lane_spacing'],
+        'loop': [],
+        'spiral': ['lane_spacing'],
+        'random_walk': ['poses']
+    }
+    default_properties = {
+        'laps': 1,
+        'turn_deviation': 0.1,
+        'seed': 0
+    }
+    trajectory_type = configs.get('type')
+    if trajectory_type not in required_keys:
+        raise ValueError(
+            F'Trajectory type must be one of {list(required_keys.keys())}, not {trajectory_type}')
+    for key in ['x_min', 'y_min', 'x_max', 'y_max', 'stride'] + required_keys[trajectory_type]:
+        if key not in configs:
+            raise KeyError(F'A {trajectory_type} trajectory requires {key}')
+    configs = {**default_properties, **configs}
+    for key, value_type in [('x_min', float), ('y_min', float), ('x_max', float),
+                            ('y_max', float), ('stride', float), ('lane_spacing', float),
+                            ('turn_deviation', float), ('laps', int), ('poses', int),
+                            ('seed', int)]:
+        if key not in configs:
+            continue
+        try:
+            configs[key] = value_type(configs[key])
+        except (TypeError, ValueError) as ex:
+            raise TypeError(F'Trajectory {key} must be a number') from ex
+    if configs['x_max'] <= configs['x_min'] or configs['y_max'] <= configs['y_min']:
+        raise ValueError('Trajectory x_max and y_max must be greater than x_min and y_min')
+    for key in ['stride', 'lane_spacing', 'laps', 'poses']:
+        if key in configs and configs[key] <= 0:
+            raise ValueError(F'Trajectory {key} must be greater than 0')
+    if configs['turn_deviation'] < 0:
+        raise ValueError('Trajectory turn_deviation must not be negative')
+    x_limits = (configs['x_min'], configs['x_max'])
+    y_limits = (configs['y_min'], configs['y_max'])
+    if trajectory_type == 'lawnmower':
+        return LawnmowerTrajectory(x_limits, y_limits, configs['stride'], configs['lane_spacing'])
+    if trajectory_type == 'loop':
+        return LoopTrajectory(x_limits, y_limits, configs['stride'], configs['laps'])
+    if trajectory_type == 'spiral':
+        return SpiralTrajectory(x_limits, y_limits, configs['stride'], configs['lane_spacing'])
+    return RandomWalkTrajectory(x_limits, y_limits, configs['stride'], configs['poses'],
+                                configs['turn_deviation'], configs['seed'])
+
+
+def _count_steps(length: float, step: float) -> int:
+    """!
+    @brief Find how many whole steps fit in a length, allowing for rounding.
+    @param length The length to fill.
+    @param step The size of each step.
+    @return The number of steps.
+    """
+    return int(math.floor(length / step + 1e-9))
+
+
+def _fold(values: numpy.ndarray, limits: Tuple[float, float]) -> Tuple[numpy.ndarray,
+                                                                       numpy.ndarray]:
+    """!
+    @brief Fold positions back into a range, as if they bounced off each end.
+    @param values The positions to fold.
+    @param limits The smallest and largest allowed position.
+    @return The folded positions, and for each, 1 if moving the same way as before or -1 if
+    mirrored.
+    """
+    length = limits[1] - limits[0]
+    offset = numpy.mod(values - limits[0], 2.0 * length)
+    mirrored = offset > length
+    return (limits[0] + numpy.where(mirrored, 2.0 * length - offset, offset),
+            numpy.where(mirrored, -1.0, 1.0))
@@ -45,9 +45,95 @@ def create_transform_matrix(x: float, y: float, z: float, roll: float, pitch: fl
     return pose
 
 
+def create_transform_matrices(x: numpy.ndarray, y: numpy.ndarray, z: numpy.ndarray,
+                              roll: numpy.ndarray, pitch: numpy.ndarray,
+                              yaw: numpy.ndarray) -> numpy.ndarray:
+    """!
+    @brief Create a 4x4 homogenous transform matrix for each of N 6 DOF poses at once.
+
+    This is the batch version of @ref create_transform_matrix and follows the same conventions. Each
+    argument may be an N length array or a single value shared by every pose. For poses that only
+    have X, Y, and yaw, @ref create_planar_transform_matrices is faster.
+
+    @param x The X component of each position, in meters.
+    @param y The Y component of each position, in meters.
+    @param z The Z component of each position, in meters.
+    @param roll The X axis rotation of each orientation, in radians.
+    @param pitch The Y axis rotation of each orientation, in radians.
+    @param yaw The Z axis rotation of each orientation, in radians.
+    @return An Nx4x4 Numpy array of the homogenous transform matrix for each pose.
+    @exception ValueError raised if the arguments can't be broadcast to a common length.
+    """
+    x, y, z, roll, pitch, yaw = numpy.broadcast_arrays(
+        *[numpy.atleast_1d(numpy.asarray(value, dtype=float)) for value in (x, y, z, roll, pitch,
+                                                                              yaw)])
+    if x.ndim != 1:
+        raise ValueError(F'Pose components must be 1D, not shape {x.shape}.')
+    count = x.shape[0]
+    pose = numpy.zeros((count, 4, 4))
+    pose[:, 0, 3] = x
+    pose[:, 1, 3] = y
+    pose[:, 2, 3] = z
+    pose[:, 3, 3] = 1.0
+    rotation_roll = numpy.zeros((count, 3, 3))
+    rotation_roll[:, 0, 0] = 1.0
+    rotation_roll[:, 1, 1] = numpy.cos(roll)
+    rotation_roll[:, 1, 2] = -numpy.sin(roll)
+    rotation_roll[:, 2, 1] = numpy.sin(roll)
+    rotation_roll[:, 2, 2] = numpy.cos(roll)
+    rotation_pitch = numpy.zeros((count, 3, 3))
+    rotation_pitch[:, 0, 0] = numpy.cos(pitch)
+    rotation_pitch[:, 0, 2] = numpy.sin(pitch)
+    rotation_pitch[:, 1, 1] = 1.0
+    rotation_pitch[:, 2, 0] = -numpy.sin(pitch)
+    rotation_pitch[:, 2, 2] = numpy.cos(pitch)
+    rotation_yaw = numpy.zeros((count, 3, 3))
+    rotation_yaw[:, 0, 0] = numpy.cos(yaw)
+    rotation_yaw[:, 0, 1] = -numpy.sin(yaw)
+    rotation_yaw[:, 1, 0] = numpy.sin(yaw)
+    rotation_yaw[:, 1, 1] = numpy.cos(yaw)
+    rotation_yaw[:, 2, 2] = 1.0
+    pose[:, 0:3, 0:3] = rotation_roll @ rotation_pitch @ rotation_yaw
+    return pose
+
+
+def create_planar_transform_matrices(poses: numpy.ndarray) -> numpy.ndarray:
+    """!
+    @brief Create a 4x4 homogenous transform matrix for each of a list of planar poses at once.
+
+    This gives the same result as calling @ref create_transform_matrix with zero Z, roll, and pitch
+    for every pose, but without any Python loops.
+
+    @param poses An Nx3 array-like, where each row is X and Y in meters and yaw in radians.
+    @return An Nx4x4 Numpy array of the homogenous transform matrix for each pose.
+    @exception ValueError raised if the poses are not Nx3.
+    """
+    poses = numpy.asarray(poses, dtype=float)
+    if poses.ndim != 2 or poses.shape[1] != 3:
+        raise ValueError(F'Planar poses must be shape (N, 3), not {poses.shape}.')
+    result = numpy.zeros((poses.shape[0], 4, 4))
+    cos_yaw = numpy.cos(poses[:, 2])
+    sin_yaw = numpy.sin(poses[:, 2])
+    result[:, 0, 0] = cos_yaw
+    result[:, 0, 1] = -sin_yaw
+    result[:, 1, 0] = sin_yaw
+    result[:, 1, 1] = cos_yaw
+    # The matrix product in create_transform_matrix never leaves a negative zero in the rotation, so
+    # adding zero keeps the two bit for bit identical.
+    result[:, 0:2, 0:2] += 0.0
+    result[:, 2, 2] = 1.0
+    result[:, 3, 3] = 1.0
+    result[:, 0, 3] = poses[:, 0]
+    result[:, 1, 3] = poses[:, 1]
+    return result
+
+
 class Transformer:
     """!
     @brief A class to convert poses and points from one frame to another.
+
+    Every method has a batch version that accepts many robot poses at once. Prefer these when
+    working with entire trajectories, since the math is done in a single vectorized pass.
     """
 
     def __init__(self, camera_pose: numpy.ndarray, camera_intrinsic_matrix: numpy.ndarray) -> None:
@@ -58,10 +144,6 @@ class Transformer:
         measured from the robot's frame of reference.
         @param camera_intrinsic_matrix The 3x3 Numpy array that holds the camera's intrinsic matrix.
         """
-        ## The camera's pose, as measured from the robot's frame of reference.
-        self.camera_pose = camera_pose
-        ## The camera intrinsic matrix, generally set in Blender.
-        self.camera_intrinsic_matrix = camera_intrinsic_matrix
         ## The rotation matrix to transform from image coordinates to camera coordinates.
         self._image_2_camera = numpy.array([
             [0.0, 0.0, 1.0, 0.0],
@@ -69,6 +151,10 @@ class Transformer:
             [0.0, -1.0, 0.0, 0.0],
             [0.0, 0.0, 0.0, 1.0]
         ])
+        ## The camera's pose, as measured from the robot's frame of reference.
+        self.camera_pose = camera_pose
+        ## The camera intrinsic matrix, generally set in Blender.
+        self.camera_intrinsic_matrix = camera_intrinsic_matrix
 
     @property
     def camera_intrinsic_matrix(self) -> numpy.ndarray:
@@ -92,6 +178,7 @@ class Transformer:
                 F'not {camera_intrinsic_matrix.shape}.')
         ## The camera intrinsic matrix, generally set in Blender.
         self._camera_intrinsic_matrix = camera_intrinsic_matrix
+        self._update_projection()
 
     @property
     def camera_pose(self) -> numpy.ndarray:
@@ -114,6 +201,66 @@ class Transformer:
                 F'Provided intrinsic matrix should be shape (4, 4), not {camera_pose.shape}.')
         ## The camera's pose, as measured from the robot's frame of reference.
         self._camera_pose = camera_pose
+        self._update_projection()
+
+    @property
+    def image_2_camera(self) -> numpy.ndarray:
+        """!
+        @brief Get the rotation from image coordinates, with +X right, +Y down, and +Z forward, to
+        camera coordinates.
+        @return A 4x4 Numpy array of the homogenous rotation.
+        """
+        return self._image_2_camera
+
+    def project_ground_points(self, points: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Find where points on the floor appear in the global image of
+        @ref project_image_corner.
+        @param points An Nx2 array-like of the X and Y of each point on the floor, in meters,
+        measured from the world frame.
+        @return An Nx2 Numpy array of the X and Y of each point in the global image, in pixels.
+        """
+        points = numpy.asarray(points, dtype=float)
+        points_world = numpy.column_stack(
+            (points[:, 0], points[:, 1], numpy.zeros(points.shape[0]), numpy.ones(points.shape[0])))
+        # This follows the same steps as the second half of project_image_corners.
+        points_image = points_world @ self._robot_2_image.transpose()
+        points_image /= self.camera_pose[2, 3]
+        points_image_truncated = numpy.column_stack(
+            (points_image[:, 0], points_image[:, 1], numpy.ones(points_image.shape[0])))
+        points_pixel = points_image_truncated @ self.camera_intrinsic_matrix.transpose()
+        return points_pixel[:, 0:2]
+
+    def project_pixels_to_robot(self, pixels: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Find where pixels of the camera's own image land on the floor.
+        @param pixels An Mx2 array-like of the X and Y of each pixel, in pixels.
+        @return An Mx4 Numpy array of the homogenous point on the floor seen by each pixel, as
+        measured from the robot's frame of reference.
+        """
+        pixels = numpy.asarray(pixels, dtype=float)
+        pixels_homogenous = numpy.column_stack((pixels, numpy.ones(pixels.shape[0])))
+        # As for the image corner, the depth of every point is the camera height.
+        pixel_2_image = numpy.linalg.inv(self.camera_intrinsic_matrix)
+        points_image = (pixels_homogenous @ pixel_2_image.transpose()) * self.camera_pose[2, 3]
+        points_image = numpy.column_stack((points_image, numpy.ones(points_image.shape[0])))
+        return points_image @ (self.camera_pose @ self._image_2_camera).transpose()
+
+    def project_robot_to_pixels(self, points: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Find where points on the floor appear in the camera's own image.
+
+        This is the inverse of @ref project_pixels_to_robot.
+
+        @param points An array of homogenous points measured from the robot's frame of reference,
+        with the 4 coordinates of each point in the last dimension.
+        @return An array of the X and Y of each point in the image, in pixels, with the same shape
+        as the points except for the last dimension.
+        """
+        points_image = points @ self._robot_2_image.transpose()
+        points_image = points_image[..., 0:2] / self.camera_pose[2, 3]
+        return points_image @ self.camera_intrinsic_matrix[0:2, 0:2].transpose() + \
+            self.camera_intrinsic_matrix[0:2, 2]
 
     def project_image_corner(self, robot_pose: numpy.ndarray) -> List[float]:
         """!
@@ -130,36 +277,35 @@ class Transformer:
         @return A 3 element list containing the X (in pixels), Y (in pixels), and yaw (in radians)
         of the top left corner of the image.
         """
-        # The top left corner is always (0, 0) in pixel space. Add the one for the transform math to
-        # work. This will then become the Z component after the scale is applied.
-        point_robot_pixel = numpy.array([0.0, 0.0, 1.0]).transpose()
-        # Project from pixel space to image coordinates, which are centered in the image with +X to
-        # the right of the image and +Y down the image. This normally is only correct to a scale
-        # factor of the depth, but we know the depth in this case.
-        point_robot_image_truncated = (numpy.linalg.inv(self.camera_intrinsic_matrix) @
-                                       point_robot_pixel) * self.camera_pose[2, 3]
-        # Now transform to the robot's origin. This requires adding a 1 to be a homogenous
-        # representation.
-        point_robot_image = numpy.append(point_robot_image_truncated, [1.0], 0)
-        point_robot = self.camera_pose @ self._image_2_camera @ point_robot_image
-        # Now transform to the origin frame based on the robot's pose
-        point_origin = robot_pose @ point_robot
+        return self.project_image_corners(robot_pose[numpy.newaxis, :, :])[0].tolist()
+
+    def project_image_corners(self, robot_poses: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief The batch version of @ref project_image_corner.
+        @param robot_poses Either an Nx4x4 Numpy array of homogenous robot poses or an Nx3 array of
+        planar X, Y, and yaw poses, all measured from the world frame.
+        @return An Nx3 Numpy array where each row is the X (in pixels), Y (in pixels), and yaw (in
+        radians) of the top left corner of that pose's image.
+        @exception ValueError raised if the poses are not one of the accepted shapes.
+        """
+        robot_poses = self._as_transform_matrices(robot_poses)
+        # Transform the corner, already expressed in the robot's frame, to the origin frame based on
+        # each robot pose.
+        point_origin = robot_poses @ self._corner_robot
         # Then, transform back into the image frame as if there was a robot aligned at this point.
-        point_origin_image = numpy.linalg.inv(
-            self.camera_pose @ self._image_2_camera) @ point_origin
+        point_origin_image = point_origin @ self._robot_2_image.transpose()
         # Normalize to the camera height, then drop the Z component as it is not needed for point
         # projection
         point_origin_image /= self.camera_pose[2, 3]
-        point_origin_image_truncated = numpy.array(
-            [point_origin_image[0], point_origin_image[1], 1.0]).transpose()
+        point_origin_image_truncated = numpy.column_stack(
+            (point_origin_image[:, 0], point_origin_image[:, 1],
+             numpy.ones(point_origin_image.shape[0])))
         # Finally, project into the pixel space.
-        point_origin_pixel = (self.camera_intrinsic_matrix @
-                              point_origin_image_truncated).squeeze()
+        point_origin_pixel = point_origin_image_truncated @ self.camera_intrinsic_matrix.transpose()
         # Get the yaw from the robot's original yaw.
-        yaw = numpy.arccos(robot_pose[0, 0])
-        if numpy.sign(robot_pose[1, 0]) == -1:
-            yaw *= -1.0
-        return [point_origin_pixel[0], point_origin_pixel[1], yaw]
+        yaw = numpy.arccos(robot_poses[:, 0, 0])
+        yaw = numpy.where(numpy.sign(robot_poses[:, 1, 0]) == -1, -yaw, yaw)
+        return numpy.column_stack((point_origin_pixel[:, 0], point_origin_pixel[:, 1], yaw))
 
     def transform_camera_to_world(self, robot_pose: numpy.ndarray) -> numpy.ndarray:
         """!
@@ -170,3 +316,56 @@ class Transformer:
         frame.
         """
         return robot_pose @ self.camera_pose
+
+    def transform_cameras_to_world(self, robot_poses: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief The batch version of @ref transform_camera_to_world.
+        @param robot_poses Either an Nx4x4 Numpy array of homogenous robot poses or an Nx3 array of
+        planar X, Y, and yaw poses, all measured from the world frame.
+        @return An Nx4x4 Numpy array of the pose of each camera as measured from the world frame.
+        @exception ValueError raised if the poses are not one of the accepted shapes.
+        """
+        return self._as_transform_matrices(robot_poses) @ self.camera_pose
+
+    def _as_transform_matrices(self, robot_poses: numpy.ndarray) -> numpy.ndarray:
+        """!
+        @brief Convert the accepted batch pose formats into an array of homogenous matrices.
+        @param robot_poses Either an Nx4x4 or Nx3 array-like of poses.
+        @return An Nx4x4 Numpy array.
+        @exception ValueError raised if the poses are not one of the accepted shapes.
+        """
+        robot_poses = numpy.asarray(robot_poses, dtype=float)
+        if robot_poses.ndim == 2 and robot_poses.shape[1] == 3:
+            return create_planar_transform_matrices(robot_poses)
+        if robot_poses.ndim == 3 and robot_poses.shape[1:] == (4, 4):
+            return robot_poses
+        raise ValueError(
+            F'Robot poses should be shape (N, 4, 4) or (N, 3), not {robot_poses.shape}.')
+
+    def _update_projection(self) -> None:
+        """!
+        @brief Recompute the parts of the corner projection that do not depend on the robot pose.
+
+        This saves inverting the same matrices for every pose. It is called whenever the camera pose
+        or intrinsic matrix changes, and does nothing until both have been set.
+
+        @return None
+        """
+        if not hasattr(self, '_camera_pose') or not hasattr(self, '_camera_intrinsic_matrix'):
+            return
+        # The top left corner is always (0, 0) in pixel space. Add the one for the transform math to
+        # work. This will then become the Z component after the scale is applied.
+        point_robot_pixel = numpy.array([0.0, 0.0, 1.0]).transpose()
+        # Project from pixel space to image coordinates, which are centered in the image with +X to
+        # the right of the image and +Y down the image. This normally is only correct to a scale
+        # factor of the depth, but we know the depth in this case.
+        point_robot_image_truncated = (numpy.linalg.inv(self.camera_intrinsic_matrix) @
+                                       point_robot_pixel) * self.camera_pose[2, 3]
+        # Now transform to the robot's origin. This requires adding a 1 to be a homogenous
+        # representation.
+        point_robot_image = numpy.append(point_robot_image_truncated, [1.0], 0)
+        ## The top left corner of the image, as measured from the robot's frame of reference.
+        self._corner_robot = self.camera_pose @ self._image_2_camera @ point_robot_image
+        ## The transform from the robot's frame of reference to the image frame.
+        self._robot_2_image = numpy.linalg.inv(
+            self.camera_pose @ self._image_2_camera)